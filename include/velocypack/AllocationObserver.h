@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "velocypack/velocypack-common.h"
+
+namespace arangodb::velocypack {
+
+// the call sites that report their heap allocations
+enum class AllocationCategory : uint8_t {
+  Buffer = 0,       // Buffer memory, e.g. of a Builder
+  SharedSliceCopy,  // copies made by SharedSlice and RefCountedSlice
+  BuilderIndex,     // the index table vector of a Builder
+  Parser,           // Buffer memory allocated while parsing JSON
+  NumCategories     // must be last
+};
+
+char const* allocationCategoryName(AllocationCategory category) noexcept;
+
+// receives the allocation events of the library once it is installed via
+// AllocationTracing::install(). the methods can be called concurrently
+// from multiple threads and must not throw. frees and reallocations are
+// reported for all blocks, including ones whose allocation was not
+// sampled, so implementations must ignore pointers they do not know
+class AllocationObserver {
+ public:
+  virtual ~AllocationObserver() = default;
+
+  // a new block of size bytes was allocated
+  virtual void allocated(void const* ptr, std::size_t size,
+                         AllocationCategory category) noexcept = 0;
+
+  // a block was resized to size bytes, and possibly moved. used is the
+  // number of bytes of the block that were in use before
+  virtual void reallocated(void const* oldPtr, void const* newPtr,
+                           std::size_t size, std::size_t used) noexcept = 0;
+
+  // a block was freed. used is the number of bytes of the block that were
+  // in use at that point, or the block size if that is not known
+  virtual void freed(void const* ptr, std::size_t used) noexcept = 0;
+};
+
+class AllocationTracing {
+ public:
+  // installs an observer, or uninstalls the current one if nullptr is
+  // given. only every sampleInterval-th allocation is reported. the
+  // caller must make sure that no allocations are in flight when an
+  // observer is uninstalled and destroyed
+  static void install(AllocationObserver* observer,
+                      uint32_t sampleInterval = 1) noexcept;
+
+  static AllocationObserver* observer() noexcept {
+    return _observer.load(std::memory_order_acquire);
+  }
+
+  // the only check made on the allocation paths when nothing is installed
+  static inline bool active() noexcept {
+    return _observer.load(std::memory_order_relaxed) != nullptr;
+  }
+
+  // ptr is not const, as the block is not initialized yet. compilers
+  // assume that memory behind a const pointer argument is read
+  static void allocated(void* ptr, std::size_t size,
+                        AllocationCategory category) noexcept;
+  static void reallocated(void const* oldPtr, void const* newPtr,
+                          std::size_t size, std::size_t used) noexcept;
+  static void freed(void const* ptr, std::size_t used) noexcept;
+
+  // attributes all Buffer allocations of the current thread to another
+  // category while the scope is alive
+  class Scope {
+   public:
+    explicit Scope(AllocationCategory category) noexcept;
+    ~Scope();
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+   private:
+    AllocationCategory _previous;
+    bool _active;
+  };
+
+ private:
+  static inline std::atomic<AllocationObserver*> _observer{nullptr};
+  static inline std::atomic<uint32_t> _sampleInterval{1};
+};
+
+// std::allocator that reports its allocations to an installed observer
+template<typename T, AllocationCategory Category>
+struct TracingAllocator : std::allocator<T> {
+  typedef T value_type;
+
+  template<typename U>
+  struct rebind {
+    typedef TracingAllocator<U, Category> other;
+  };
+
+  TracingAllocator() noexcept = default;
+  template<typename U>
+  TracingAllocator(TracingAllocator<U, Category> const&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    T* p = std::allocator<T>::allocate(n);
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::allocated(p, n * sizeof(T), Category);
+    }
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::freed(p, n * sizeof(T));
+    }
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+template<typename T, typename U, AllocationCategory Category>
+bool operator==(TracingAllocator<T, Category> const&,
+                TracingAllocator<U, Category> const&) noexcept {
+  return true;
+}
+
+template<typename T, typename U, AllocationCategory Category>
+bool operator!=(TracingAllocator<T, Category> const&,
+                TracingAllocator<U, Category> const&) noexcept {
+  return false;
+}
+
+}  // namespace arangodb::velocypack
+
+using VPackAllocationCategory = arangodb::velocypack::AllocationCategory;
+using VPackAllocationObserver = arangodb::velocypack::AllocationObserver;
+using VPackAllocationTracing = arangodb::velocypack::AllocationTracing;
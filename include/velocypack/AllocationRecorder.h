@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
+
+namespace arangodb::velocypack {
+class Builder;
+
+// an AllocationObserver that keeps track of all live sampled blocks and
+// aggregates sizes, wasted capacity and lifetimes per category
+class AllocationRecorder final : public AllocationObserver {
+ public:
+  // number of buckets in the size and lifetime histograms. bucket i counts
+  // the values in [2^(i-1), 2^i), the last bucket counts all larger values
+  static constexpr std::size_t histogramBuckets = 40;
+
+  struct CategoryStatistics {
+    uint64_t allocations = 0;
+    uint64_t reallocations = 0;
+    uint64_t frees = 0;
+    // bytes currently allocated by live blocks, and the maximum of that
+    uint64_t liveBytes = 0;
+    uint64_t peakLiveBytes = 0;
+    uint64_t liveBlocks = 0;
+    // sum of all block sizes and of the bytes in use at the time the
+    // blocks were freed
+    uint64_t freedCapacity = 0;
+    uint64_t freedUsed = 0;
+    uint64_t totalLifetimeNanos = 0;
+    uint64_t maxLifetimeNanos = 0;
+    // block sizes at the time they were freed, and block lifetimes in
+    // microseconds
+    std::array<uint64_t, histogramBuckets> sizes{};
+    std::array<uint64_t, histogramBuckets> lifetimes{};
+  };
+
+  typedef std::array<CategoryStatistics,
+                     static_cast<std::size_t>(AllocationCategory::NumCategories)>
+      Statistics;
+
+  AllocationRecorder() = default;
+  AllocationRecorder(AllocationRecorder const&) = delete;
+  AllocationRecorder& operator=(AllocationRecorder const&) = delete;
+
+  void allocated(void const* ptr, std::size_t size,
+                 AllocationCategory category) noexcept override;
+  void reallocated(void const* oldPtr, void const* newPtr, std::size_t size,
+                   std::size_t used) noexcept override;
+  void freed(void const* ptr, std::size_t used) noexcept override;
+
+  Statistics statistics() const;
+
+  // forgets all live blocks and resets all statistics
+  void reset();
+
+  // writes an Object with one sub-Object per category. sampleInterval is
+  // only stored in the result, so that readers can scale the numbers
+  void toVelocyPack(Builder& builder, uint32_t sampleInterval = 1) const;
+
+ private:
+  struct Block {
+    std::size_t size;
+    AllocationCategory category;
+    std::chrono::steady_clock::time_point allocated;
+  };
+
+  mutable std::mutex _mutex;
+  std::unordered_map<void const*, Block> _blocks;
+  Statistics _statistics;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackAllocationRecorder = arangodb::velocypack::AllocationRecorder;
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AttributeTranslator.h"
+
+namespace arangodb::velocypack {
+class Builder;
+class Slice;
+
+// a versioned dictionary of Object keys to compress. keys can be added at
+// any time, which publishes a new version containing all previous keys plus
+// the new ones. each version is an immutable, sealed AttributeTranslator.
+// readers only load the current version with a single atomic load and never
+// block, while writers are serialized among each other.
+// key ids are never reassigned, so a value encoded with an older version can
+// be decoded with any later version. all versions stay alive until the
+// dictionary is destroyed, so translators handed out remain valid.
+// each version's translator is built from scratch and holds all keys up to
+// that version. so each new version costs time and memory proportional to
+// the total number of keys, and the memory is not released before the
+// dictionary is destroyed. the dictionary is meant for rarely changing key
+// sets: keys should be added in batches, not one at a time
+class AttributeDictionary {
+ public:
+  // a consistent view of a dictionary version
+  struct Snapshot {
+    uint64_t version;
+    AttributeTranslator* translator;
+  };
+
+  AttributeDictionary(AttributeDictionary const&) = delete;
+  AttributeDictionary& operator=(AttributeDictionary const&) = delete;
+
+  AttributeDictionary();
+  ~AttributeDictionary();
+
+  // returns the current version and its translator. values should be encoded
+  // with snapshot.translator and stored along with snapshot.version
+  Snapshot snapshot() const noexcept {
+    Version const* current = _current.load(std::memory_order_acquire);
+    return Snapshot{current->number, &current->translator};
+  }
+
+  // returns the current version number. the initial, empty dictionary
+  // has version 0
+  uint64_t version() const noexcept {
+    return _current.load(std::memory_order_acquire)->number;
+  }
+
+  // returns the translator of the current version
+  AttributeTranslator* translator() const noexcept {
+    return &_current.load(std::memory_order_acquire)->translator;
+  }
+
+  // returns the translator of the specified version, or nullptr if the
+  // version does not exist yet
+  AttributeTranslator* translator(uint64_t version) const noexcept;
+
+  // returns the number of keys in the current version
+  std::size_t count() const noexcept {
+    return _current.load(std::memory_order_acquire)->translator.count();
+  }
+
+  // adds the keys that are not yet contained in the dictionary and
+  // publishes them as a new version. returns the current version number,
+  // which is unchanged if all keys were already contained. O(n) in the
+  // total number of keys, see above
+  uint64_t add(std::vector<std::string_view> const& keys);
+
+  // serializes all versions into an Object of the form
+  // { "versions": [ [ <keys of version 1> ], [ <keys of version 2> ], ... ] }
+  void toVelocyPack(Builder& builder) const;
+
+  // adds the versions from a value created by toVelocyPack() to an empty
+  // dictionary
+  void fromVelocyPack(Slice slice);
+
+ private:
+  struct Version {
+    uint64_t number;
+    Version const* previous;
+    // number of keys added in this version
+    std::size_t added;
+    // mutable because translators are handed out as non-const pointers for
+    // use in Options, but they are sealed and never modified
+    mutable AttributeTranslator translator;
+  };
+
+  // readers only access the version _current points to, and the versions
+  // reachable from it via previous
+  std::atomic<Version const*> _current;
+
+  // protects the members below, which are only used by writers
+  mutable std::mutex _lock;
+  std::vector<std::unique_ptr<Version>> _versions;
+  // all keys, in the order of their ids. _known points into them, so
+  // they must not be moved
+  std::deque<std::string> _keys;
+  std::unordered_set<std::string_view> _known;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackAttributeDictionary = arangodb::velocypack::AttributeDictionary;
@@ -28,6 +28,7 @@
 #include <memory>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 
@@ -36,6 +37,26 @@ class Builder;
 
 class AttributeTranslator {
  public:
+  // statistics about the lookup tables built by seal()
+  struct Statistics {
+    // number of distinct keys
+    std::size_t keys = 0;
+    // number of displacement buckets of the perfect hash
+    std::size_t buckets = 0;
+    // number of displacement values tried until all buckets were placed
+    uint64_t displacementTrials = 0;
+    // largest displacement value used by a bucket
+    uint64_t maxDisplacement = 0;
+    // number of times the perfect hash construction was restarted
+    std::size_t restarts = 0;
+    // ids that are looked up via the dense id array
+    std::size_t denseIds = 0;
+    // ids that were too large for the dense id array
+    std::size_t sparseIds = 0;
+    // time spent in seal()
+    uint64_t buildMicroseconds = 0;
+  };
+
   AttributeTranslator(AttributeTranslator const&) = delete;
   AttributeTranslator& operator=(AttributeTranslator const&) = delete;
 
@@ -47,19 +68,27 @@ class AttributeTranslator {
 
   void add(std::string_view key, uint64_t id);
 
+  // builds the immutable lookup tables. keys are looked up via a minimal
+  // perfect hash, which costs one hash computation and one key comparison
+  // per lookup, and ids are looked up in a dense array
   void seal();
 
+  Statistics const& statistics() const noexcept { return _statistics; }
+
   Builder* builder() const { return _builder.get(); }
   
   // translate from string to id
   uint8_t const* translate(std::string_view key) const noexcept {
-    auto it = _keyToId.find(key);
+    if (_keyToId.empty()) {
+      return nullptr;
+    }
 
-    if (it == _keyToId.end()) {
+    Entry const& entry = _keyToId[slot(key)];
+    if (entry.key != key) {
       return nullptr;
     }
 
-    return (*it).second;
+    return entry.id;
   }
   
   // translate from string to id
@@ -69,20 +98,66 @@ class AttributeTranslator {
 
   // translate from id to string
   uint8_t const* translate(uint64_t id) const noexcept {
-    auto it = _idToKey.find(id);
+    if (id < _idToKey.size()) {
+      return _idToKey[id];
+    }
+
+    if (_sparseIdToKey.empty()) {
+      return nullptr;
+    }
+
+    auto it = _sparseIdToKey.find(id);
 
-    if (it == _idToKey.end()) {
+    if (it == _sparseIdToKey.end()) {
       return nullptr;
     }
 
     return (*it).second;
   }
 
+ private:
+  struct Entry {
+    std::string_view key;
+    uint8_t const* id;
+  };
+
+  static uint64_t hashKey(std::string_view key) noexcept {
+    return VELOCYPACK_HASH(key.data(), key.size(), 0xdeadbeef);
+  }
+
+  // position of the key in _keyToId for the given displacement
+  static std::size_t displacedSlot(uint64_t hash, uint64_t displacement,
+                                   std::size_t size) noexcept {
+    // murmur3 finalizer
+    uint64_t h = hash ^ (displacement * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h % size);
+  }
+
+  std::size_t slot(std::string_view key) const noexcept {
+    uint64_t const hash = hashKey(key);
+    return displacedSlot(hash, _displacements[(hash >> 32) % _displacements.size()],
+                         _keyToId.size());
+  }
+
+  bool buildPerfectHash(std::vector<Entry> const& entries, std::size_t numBuckets);
+
  private:
   std::unique_ptr<Builder> _builder;
-  std::unordered_map<std::string_view, uint8_t const*> _keyToId;
-  std::unordered_map<uint64_t, uint8_t const*> _idToKey;
+  // perfect hash table for key to id lookups, and the displacement value
+  // for each bucket of keys
+  std::vector<Entry> _keyToId;
+  std::vector<uint64_t> _displacements;
+  // id to key lookups. ids are usually small integers, so most of them
+  // can be looked up by index
+  std::vector<uint8_t const*> _idToKey;
+  std::unordered_map<uint64_t, uint8_t const*> _sparseIdToKey;
   std::size_t _count;
+  Statistics _statistics;
 };
 
 class AttributeTranslatorScope {
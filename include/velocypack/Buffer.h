@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <new>
@@ -32,30 +33,142 @@
 #include <type_traits>
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
 #include "velocypack/Exception.h"
+#include "velocypack/Statistics.h"
 
 namespace arangodb::velocypack {
 
+// determines the capacity a Buffer grows to when it runs out of space.
+// a Buffer only refers to its policy, which must outlive the Buffer
+struct BufferGrowthPolicy {
+  // the capacity grows to at least the current size times this factor
+  double factor = 1.5;
+  // upper bound for the bytes added by the factor in a single step, 0 for
+  // no bound. a Buffer still always grows by at least what is requested
+  ValueLength maxStep = 0;
+  // capacities of at least this many bytes are rounded up to a multiple of
+  // pageSize, 0 to never round
+  ValueLength pageThreshold = 0;
+  ValueLength pageSize = 4096;
+  // capacities of at least this many bytes are allocated as anonymous
+  // memory mappings, which grow via mremap() instead of realloc() and
+  // copying, 0 to never map. only supported on Linux
+  ValueLength mapThreshold = 0;
+  // ask for transparent huge pages for mapped memory. mapped capacities
+  // are then rounded up to a multiple of 2 MB
+  bool hugePages = true;
+  // preferred NUMA node for mapped memory, -1 for none
+  int numaNode = -1;
+
+  ValueLength nextCapacity(ValueLength size, ValueLength required) const noexcept {
+    ValueLength step = 0;
+    if (factor > 1.0) {
+      step = static_cast<ValueLength>(factor * size) - size;
+      if (maxStep != 0 && step > maxStep) {
+        step = maxStep;
+      }
+    }
+    ValueLength capacity = (std::max)(required, size + step);
+    if (pageThreshold != 0 && pageSize != 0 && capacity >= pageThreshold) {
+      capacity += (pageSize - capacity % pageSize) % pageSize;
+    }
+    return capacity;
+  }
+
+  static BufferGrowthPolicy const Defaults;
+};
+
+inline BufferGrowthPolicy const BufferGrowthPolicy::Defaults{};
+
+// memory mappings for big Buffers, see BufferGrowthPolicy::mapThreshold
+struct MappedMemory {
+  // whether memory mappings are supported on this platform
+  static bool supported() noexcept;
+  // the capacity to map for at least len bytes
+  static ValueLength capacity(ValueLength len,
+                              BufferGrowthPolicy const& policy) noexcept;
+  // map capacity bytes, returns nullptr on failure
+  static void* map(ValueLength capacity,
+                   BufferGrowthPolicy const& policy) noexcept;
+  // resize a mapping, possibly moving it. a moved mapping keeps the huge
+  // page alignment of map(). returns nullptr on failure, in which case the
+  // old mapping is still valid
+  static void* remap(void* p, ValueLength oldCapacity, ValueLength newCapacity,
+                     BufferGrowthPolicy const& policy) noexcept;
+  static void unmap(void* p, ValueLength capacity) noexcept;
+};
+
+// estimates the size of the next value built in a Buffer from the sizes of
+// the previous ones, see Buffer::reset(SizeHint&). the estimate follows
+// larger values immediately and decays slowly towards smaller ones
+class SizeHint {
+ public:
+  // decay is the share by which the estimate moves towards a smaller value
+  explicit SizeHint(double decay = 0.25) noexcept
+      : _decay(decay), _estimate(0) {}
+
+  void update(ValueLength size) noexcept {
+    if (size >= _estimate) {
+      _estimate = size;
+    } else {
+      _estimate -= static_cast<ValueLength>(_decay * (_estimate - size));
+    }
+  }
+
+  ValueLength estimate() const noexcept { return _estimate; }
+
+ private:
+  double _decay;
+  ValueLength _estimate;
+};
+
 template <typename T>
 class Buffer {
   static_assert(sizeof(T) == 1, "expecting sizeof(T) to be 1");
 
  public:
-  Buffer() noexcept : _buffer(_local), _capacity(sizeof(_local)), _size(0) {
+  Buffer() noexcept
+      : _buffer(_local),
+        _capacity(sizeof(_local)),
+        _size(0),
+        _growthPolicy(&BufferGrowthPolicy::Defaults),
+        _external(false),
+        _mapped(false) {
     poison(_buffer, _capacity);
     initWithNone();
   }
 
+  // create a Buffer on top of caller-provided memory with a fixed capacity.
+  // the Buffer does not take ownership of the memory and will never
+  // reallocate it. trying to reserve more space than is available throws
+  // a BufferCapacityExceeded exception
+  Buffer(T* data, ValueLength capacity)
+      : _buffer(data),
+        _capacity(capacity),
+        _size(0),
+        _growthPolicy(&BufferGrowthPolicy::Defaults),
+        _external(true),
+        _mapped(false) {
+    if (data == nullptr || capacity == 0) {
+      throw Exception(Exception::InternalError,
+                      "Buffer memory must not be empty");
+    }
+    initWithNone();
+  }
+
   explicit Buffer(ValueLength expectedLength) : Buffer() {
     reserve(expectedLength);
     initWithNone();
   }
 
+  // copies and moves take over the growth policy of the other Buffer,
+  // assignments keep their own
   Buffer(Buffer const& that) : Buffer() {
+    _growthPolicy = that._growthPolicy;
     if (that._size > 0) {
       if (that._size > sizeof(that._local)) {
-        _buffer = static_cast<T*>(velocypack_malloc(checkOverflow(that._size)));
-        ensureValidPointer(_buffer);
+        _buffer = allocate(that._size);
         _capacity = that._size;
       } else {
         VELOCYPACK_ASSERT(_buffer == &_local[0]);
@@ -74,13 +187,15 @@ class Buffer {
         memcpy(_buffer, that._buffer, checkOverflow(that._size));
       } else {
         // our own buffer is not big enough to hold the data
-        T* buffer = static_cast<T*>(velocypack_malloc(checkOverflow(that._size)));
-        ensureValidPointer(buffer);
+        if (_external) {
+          throw Exception(Exception::BufferCapacityExceeded);
+        }
+        T* buffer = allocate(that._size);
         buffer[0] = '\x00';
         memcpy(buffer, that._buffer, checkOverflow(that._size));
 
         if (_buffer != _local) {
-          velocypack_free(_buffer);
+          deallocate(_buffer);
         }
         _buffer = buffer;
         _capacity = that._size;
@@ -91,7 +206,12 @@ class Buffer {
     return *this;
   }
 
-  Buffer(Buffer&& that) noexcept : _buffer(_local), _capacity(sizeof(_local)) {
+  Buffer(Buffer&& that) noexcept
+      : _buffer(_local),
+        _capacity(sizeof(_local)),
+        _growthPolicy(that._growthPolicy),
+        _external(false),
+        _mapped(false) {
     poison(_buffer, _capacity);
     initWithNone();
     if (that._buffer == that._local) {
@@ -100,8 +220,12 @@ class Buffer {
     } else {
       _buffer = that._buffer;
       _capacity = that._capacity;
+      _external = that._external;
+      _mapped = that._mapped;
       that._buffer = that._local;
       that._capacity = sizeof(that._local);
+      that._external = false;
+      that._mapped = false;
     }
     _size = that._size;
     that._size = 0;
@@ -110,9 +234,10 @@ class Buffer {
 
   Buffer& operator=(Buffer&& that) noexcept {
     if (this != &that) {
-      if (_buffer != _local) {
-        velocypack_free(_buffer);
+      if (usesHeapMemory()) {
+        deallocate(_buffer);
       }
+      _external = that._external;
       if (that._buffer == that._local) {
         _buffer = _local;
         _capacity = sizeof(_local);
@@ -121,8 +246,11 @@ class Buffer {
       } else {
         _buffer = that._buffer;
         _capacity = that._capacity;
+        _mapped = that._mapped;
         that._buffer = that._local;
         that._capacity = sizeof(that._local);
+        that._external = false;
+        that._mapped = false;
       }
       _size = that._size;
       that._size = 0;
@@ -132,8 +260,8 @@ class Buffer {
   }
 
   ~Buffer() { 
-    if (_buffer != _local) {
-      velocypack_free(_buffer);
+    if (usesHeapMemory()) {
+      deallocate(_buffer);
     }
   }
 
@@ -156,6 +284,84 @@ class Buffer {
     initWithNone();
   }
 
+  // resets the Buffer and adjusts its capacity for the next value. the
+  // current size is recorded in hint first. if the capacity is far above
+  // the estimated size, excess memory is released
+  void reset(SizeHint& hint) {
+    hint.update(_size);
+    reset();
+    // reserve() wants one byte more than the value needs
+    ValueLength const wanted = hint.estimate() + 1;
+    if (_capacity > 2 * wanted + sizeof(_local)) {
+      shrinkToFit(wanted);
+    } else if (_capacity < wanted) {
+      reserve(wanted);
+    }
+  }
+
+  BufferGrowthPolicy const* growthPolicy() const noexcept {
+    return _growthPolicy;
+  }
+
+  void setGrowthPolicy(BufferGrowthPolicy const* policy) {
+    if (policy == nullptr) {
+      throw Exception(Exception::InternalError,
+                      "BufferGrowthPolicy cannot be a nullptr");
+    }
+    _growthPolicy = policy;
+  }
+
+  // reduces the capacity to the size, but not below minCapacity, and
+  // moves small contents back into the local memory. does nothing for
+  // caller-provided memory, or if the memory cannot be reallocated
+  void shrinkToFit(ValueLength minCapacity = 0) noexcept {
+    if (!usesHeapMemory()) {
+      return;
+    }
+    ValueLength const newLen = (std::max)(_size, minCapacity);
+    if (newLen >= _capacity) {
+      return;
+    }
+    if (newLen <= sizeof(_local)) {
+      memcpy(_local, _buffer, checkOverflow(_size));
+      deallocate(_buffer);
+      _buffer = _local;
+      _capacity = sizeof(_local);
+      if (_size == 0) {
+        initWithNone();
+      }
+      return;
+    }
+    if (_mapped) {
+      ValueLength const mappedLen = MappedMemory::capacity(newLen, *_growthPolicy);
+      if (mappedLen >= _capacity) {
+        return;
+      }
+      T* p = static_cast<T*>(
+          MappedMemory::remap(_buffer, _capacity, mappedLen, *_growthPolicy));
+      if (p != nullptr) {
+        if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+          AllocationTracing::reallocated(_buffer, p, checkOverflow(mappedLen),
+                                         checkOverflow(_size));
+        }
+        _buffer = p;
+        _capacity = mappedLen;
+      }
+      return;
+    }
+    T* p = static_cast<T*>(velocypack_realloc(_buffer, checkOverflow(newLen)));
+    if (p == nullptr) {
+      // the old memory is still valid
+      return;
+    }
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::reallocated(_buffer, p, checkOverflow(newLen),
+                                     checkOverflow(_size));
+    }
+    _buffer = p;
+    _capacity = newLen;
+  }
+
   void resetTo(ValueLength position) {
     if (position > _capacity) { 
       throw Exception(Exception::IndexOutOfBounds);
@@ -183,29 +389,43 @@ class Buffer {
   }
 
   void clear() noexcept {
-    _size = 0;
-    if (_buffer != _local) {
-      velocypack_free(_buffer);
+    if (usesHeapMemory()) {
+      deallocate(_buffer);
       _buffer = _local;
       _capacity = sizeof(_local);
       poison(_buffer, _capacity);
     }
+    _size = 0;
     initWithNone();
   }
 
-  // Steal external memory; only allowed when the buffer is not local,
-  // i.e. !usesLocalMemory()
-   T* steal() noexcept {
+  // Steal heap memory; only allowed when the buffer is neither local nor
+  // caller-provided, i.e. !usesLocalMemory() && !usesExternalMemory().
+  // the memory must be released with velocypack_free(). mapped memory is
+  // copied into heap memory first, use stealMapping() to avoid the copy.
+  // an installed AllocationObserver sees the hand-off as a free
+  T* steal() {
     VELOCYPACK_ASSERT(!usesLocalMemory());
+    VELOCYPACK_ASSERT(!usesExternalMemory());
 
-    auto buffer = _buffer;
-    _buffer = _local;
-    _size = 0;
-    _capacity = sizeof(_local);
-    poison(_buffer, _capacity);
-    initWithNone();
+    if (_mapped) {
+      T* p = allocate((std::max)(_size, ValueLength(1)));
+      memcpy(p, _buffer, checkOverflow(_size));
+      deallocate(_buffer);
+      _buffer = p;
+    }
+    return release();
+  }
 
-    return buffer;
+  // Steal a memory mapping without copying it; only allowed when
+  // usesMappedMemory(). stores the size of the mapping in capacity. the
+  // memory must be released with MappedMemory::unmap(p, capacity)
+  T* stealMapping(ValueLength& capacity) noexcept {
+    VELOCYPACK_ASSERT(usesMappedMemory());
+
+    capacity = _capacity;
+    _mapped = false;
+    return release();
   }
 
   inline T& operator[](std::size_t position) noexcept {
@@ -266,16 +486,113 @@ class Buffer {
   inline bool usesLocalMemory() const noexcept {
     return _buffer == _local;
   }
+
+  // If true, uses caller-provided memory of a fixed capacity
+  inline bool usesExternalMemory() const noexcept {
+    return _external;
+  }
+
+  // If true, uses a memory mapping, see BufferGrowthPolicy::mapThreshold
+  inline bool usesMappedMemory() const noexcept {
+    return _mapped;
+  }
  
  private:
+  inline bool usesHeapMemory() const noexcept {
+    return _buffer != _local && !_external;
+  }
+
+
   // initialize Buffer with a None value
   inline void initWithNone() noexcept { _buffer[0] = '\x00'; }
 
+  // hands out the heap memory and goes back to the local memory. the
+  // memory is no longer the Buffer's, so it is reported as freed
+  T* release() noexcept {
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::freed(_buffer, checkOverflow(_size));
+    }
+    auto buffer = _buffer;
+    _buffer = _local;
+    _size = 0;
+    _capacity = sizeof(_local);
+    poison(_buffer, _capacity);
+    initWithNone();
+
+    return buffer;
+  }
+
   inline void ensureValidPointer(T* ptr) const {
     if (VELOCYPACK_UNLIKELY(ptr == nullptr)) {
       throw std::bad_alloc();
     }
   }
+
+  // all heap memory of the Buffer goes through allocate() and deallocate()
+  // or grow(), so that an installed AllocationObserver sees it
+  T* allocate(ValueLength len) {
+    void* p = velocypack_malloc(checkOverflow(len));
+    if (VELOCYPACK_UNLIKELY(p == nullptr)) {
+      throw std::bad_alloc();
+    }
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::allocated(p, checkOverflow(len),
+                                   AllocationCategory::Buffer);
+    }
+    return static_cast<T*>(p);
+  }
+
+  // p must be _buffer, as the capacity is needed for mapped memory
+  void deallocate(T* p) noexcept {
+    VELOCYPACK_ASSERT(p == _buffer);
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::freed(p, checkOverflow(_size));
+    }
+    if (_mapped) {
+      MappedMemory::unmap(p, _capacity);
+      _mapped = false;
+    } else {
+      velocypack_free(p);
+    }
+  }
+
+  // grows into a memory mapping. returns false if no mapping could be
+  // created, so that the caller can fall back to velocypack_malloc
+  bool growMapped(ValueLength len) {
+    ValueLength const newLen = MappedMemory::capacity(len, *_growthPolicy);
+    T* p;
+    if (_mapped) {
+      p = static_cast<T*>(
+          MappedMemory::remap(_buffer, _capacity, newLen, *_growthPolicy));
+      ensureValidPointer(p);
+      // the kernel moved or extended the pages, nothing to copy
+      if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+        AllocationTracing::reallocated(_buffer, p, checkOverflow(newLen),
+                                       checkOverflow(_size));
+      }
+    } else {
+      p = static_cast<T*>(MappedMemory::map(newLen, *_growthPolicy));
+      if (p == nullptr) {
+        return false;
+      }
+      if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+        AllocationTracing::allocated(p, checkOverflow(newLen),
+                                     AllocationCategory::Buffer);
+      }
+      memcpy(p, _buffer, checkOverflow(_size));
+      if (usesHeapMemory()) {
+        deallocate(_buffer);
+      }
+      _mapped = true;
+    }
+
+    VELOCYPACK_STATISTICS_ADD(BufferReallocations, 1);
+    VELOCYPACK_STATISTICS_ADD(BufferGrowthBytes, newLen - _capacity);
+
+    _buffer = p;
+    _capacity = newLen;
+    return true;
+  }
   
   // poison buffer memory, used only for debugging
 #ifdef VELOCYPACK_DEBUG
@@ -287,17 +604,29 @@ class Buffer {
 #endif
 
   void grow(ValueLength len) {
+    if (_external) {
+      // reserve() asks for one byte more than it needs
+      if (_size + len <= _capacity) {
+        return;
+      }
+      throw Exception(Exception::BufferCapacityExceeded);
+    }
+
     VELOCYPACK_ASSERT(_size + len >= sizeof(_local));
 
-    // need reallocation
-    ValueLength newLen = _size + len;
-    constexpr double growthFactor = 1.5;
-    if (newLen < growthFactor * _size) {
-      // ensure the buffer grows sensibly and not by 1 byte only
-      newLen = static_cast<ValueLength>(growthFactor * _size);
-    }
+    // need reallocation. the policy ensures the buffer grows sensibly
+    // and not by 1 byte only
+    ValueLength const newLen = _growthPolicy->nextCapacity(_size, _size + len);
     VELOCYPACK_ASSERT(newLen > _size);
 
+    if (_mapped || (_growthPolicy->mapThreshold != 0 &&
+                    newLen >= _growthPolicy->mapThreshold)) {
+      if (growMapped(newLen)) {
+        return;
+      }
+      // no mapping possible, use velocypack_malloc instead
+    }
+
     // intentionally do not initialize memory here
     // intentionally also do not care about alignments here, as we
     // expect T to be 1-byte-aignable
@@ -307,14 +636,20 @@ class Buffer {
       p = static_cast<T*>(velocypack_realloc(_buffer, checkOverflow(newLen)));
       ensureValidPointer(p);
       // realloc will have copied the old data
+      if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+        AllocationTracing::reallocated(_buffer, p, checkOverflow(newLen),
+                                       checkOverflow(_size));
+      }
     } else {
-      p = static_cast<T*>(velocypack_malloc(checkOverflow(newLen)));
-      ensureValidPointer(p);
+      p = allocate(newLen);
       // copy existing data into buffer
       memcpy(p, _buffer, checkOverflow(_size));
     }
     poison(p + _capacity, newLen - _capacity);
 
+    VELOCYPACK_STATISTICS_ADD(BufferReallocations, 1);
+    VELOCYPACK_STATISTICS_ADD(BufferGrowthBytes, newLen - _capacity);
+
     _buffer = p;
     _capacity = newLen;
     
@@ -324,6 +659,11 @@ class Buffer {
   T* _buffer;
   ValueLength _capacity;
   ValueLength _size;
+  BufferGrowthPolicy const* _growthPolicy;
+  // memory is provided by the caller and must not be freed or reallocated
+  bool _external;
+  // memory is an anonymous memory mapping
+  bool _mapped;
 
   // an already allocated space for small values
   T _local[192];
@@ -342,3 +682,5 @@ struct BufferNonDeleter {
 using VPackCharBuffer = arangodb::velocypack::CharBuffer;
 using VPackBufferUInt8 = arangodb::velocypack::UInt8Buffer;
 template<typename T> using VPackBuffer = arangodb::velocypack::Buffer<T>;
+using VPackBufferGrowthPolicy = arangodb::velocypack::BufferGrowthPolicy;
+using VPackSizeHint = arangodb::velocypack::SizeHint;
@@ -31,9 +31,11 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Basics.h"
 #include "velocypack/Buffer.h"
@@ -75,6 +77,12 @@ class Builder {
   // size and slice methods to get out the ready built VPack
   // object(s).
 
+ public:
+  // the vector type used for _indexes
+  typedef std::vector<ValueLength,
+                      TracingAllocator<ValueLength, AllocationCategory::BuilderIndex>>
+      IndexVector;
+
  private:
   // Here we collect the result
   std::shared_ptr<Buffer<uint8_t>> _buffer;
@@ -99,10 +107,42 @@ class Builder {
   SmallVector<CompoundInfo, arenaSize> _stack;
 
   // Indices for starts of subindex
-  std::vector<ValueLength> _indexes;
+  IndexVector _indexes;
   // indicates that in the current object the key has been written but the value not yet
   bool _keyWritten;
 
+  // String values of the current top-level value that can be referenced by
+  // later equal String values of the same Array or Object, see
+  // Options::deduplicateStrings
+  struct StringTable {
+    // positions of referenceable Strings and of references, ascending
+    std::vector<ValueLength> strings;
+    std::vector<ValueLength> references;
+    // index into strings, by hash of the String contents
+    std::unordered_map<uint64_t, std::size_t> lookup;
+    // end position of the last tag written. a String directly behind a tag
+    // is never replaced by a reference
+    ValueLength tagEnd = 0;
+
+    void clear() noexcept {
+      strings.clear();
+      references.clear();
+      lookup.clear();
+    }
+
+    // forgets all Strings and references at or behind position
+    void truncate(ValueLength position) noexcept {
+      while (!strings.empty() && strings.back() >= position) {
+        strings.pop_back();
+      }
+      while (!references.empty() && references.back() >= position) {
+        references.pop_back();
+      }
+    }
+  };
+  // only allocated once a String is deduplicated
+  std::unique_ptr<StringTable> _strings;
+
  public:
   Options const* options;
 
@@ -214,8 +254,58 @@ class Builder {
       _start = _bufferPtr->data();
     }
     _keyWritten = false;
+    if (_strings != nullptr) {
+      _strings->clear();
+    }
   }
 
+  // Clear and start from scratch, with a capacity adjusted for the next
+  // value. The size of the current value is recorded in hint, see
+  // Buffer::reset(SizeHint&)
+  void clear(SizeHint& hint) {
+    if (_bufferPtr != nullptr) {
+      _bufferPtr->reset(hint);
+    }
+    clear();
+  }
+
+  // release memory that is not needed for the current contents. the
+  // Buffer keeps a capacity of at least minCapacity
+  void shrinkToFit(ValueLength minCapacity = 0) {
+    if (_bufferPtr != nullptr) {
+      _bufferPtr->shrinkToFit(minCapacity);
+      _start = _bufferPtr->data();
+    }
+    _indexes.shrink_to_fit();
+  }
+
+  // the building state at some point, see savepoint()
+  struct Savepoint {
+    ValueLength pos;
+    std::size_t stackSize;
+    std::size_t indexesSize;
+    // start position of the innermost open Array or Object, if any
+    ValueLength compoundStart;
+    bool keyWritten;
+  };
+
+  // returns the current building state, which can be restored with
+  // rollback(). a Savepoint must only be used with the Builder it was
+  // obtained from, and not after the Builder was cleared
+  Savepoint savepoint() const noexcept {
+    return Savepoint{_pos, _stack.size(), _indexes.size(),
+                     _stack.empty() ? 0 : _stack.back().startPos,
+                     _keyWritten};
+  }
+
+  // discards everything that was added since the Savepoint was taken,
+  // including Arrays and Objects that were opened or closed since then.
+  // throws BuilderInvalidSavepoint if an Array or Object that was open
+  // when the Savepoint was taken has been closed since. this cannot be
+  // detected for an Object whose close() failed with a
+  // DuplicateAttributeName exception, so such Savepoints must not be used
+  void rollback(Savepoint const& savepoint);
+
   // Return a pointer to the start of the result:
   uint8_t* start() const {
     if (isClosed()) {
@@ -502,6 +592,35 @@ class Builder {
     return add(std::move(sub));
   }
 
+  // Add an Array with all the given values in one go. this produces the
+  // same result as adding the values one by one, but computes the Array
+  // layout up front and writes the values in a tight loop. T can be an
+  // integral type (except bool), a floating-point type, std::string_view
+  // or std::string
+  template <typename T>
+  uint8_t* addArray(T const* values, std::size_t n, bool unindexed = false) {
+    return addInternal<TypedArray<T>>(TypedArray<T>{values, n, unindexed});
+  }
+
+  template <typename T, typename A>
+  uint8_t* addArray(std::vector<T, A> const& values, bool unindexed = false) {
+    return addArray(values.data(), values.size(), unindexed);
+  }
+
+  // Add an Array with all the given values into an Object, see above
+  template <typename T>
+  uint8_t* addArray(std::string_view attrName, T const* values, std::size_t n,
+                    bool unindexed = false) {
+    return addInternal<TypedArray<T>>(attrName,
+                                      TypedArray<T>{values, n, unindexed});
+  }
+
+  template <typename T, typename A>
+  uint8_t* addArray(std::string_view attrName,
+                    std::vector<T, A> const& values, bool unindexed = false) {
+    return addArray(attrName, values.data(), values.size(), unindexed);
+  }
+
   // Seal the innermost array or object:
   Builder& close();
 
@@ -557,16 +676,16 @@ class Builder {
   void closeLevel() noexcept;
 
   void sortObjectIndexShort(uint8_t* objBase,
-                            std::vector<ValueLength>::iterator indexStart,
-                            std::vector<ValueLength>::iterator indexEnd) const;
+                            IndexVector::iterator indexStart,
+                            IndexVector::iterator indexEnd) const;
 
   void sortObjectIndexLong(uint8_t* objBase,
-                           std::vector<ValueLength>::iterator indexStart,
-                           std::vector<ValueLength>::iterator indexEnd) const;
+                           IndexVector::iterator indexStart,
+                           IndexVector::iterator indexEnd) const;
 
   void sortObjectIndex(uint8_t* objBase,
-                       std::vector<ValueLength>::iterator indexStart,
-                       std::vector<ValueLength>::iterator indexEnd) {
+                       IndexVector::iterator indexStart,
+                       IndexVector::iterator indexEnd) {
     std::size_t const n = std::distance(indexStart, indexEnd);
 
     if (n > 32) {
@@ -581,13 +700,13 @@ class Builder {
 
   // close for the compact case:
   bool closeCompactArrayOrObject(ValueLength pos, bool isArray,
-                                 std::vector<ValueLength>::iterator indexStart,
-                                 std::vector<ValueLength>::iterator indexEnd);
+                                 IndexVector::iterator indexStart,
+                                 IndexVector::iterator indexEnd);
 
   // close for the array case:
   Builder& closeArray(ValueLength pos,
-                      std::vector<ValueLength>::iterator indexStart,
-                      std::vector<ValueLength>::iterator indexEnd);
+                      IndexVector::iterator indexStart,
+                      IndexVector::iterator indexEnd);
 
   void addNull() {
     appendByte(0x18);
@@ -684,6 +803,167 @@ class Builder {
 
   void appendTag(uint64_t tag);
 
+  // the values for addArray()
+  template <typename T>
+  struct TypedArray {
+    static_assert(!std::is_same_v<T, bool>, "bool values are not supported");
+    static_assert(std::is_integral_v<T> || std::is_floating_point_v<T> ||
+                      std::is_same_v<T, std::string_view> ||
+                      std::is_same_v<T, std::string>,
+                  "unsupported value type");
+
+    // the type the values are encoded as. small integral types are
+    // promoted to int, like when passing them to Value
+    using Promoted =
+        decltype(+std::declval<std::conditional_t<std::is_integral_v<T>, T, int>>());
+    using Member = std::conditional_t<
+        std::is_floating_point_v<T>, double,
+        std::conditional_t<
+            std::is_integral_v<T>,
+            std::conditional_t<std::is_signed_v<Promoted>, int64_t, uint64_t>,
+            std::string_view>>;
+
+    T const* values;
+    std::size_t n;
+    bool unindexed;
+  };
+
+  // the layout of an Array written by addArray()
+  struct ArrayLayout {
+    ValueLength byteSize;
+    ValueLength headerSize;
+    // offset of the index table, and byte width of its entries. the width
+    // is 0 if there is no index table
+    ValueLength tableOffset;
+    unsigned int offsetSize;
+    bool compact;
+  };
+
+  // reserves memory for an Array with n members, which occupy payloadSize
+  // bytes in total, and writes its header at the current position
+  ArrayLayout prepareArray(ValueLength n, ValueLength payloadSize,
+                           bool equalSizes, bool unindexed);
+
+  // writes the number of members behind the index table or the members
+  // if required, and moves the position behind the Array
+  void finishArray(ArrayLayout const& layout, ValueLength n);
+
+  // byte sizes and unchecked writers for the members of typed Arrays.
+  // these produce the same encoding as set(Value)
+  static ValueLength memberSize(int64_t v) noexcept {
+    if (v >= -6 && v <= 9) {
+      // SmallInt
+      return 1;
+    }
+    return 1 + intLength(v);
+  }
+
+  static ValueLength memberSize(uint64_t v) noexcept {
+    if (v <= 9) {
+      // SmallInt
+      return 1;
+    }
+    ValueLength vSize = 0;
+    do {
+      vSize++;
+      v >>= 8;
+    } while (v != 0);
+    return 1 + vSize;
+  }
+
+  static ValueLength memberSize(double) noexcept { return 1 + sizeof(double); }
+
+  static ValueLength memberSize(std::string_view v) noexcept {
+    return (v.size() <= 126 ? 1 : 1 + 8) + v.size();
+  }
+
+  static uint8_t* writeMember(uint8_t* p, int64_t v) noexcept {
+    if (v >= 0 && v <= 9) {
+      *p++ = static_cast<uint8_t>(0x30 + v);
+    } else if (v < 0 && v >= -6) {
+      *p++ = static_cast<uint8_t>(0x40 + v);
+    } else {
+      uint8_t vSize = intLength(v);
+      uint64_t x;
+      if (vSize == 8) {
+        x = toUInt64(v);
+      } else {
+        int64_t shift = 1LL << (vSize * 8 - 1);  // will never overflow!
+        x = v >= 0 ? static_cast<uint64_t>(v)
+                   : static_cast<uint64_t>(v + shift) + shift;
+      }
+      *p++ = 0x1f + vSize;
+      while (vSize-- > 0) {
+        *p++ = x & 0xff;
+        x >>= 8;
+      }
+    }
+    return p;
+  }
+
+  static uint8_t* writeMember(uint8_t* p, uint64_t v) noexcept {
+    if (v <= 9) {
+      *p++ = static_cast<uint8_t>(0x30 + v);
+    } else {
+      uint8_t* head = p++;
+      uint8_t vSize = 0;
+      do {
+        vSize++;
+        *p++ = static_cast<uint8_t>(v & 0xff);
+        v >>= 8;
+      } while (v != 0);
+      *head = 0x27 + vSize;
+    }
+    return p;
+  }
+
+  static uint8_t* writeMember(uint8_t* p, double v) noexcept {
+    uint64_t dv;
+    memcpy(&dv, &v, sizeof(double));
+    dv = hostToLittle(dv);
+    *p++ = 0x1b;
+    memcpy(p, &dv, sizeof(double));
+    return p + sizeof(double);
+  }
+
+  static uint8_t* writeMember(uint8_t* p, std::string_view v) noexcept {
+    if (v.size() <= 126) {
+      *p++ = static_cast<uint8_t>(0x40 + v.size());
+    } else {
+      *p++ = 0xbf;
+      uint64_t x = v.size();
+      for (std::size_t i = 0; i < 8; ++i) {
+        *p++ = x & 0xff;
+        x >>= 8;
+      }
+    }
+    memcpy(p, v.data(), v.size());
+    return p + v.size();
+  }
+
+  // replaces the String value that was just written at position pos by a
+  // reference to an equal earlier String value, if deduplication is
+  // enabled and pos is not an attribute name or a tagged value
+  inline void checkStringDeduplication(ValueLength pos) {
+    if (VELOCYPACK_UNLIKELY(options->deduplicateStrings) && !_stack.empty() &&
+        Options::Defaults.resolveStringReferences) {
+      ValueLength const to = _stack.back().startPos;
+      if ((_start[to] == 0x0b || _start[to] == 0x14) && _keyWritten) {
+        // attribute name
+        return;
+      }
+      if (Slice(_start + pos).getStringLength() >= options->deduplicateStringsMinLength) {
+        deduplicateString(pos);
+      }
+    }
+  }
+
+  void deduplicateString(ValueLength pos);
+
+  // adjusts the String positions and references after the data at and
+  // behind position from was moved down by delta bytes
+  void shiftStrings(ValueLength from, ValueLength delta) noexcept;
+
   inline void checkKeyIsString(bool isString) {
     if (!_stack.empty()) {
       ValueLength const pos = _stack.back().startPos;
@@ -897,6 +1177,94 @@ class Builder {
 
   uint8_t* set(Slice const& item);
 
+  // writes the members of a typed Array, and their offsets into the index
+  // table if offsetSize is not 0
+  template <unsigned int offsetSize, typename Member, typename T>
+  static uint8_t* writeMembers(uint8_t* start, ValueLength headerSize,
+                               uint8_t* table,
+                               TypedArray<T> const& array) noexcept {
+    uint8_t* p = start + headerSize;
+    for (std::size_t i = 0; i < array.n; ++i) {
+      if constexpr (offsetSize == 1) {
+        *table++ = static_cast<uint8_t>(p - start);
+      } else if constexpr (offsetSize == 2) {
+        uint16_t x = hostToLittle(static_cast<uint16_t>(p - start));
+        memcpy(table, &x, sizeof(x));
+        table += sizeof(x);
+      } else if constexpr (offsetSize == 4) {
+        uint32_t x = hostToLittle(static_cast<uint32_t>(p - start));
+        memcpy(table, &x, sizeof(x));
+        table += sizeof(x);
+      } else if constexpr (offsetSize == 8) {
+        uint64_t x = hostToLittle(static_cast<uint64_t>(p - start));
+        memcpy(table, &x, sizeof(x));
+        table += sizeof(x);
+      }
+      p = writeMember(p, static_cast<Member>(array.values[i]));
+    }
+    return p;
+  }
+
+  template <typename T>
+  uint8_t* set(TypedArray<T> const& array) {
+    using Member = typename TypedArray<T>::Member;
+
+    checkKeyIsString(false);
+
+    if constexpr (std::is_same_v<Member, std::string_view>) {
+      if (VELOCYPACK_UNLIKELY(options->deduplicateStrings) &&
+          Options::Defaults.resolveStringReferences) {
+        // go the regular way, so equal Strings are replaced
+        auto const oldPos = _pos;
+        addArray(array.unindexed);
+        for (std::size_t i = 0; i < array.n; ++i) {
+          add(Value(static_cast<Member>(array.values[i])));
+        }
+        close();
+        return _start + oldPos;
+      }
+    }
+
+    ValueLength payloadSize = 0;
+    bool equalSizes = true;
+    if (array.n > 0) {
+      ValueLength const first = memberSize(static_cast<Member>(array.values[0]));
+      for (std::size_t i = 0; i < array.n; ++i) {
+        ValueLength const size = memberSize(static_cast<Member>(array.values[i]));
+        equalSizes &= (size == first);
+        payloadSize += size;
+      }
+    }
+
+    auto const oldPos = _pos;
+    ArrayLayout const layout =
+        prepareArray(array.n, payloadSize, equalSizes, array.unindexed);
+    uint8_t* start = _start + oldPos;
+    uint8_t* table = start + layout.tableOffset;
+    uint8_t* p;
+    switch (layout.offsetSize) {
+      case 0:
+        p = writeMembers<0, Member>(start, layout.headerSize, table, array);
+        break;
+      case 1:
+        p = writeMembers<1, Member>(start, layout.headerSize, table, array);
+        break;
+      case 2:
+        p = writeMembers<2, Member>(start, layout.headerSize, table, array);
+        break;
+      case 4:
+        p = writeMembers<4, Member>(start, layout.headerSize, table, array);
+        break;
+      default:
+        p = writeMembers<8, Member>(start, layout.headerSize, table, array);
+        break;
+    }
+    VELOCYPACK_ASSERT(p == start + layout.headerSize + payloadSize);
+    (void) p;
+    finishArray(layout, array.n);
+    return start;
+  }
+
   uint8_t* set(Serializable const& sable) {
     auto const oldPos = _pos;
 
@@ -975,6 +1343,9 @@ class Builder {
   }
 
   inline void resetTo(std::size_t value) {
+    if (_strings != nullptr) {
+      _strings->truncate(value);
+    }
     _pos = value;
     VELOCYPACK_ASSERT(_bufferPtr != nullptr);
     _bufferPtr->resetTo(value);
@@ -27,6 +27,7 @@
 #include <functional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <vector>
 
@@ -204,6 +205,53 @@ class Collection {
   }
   static Builder& merge(Builder& builder, Slice const& left, Slice const& right, bool mergeValues, bool nullMeansRemove = false);
 
+  // applies an RFC 7386 JSON merge patch to target. values of target that
+  // are not touched by the patch are copied as raw bytes
+  static Builder mergePatch(Slice const& target, Slice const& patch);
+  static Builder& mergePatch(Builder& builder, Slice const& target,
+                             Slice const& patch);
+
+  // applies an RFC 6902 JSON patch, i.e. an Array of operations, to target.
+  // only the compound values along the paths of the operations are rebuilt,
+  // all other values are copied as raw bytes. throws PatchTestFailed if a
+  // "test" operation fails
+  static Builder applyPatch(Slice const& target, Slice const& operations);
+
+  // overwrites the value that the JSON pointer refers to in the VPack value
+  // at data, if the new value has the same byte size. returns false and
+  // leaves the data untouched otherwise
+  static bool replaceInPlace(uint8_t* data, std::string_view pointer,
+                             Slice const& value);
+  static bool replaceInPlace(Builder& builder, std::string_view pointer,
+                             Slice const& value);
+
+  // returns an RFC 6902 JSON patch that turns oldValue into newValue when
+  // passed to applyPatch(). subtrees with identical bytes are skipped
+  // without being visited, and Objects and Arrays are diffed recursively.
+  // scalars that compare equal with NormalizedCompare produce no operation
+  static Builder diff(Slice const& oldValue, Slice const& newValue);
+  static Builder& diff(Builder& builder, Slice const& oldValue,
+                       Slice const& newValue);
+
+  // returns a new Array with the distinct members of the array, in the order
+  // of their first occurrence. members are compared using NormalizedCompare
+  static Builder distinct(Slice const& array);
+  static Builder& distinct(Builder& builder, Slice const& array);
+
+  // groups the array members by the key computed by keyFunc, and returns an
+  // Array with one [key, [members...]] entry per group. groups are returned
+  // in the order of the first occurrence of their key, and keys are compared
+  // using NormalizedCompare. the Slice returned by keyFunc must remain valid
+  // until the grouping is complete, e.g. by pointing into the member
+  static Builder groupBy(Slice const& array,
+                         std::function<Slice(Slice const&)> const& keyFunc);
+  static Builder& groupBy(Builder& builder, Slice const& array,
+                          std::function<Slice(Slice const&)> const& keyFunc);
+
+  // groups the array members by the value of the attribute. members that
+  // are not Objects or do not have the attribute are grouped under null
+  static Builder groupBy(Slice const& array, std::string_view attribute);
+
   static void visitRecursive(
       Slice const& slice, VisitationOrder order,
       std::function<bool(Slice const&, Slice const&)> const& func);
@@ -217,6 +265,18 @@ class Collection {
   static Builder sort(
       Slice const& array,
       std::function<bool (Slice const&, Slice const&)> lessthan);
+
+  // sorts the array members using the total order of NormalizedCompare
+  static Builder sort(Slice const& array);
+
+  // sorts the array members using up to numThreads threads. if numThreads
+  // is 0, the number of hardware threads is used. small arrays are sorted
+  // on the calling thread only. lessthan will be called concurrently from
+  // multiple threads and thus must be thread-safe
+  static Builder sortParallel(
+      Slice const& array,
+      std::function<bool (Slice const&, Slice const&)> lessthan,
+      std::size_t numThreads = 0);
 };
 
 struct IsEqualPredicate {
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "velocypack/velocypack-common.h"
 
 namespace arangodb::velocypack {
@@ -63,6 +65,23 @@ struct NormalizedCompare {
   // function to compare two arbitrary Slices
   static bool equals(Slice lhs, Slice rhs);
 
+  // three-way comparison of two arbitrary Slices. returns a value < 0 if
+  // lhs sorts before rhs, 0 if both are considered equal and a value > 0
+  // if lhs sorts after rhs. values of different types are ordered as
+  // MinKey < None < Illegal < Null < Bool < numbers < UTCDate < String <
+  // Binary < Array < Object < MaxKey. numbers are compared by their exact
+  // numeric value regardless of their representation, strings and binary
+  // values byte-wise, arrays element-wise and objects attribute-wise in
+  // attribute name order
+  static int compare(Slice lhs, Slice rhs);
+
+  // appends a binary sort key for the Slice to out. comparing two sort keys
+  // with memcmp (shorter key first on a common prefix) yields the same order
+  // as compare() on the original Slices
+  static void sortKey(Slice slice, std::string& out);
+
+  static std::string sortKey(Slice slice);
+
   struct Hash {
     size_t operator()(arangodb::velocypack::Slice const&) const;
   };
@@ -78,6 +97,11 @@ struct NormalizedCompare {
                     arangodb::velocypack::Slice const&) const;
   };
 
+  struct Less {
+    bool operator()(arangodb::velocypack::Slice const&,
+                    arangodb::velocypack::Slice const&) const;
+  };
+
 };
   
 } // namespace arangodb::velocypack
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+
+namespace arangodb::velocypack {
+
+// a fast, self-contained block compressor for VPack data. compressed blocks
+// use the LZ4 block format (sequences of literals and back-references of
+// at least 4 bytes within a 64KB window). the original size is not stored
+// in the compressed data and must be known when decompressing
+struct BlockCodec {
+  BlockCodec() = delete;
+
+  // upper bound for the compressed size of size bytes
+  static constexpr std::size_t maxCompressedSize(std::size_t size) noexcept {
+    return size + size / 255 + 16;
+  }
+
+  // appends the compressed form of data to out. returns the number of
+  // bytes appended
+  static std::size_t compress(uint8_t const* data, std::size_t size,
+                              Buffer<uint8_t>& out);
+
+  // decompresses data into out, which must have room for exactly
+  // originalSize bytes. throws if the compressed data is invalid or does
+  // not decompress to exactly originalSize bytes
+  static void decompress(uint8_t const* data, std::size_t size, uint8_t* out,
+                         std::size_t originalSize);
+
+  // appends the decompressed form of data to out
+  static void decompress(uint8_t const* data, std::size_t size,
+                         Buffer<uint8_t>& out, std::size_t originalSize);
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackBlockCodec = arangodb::velocypack::BlockCodec;
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Sink.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// a seekable container of many top-level VPack values. the layout is
+//
+//   magic | block 0 | ... | block n-1 | footer | footer offset | magic
+//
+// magic is the 8 byte string "VPACKCT1", and the footer offset is stored as
+// an 8 byte little endian number. each block contains a sequence of values.
+// the footer is a VPack Object with the attributes
+//   - "count": number of values
+//   - "attribute": name of the indexed attribute, or null
+//   - "blocks": Array with one Object per block, with the attributes
+//     "offset", "size", "first" (index of the first value) and "count", and,
+//     if an attribute is indexed and contained in any value of the block,
+//     "min" and "max" (its smallest and largest value according to
+//     NormalizedCompare) and "bloom" (a Bloom filter of the normalized hashes
+//     of its values, as Binary). blocks compressed with BlockCodec also
+//     have the attribute "rawSize", their uncompressed size
+//   - "offsets": Binary with the 4 byte little endian offset of each value,
+//     relative to the start of its (uncompressed) block
+struct ContainerFormat {
+  static constexpr char magic[] = "VPACKCT1";
+  static constexpr std::size_t magicSize = 8;
+  static constexpr std::size_t trailerSize = 8 + magicSize;
+};
+
+// writes values into a container
+class ContainerWriter {
+ public:
+  static constexpr std::size_t defaultBlockSize = 64 * 1024;
+
+  ContainerWriter(ContainerWriter const&) = delete;
+  ContainerWriter& operator=(ContainerWriter const&) = delete;
+
+  // if attribute is not empty, its values are indexed in each block.
+  // a block is closed once it contains at least blockSize bytes. if compress
+  // is true, blocks are compressed with BlockCodec, unless that does not
+  // make them smaller
+  explicit ContainerWriter(Sink* sink, std::string attribute = std::string(),
+                           std::size_t blockSize = defaultBlockSize,
+                           bool compress = false);
+
+  void add(Slice value);
+
+  // writes the last block and the footer. no values can be added afterwards
+  void finish();
+
+  std::size_t count() const noexcept { return _count; }
+
+ private:
+  void flushBlock();
+
+  Sink* _sink;
+  std::string const _attribute;
+  std::size_t const _blockSize;
+  bool const _compress;
+
+  // values and index data of the current block
+  Buffer<uint8_t> _block;
+  Buffer<uint8_t> _compressed;
+  std::size_t _blockCount;
+  Builder _min;
+  Builder _max;
+  std::vector<uint64_t> _hashes;
+
+  // index data of all blocks
+  Builder _blocks;
+  Buffer<uint8_t> _offsets;
+  uint64_t _written;
+  std::size_t _count;
+  bool _finished;
+};
+
+// provides random access to the values of a container. the container data
+// must remain valid while the reader is used. the footer is validated when
+// creating the reader, but the values are not.
+// compressed blocks are decompressed on first access by at() and kept
+// until the reader is destroyed
+class ContainerReader {
+ public:
+  struct Block {
+    // position and size of the block in the container
+    std::size_t offset;
+    std::size_t size;
+    // size of the block after decompression, equal to size for uncompressed
+    // blocks
+    std::size_t rawSize;
+    bool compressed;
+    // index of the first value in the block
+    std::size_t first;
+    std::size_t count;
+    // smallest and largest value of the indexed attribute in the block, or
+    // None if no value in the block contains the attribute
+    Slice min;
+    Slice max;
+    // Bloom filter for the indexed attribute, or None
+    Slice bloom;
+  };
+
+  ContainerReader(uint8_t const* data, std::size_t size);
+  explicit ContainerReader(Buffer<uint8_t> const& buffer)
+      : ContainerReader(buffer.data(), buffer.size()) {}
+  ~ContainerReader();
+
+  std::size_t count() const noexcept { return _count; }
+
+  std::size_t numBlocks() const noexcept { return _blocks.size(); }
+
+  Block const& block(std::size_t index) const { return _blocks.at(index); }
+
+  // name of the indexed attribute, or empty if there is none
+  std::string_view attribute() const noexcept { return _attribute; }
+
+  // returns the value with the specified index
+  Slice at(std::size_t index) const;
+
+  // returns the index of the block containing the value with the specified
+  // index
+  std::size_t blockOf(std::size_t index) const;
+
+  // returns false if no value in the block has the indexed attribute with
+  // the specified value. returns true if there is no indexed attribute
+  bool mayContain(std::size_t block, Slice value) const;
+
+  // calls callback for all values in the blocks accepted by blockFilter,
+  // until callback returns false. compressed blocks are decompressed into a
+  // temporary buffer, so their values are only valid during the callback
+  void forEach(std::function<bool(Block const&)> const& blockFilter,
+               std::function<bool(Slice)> const& callback) const;
+
+  // calls callback for all values whose indexed attribute is equal to value,
+  // skipping all blocks that cannot contain such values
+  void find(Slice value, std::function<bool(Slice)> const& callback) const;
+
+ private:
+  struct DecompressedBlock;
+
+  // returns the uncompressed data of a block, decompressing it on first use
+  uint8_t const* blockData(std::size_t block) const;
+
+  bool visitBlock(std::size_t block,
+                  std::function<bool(Slice)> const& callback) const;
+
+  uint8_t const* _data;
+  std::size_t _count;
+  std::string_view _attribute;
+  std::vector<Block> _blocks;
+  uint8_t const* _offsets;
+  std::unique_ptr<DecompressedBlock[]> _decompressed;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackContainerWriter = arangodb::velocypack::ContainerWriter;
+using VPackContainerReader = arangodb::velocypack::ContainerReader;
@@ -52,6 +52,9 @@ class Exception : public virtual std::exception {
     CannotTranslateKey = 21,
     KeyNotFound = 22, // not used anymore
     BadTupleSize = 23,
+    PatchTestFailed = 24,
+    BufferCapacityExceeded = 25,
+    InvalidQuery = 26,
 
     BuilderNotSealed = 30,
     BuilderNeedOpenObject = 31,
@@ -66,6 +69,7 @@ class Exception : public virtual std::exception {
     BuilderCustomDisallowed = 40,
     BuilderTagsDisallowed = 41,
     BuilderBCDDisallowed = 42,
+    BuilderInvalidSavepoint = 43,
 
     ValidatorInvalidLength = 50,
     ValidatorInvalidType = 51,
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// sorts an unbounded sequence of VPack values using a bounded amount of
+// memory. values are collected in memory until the memory limit is
+// reached. the collected values are then sorted and written into a run
+// file in the temp directory, as a sequence of concatenated VPack values.
+// finish() merges all runs and hands out the values in sorted order.
+// all run files are removed when the ExternalSorter is destroyed.
+class ExternalSorter {
+ public:
+  typedef std::function<bool(Slice const&, Slice const&)> LessThan;
+
+  // default memory limit for the in-memory part of the values
+  static constexpr ValueLength defaultMemoryLimit = 64 * 1024 * 1024;
+
+  ExternalSorter(ExternalSorter const&) = delete;
+  ExternalSorter& operator=(ExternalSorter const&) = delete;
+
+  // if no comparison function is given, the values are sorted according
+  // to NormalizedCompare::compare()
+  explicit ExternalSorter(std::string tempDirectory,
+                          ValueLength memoryLimit = defaultMemoryLimit,
+                          LessThan lessthan = LessThan());
+
+  ~ExternalSorter();
+
+  // add a value to be sorted. the value is copied
+  void add(Slice value);
+
+  // add all members of an Array
+  void addArray(Slice array);
+
+  // merges all values and calls consumer for each of them in sorted order.
+  // the Slices passed to the consumer are only valid during the call
+  void finish(std::function<void(Slice)> const& consumer);
+
+  // merges all values and appends them in sorted order to the Builder.
+  // the Builder must be empty or have an open Array
+  void finish(Builder& builder);
+
+  // number of values added
+  ValueLength count() const noexcept { return _count; }
+
+  // number of run files written so far
+  std::size_t numRuns() const noexcept { return _runs.size(); }
+
+ private:
+  // sort the in-memory values and write them into a new run file
+  void spill();
+
+  // sort the in-memory values
+  void sortMemory();
+
+  std::string _tempDirectory;
+  ValueLength const _memoryLimit;
+  LessThan _lessthan;
+  // in-memory values, stored as concatenated VPack values
+  Buffer<uint8_t> _data;
+  // offsets of the in-memory values in _data
+  std::vector<ValueLength> _offsets;
+  std::vector<std::string> _runs;
+  ValueLength _count;
+  bool _finished;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackExternalSorter = arangodb::velocypack::ExternalSorter;
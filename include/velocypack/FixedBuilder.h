@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Options.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// a Builder that writes directly into a caller-provided memory region of a
+// fixed capacity, e.g. a network send buffer or a slot in a shared-memory
+// ring. it never reallocates. instead, all modifying methods return false
+// if the data does not fit, and the FixedBuilder then refuses further
+// modifications until rollback() or clear() is called.
+// rollback() restores the state right after the last complete top-level
+// value, so all values that were completed before the overflow can still
+// be sent. alternatively, rollback(savepoint) restores any earlier state,
+// e.g. to skip a single member that did not fit.
+// modifications that fit into the memory region do not throw. exceptions
+// are only thrown for invalid usage, e.g. adding a key/value pair to an
+// Array, exactly as in Builder.
+// Arrays and Objects are written with a preliminary 9 byte header that is
+// shrunk by close(), so the memory region needs some headroom beyond the
+// final size of such values. the internal bookkeeping for open Arrays and
+// Objects still uses heap memory.
+class FixedBuilder {
+ public:
+  FixedBuilder(uint8_t* data, ValueLength capacity,
+               Options const* options = &Options::Defaults);
+
+  // the Builder points into _buffer, so the FixedBuilder cannot be moved
+  FixedBuilder(FixedBuilder const&) = delete;
+  FixedBuilder& operator=(FixedBuilder const&) = delete;
+
+  // whether the last modification did not fit into the memory region
+  bool overflowed() const noexcept { return _overflowed; }
+
+  ValueLength capacity() const noexcept { return _buffer.capacity(); }
+
+  // number of bytes occupied by complete top-level values
+  ValueLength size() const noexcept { return _committed.pos; }
+
+  uint8_t const* data() const noexcept { return _buffer.data(); }
+
+  // returns the first complete top-level value, or a None Slice
+  Slice slice() const noexcept {
+    if (_committed.pos == 0) {
+      return Slice();
+    }
+    return Slice(_buffer.data());
+  }
+
+  Builder const& builder() const noexcept { return _builder; }
+
+  bool openArray(bool unindexed = false) {
+    return run([&]() { _builder.openArray(unindexed); });
+  }
+
+  bool openObject(bool unindexed = false) {
+    return run([&]() { _builder.openObject(unindexed); });
+  }
+
+  bool close() {
+    return run([&]() { _builder.close(); });
+  }
+
+  // add a value to an Array or at top level
+  template <typename T>
+  bool add(T const& sub) {
+    return run([&]() { _builder.add(sub); });
+  }
+
+  // add a key/value pair to an Object
+  template <typename T>
+  bool add(std::string_view attrName, T const& sub) {
+    return run([&]() { _builder.add(attrName, sub); });
+  }
+
+  Builder::Savepoint savepoint() const noexcept {
+    return _builder.savepoint();
+  }
+
+  // discard everything behind the last complete top-level value and
+  // clear the overflow state
+  void rollback() noexcept;
+
+  // discard everything that was added since the savepoint was taken and
+  // clear the overflow state
+  void rollback(Builder::Savepoint const& savepoint);
+
+  // discard everything and clear the overflow state
+  void clear() noexcept;
+
+ private:
+  template <typename F>
+  bool run(F&& modify) {
+    if (VELOCYPACK_UNLIKELY(_overflowed)) {
+      return false;
+    }
+    try {
+      modify();
+    } catch (Exception const& ex) {
+      if (ex.errorCode() != Exception::BufferCapacityExceeded) {
+        throw;
+      }
+      _overflowed = true;
+      return false;
+    }
+    if (_builder.isClosed()) {
+      _committed = _builder.savepoint();
+    }
+    return true;
+  }
+
+  Buffer<uint8_t> _buffer;
+  Builder _builder;
+  // state after the last complete top-level value
+  Builder::Savepoint _committed;
+  bool _overflowed;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackFixedBuilder = arangodb::velocypack::FixedBuilder;
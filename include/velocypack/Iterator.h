@@ -24,8 +24,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iosfwd>
+#include <iterator>
 #include <tuple>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Exception.h"
@@ -34,6 +37,16 @@
 
 namespace arangodb::velocypack {
 
+// prefetches the index table of an indexed Array or Object, which is
+// located at its end. the header byte of the value should already be in
+// the CPU cache, as it needs to be read
+inline void prefetchIndexTable(uint8_t const* start) {
+  uint8_t const head = *start;
+  if ((head >= 0x06 && head <= 0x09) || (head >= 0x0b && head <= 0x0e)) {
+    VELOCYPACK_PREFETCH(start + Slice(start).byteSize() - 1);
+  }
+}
+
 class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
  public:
   using iterator_category = std::forward_iterator_tag;
@@ -44,10 +57,16 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
 
   // optimization for an empty array
   explicit ArrayIterator(Empty) noexcept
-      : _slice(Slice::emptyArraySlice()), _size(0), _position(0), _current(nullptr), _first(nullptr) {}
+      : _slice(Slice::emptyArraySlice()), _size(0), _position(0), _current(nullptr), _first(nullptr), _prefetch(0) {}
 
-  explicit ArrayIterator(Slice slice)
-      : _slice(slice), _size(0), _position(0), _current(nullptr), _first(nullptr) {
+  // With a prefetchDistance > 0, advancing the iterator prefetches the
+  // member that many positions ahead, and the index table of the member
+  // half that distance ahead. This hides memory latency when iterating
+  // over large members which are not in the CPU caches. Nothing is
+  // prefetched for compact Arrays, as the position of a member is only
+  // known after reading all members before it.
+  explicit ArrayIterator(Slice slice, ValueLength prefetchDistance = 0)
+      : _slice(slice), _size(0), _position(0), _current(nullptr), _first(nullptr), _prefetch(0) {
 
     uint8_t const head = slice.head();
 
@@ -63,6 +82,10 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
         _current = slice.start() + slice.getStartOffsetFromCompact();
       } else {
         _current = slice.begin() + slice.findDataOffset(head);
+        _prefetch = prefetchDistance;
+        for (ValueLength i = 1; i < _prefetch && i < _size; ++i) {
+          VELOCYPACK_PREFETCH(_slice.start() + _slice.getNthOffset(i));
+        }
       }
       _first = _current;
     }
@@ -73,6 +96,9 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
     ++_position;
     if (_position < _size && _current != nullptr) {
       _current += Slice(_current).byteSize();
+      if (_prefetch != 0) {
+        prefetchAhead();
+      }
     } else {
       _current = nullptr;
     }
@@ -95,11 +121,11 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
 
   Slice operator*() const {
     if (_current != nullptr) {
-      return Slice(_current);
+      return Slice(_current).resolveStringReference();
     }
     // intentionally no out-of-bounds checking here, as it will
     // be performed by Slice::getNthOffset()
-    return Slice(_slice.begin() + _slice.getNthOffset(_position));
+    return Slice(_slice.begin() + _slice.getNthOffset(_position)).resolveStringReference();
   }
 
   ArrayIterator begin() const {
@@ -146,7 +172,7 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
         }
       } else {
         _position += count;
-        _current = _slice.at(_position).start();
+        _current = _slice.begin() + _slice.getNthOffset(_position);
       }
     }
   }
@@ -162,6 +188,17 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
   }
 
  private:
+  void prefetchAhead() const {
+    ValueLength target = _position + _prefetch;
+    if (target < _size) {
+      VELOCYPACK_PREFETCH(_slice.start() + _slice.getNthOffset(target));
+    }
+    target = _position + _prefetch / 2;
+    if (target < _size) {
+      prefetchIndexTable(_slice.start() + _slice.getNthOffset(target));
+    }
+  }
+
   template<typename...>
   struct unpack_helper {};
 
@@ -181,6 +218,7 @@ class ArrayIterator : public std::iterator<std::forward_iterator_tag, Slice> {
   ValueLength _position;
   uint8_t const* _current;
   uint8_t const* _first;
+  ValueLength _prefetch;
 };
 
 struct ObjectIteratorPair {
@@ -199,8 +237,11 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
   // The useSequentialIteration flag indicates whether or not the iteration
   // simply jumps from key/value pair to key/value pair without using the
   // index. The default `false` is to use the index if it is there.
-  explicit ObjectIterator(Slice slice, bool useSequentialIteration = false)
-      : _slice(slice), _size(0), _position(0), _current(nullptr), _first(nullptr) {
+  // A prefetchDistance > 0 works as for ArrayIterator, but only if the
+  // Object is iterated via its index.
+  explicit ObjectIterator(Slice slice, bool useSequentialIteration = false,
+                          ValueLength prefetchDistance = 0)
+      : _slice(slice), _size(0), _position(0), _current(nullptr), _first(nullptr), _prefetch(0) {
 
     uint8_t const head = slice.head();
 
@@ -216,6 +257,11 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
         _current = slice.start() + slice.getStartOffsetFromCompact();
       } else if (useSequentialIteration) {
         _current = slice.begin() + slice.findDataOffset(head);
+      } else {
+        _prefetch = prefetchDistance;
+        for (ValueLength i = 1; i < _prefetch && i < _size; ++i) {
+          prefetchMember(i);
+        }
       }
       _first = _current;
     }
@@ -231,6 +277,9 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
       _current += Slice(_current).byteSize();
     } else {
       _current = nullptr;
+      if (_prefetch != 0) {
+        prefetchAhead();
+      }
     }
     return *this;
   }
@@ -253,10 +302,12 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
   ObjectPair operator*() const {
     if (_current != nullptr) {
       Slice key(_current);
-      return ObjectPair(key.makeKey(), Slice(_current + key.byteSize()));
+      return ObjectPair(key.makeKey(),
+                        Slice(_current + key.byteSize()).resolveStringReference());
     }
     Slice key(_slice.getNthKeyUntranslated(_position));
-    return ObjectPair(key.makeKey(), Slice(key.begin() + key.byteSize()));
+    return ObjectPair(key.makeKey(),
+                      Slice(key.begin() + key.byteSize()).resolveStringReference());
   }
 
   ObjectIterator begin() const {
@@ -290,7 +341,7 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
     }
     if (_current != nullptr) {
       Slice key(_current);
-      return Slice(_current + key.byteSize());
+      return Slice(_current + key.byteSize()).resolveStringReference();
     }
     return _slice.getNthValue(_position);
   }
@@ -313,11 +364,294 @@ class ObjectIterator : public std::iterator<std::forward_iterator_tag, ObjectIte
   }
 
  private:
+  // prefetches the key and the start of the value of the nth member
+  void prefetchMember(ValueLength index) const {
+    uint8_t const* key = _slice.start() + _slice.getNthOffset(index);
+    VELOCYPACK_PREFETCH(key);
+    VELOCYPACK_PREFETCH(key + 64);
+  }
+
+  void prefetchAhead() const {
+    ValueLength target = _position + _prefetch;
+    if (target < _size) {
+      prefetchMember(target);
+    }
+    target = _position + _prefetch / 2;
+    if (target < _size) {
+      Slice key(_slice.getNthKeyUntranslated(target));
+      prefetchIndexTable(key.begin() + key.byteSize());
+    }
+  }
+
   Slice _slice;
   ValueLength _size;
   ValueLength _position;
   uint8_t const* _current;
   uint8_t const* _first;
+  ValueLength _prefetch;
+};
+
+// the positions of the members of an Array or Object (of the keys for an
+// Object), for random access. indexed containers are read via their index
+// tables. for compact containers (0x13 and 0x14), which have no index table,
+// the positions are materialized once on construction
+class MemberPositions {
+ public:
+  explicit MemberPositions(Slice slice);
+
+  ValueLength size() const noexcept { return _size; }
+
+  // no bounds checking here
+  uint8_t const* operator[](ValueLength index) const noexcept {
+    VELOCYPACK_ASSERT(index < _size);
+    if (_stride != 0) {
+      return _first + index * _stride;
+    }
+    if (_indexTable != nullptr) {
+      return _first + readIntegerNonEmpty<ValueLength>(
+                          _indexTable + index * _offsetSize, _offsetSize);
+    }
+    return _members[index];
+  }
+
+ private:
+  ValueLength _size;
+  // the first member if members have equal sizes, the container start if
+  // there is an index table
+  uint8_t const* _first;
+  ValueLength _stride;
+  uint8_t const* _indexTable;
+  ValueLength _offsetSize;
+  std::vector<uint8_t const*> _members;
+};
+
+// a random-access iterator over a RandomAccessArray or RandomAccessObject.
+// dereferencing returns the member by value
+template<typename Container>
+class RandomAccessIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename Container::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  RandomAccessIterator() noexcept : _container(nullptr), _position(0) {}
+
+  RandomAccessIterator(Container const* container, ValueLength position) noexcept
+      : _container(container), _position(position) {}
+
+  reference operator*() const { return (*_container)[_position]; }
+
+  reference operator[](difference_type n) const {
+    return (*_container)[_position + n];
+  }
+
+  RandomAccessIterator& operator++() noexcept {
+    ++_position;
+    return *this;
+  }
+
+  RandomAccessIterator operator++(int) noexcept {
+    RandomAccessIterator result(*this);
+    ++_position;
+    return result;
+  }
+
+  RandomAccessIterator& operator--() noexcept {
+    --_position;
+    return *this;
+  }
+
+  RandomAccessIterator operator--(int) noexcept {
+    RandomAccessIterator result(*this);
+    --_position;
+    return result;
+  }
+
+  RandomAccessIterator& operator+=(difference_type n) noexcept {
+    _position += n;
+    return *this;
+  }
+
+  RandomAccessIterator& operator-=(difference_type n) noexcept {
+    _position -= n;
+    return *this;
+  }
+
+  RandomAccessIterator operator+(difference_type n) const noexcept {
+    return RandomAccessIterator(_container, _position + n);
+  }
+
+  friend RandomAccessIterator operator+(difference_type n,
+                                        RandomAccessIterator const& it) noexcept {
+    return it + n;
+  }
+
+  RandomAccessIterator operator-(difference_type n) const noexcept {
+    return RandomAccessIterator(_container, _position - n);
+  }
+
+  difference_type operator-(RandomAccessIterator const& other) const noexcept {
+    return static_cast<difference_type>(_position) -
+           static_cast<difference_type>(other._position);
+  }
+
+  bool operator==(RandomAccessIterator const& other) const noexcept {
+    return _position == other._position;
+  }
+  bool operator!=(RandomAccessIterator const& other) const noexcept {
+    return _position != other._position;
+  }
+  bool operator<(RandomAccessIterator const& other) const noexcept {
+    return _position < other._position;
+  }
+  bool operator>(RandomAccessIterator const& other) const noexcept {
+    return _position > other._position;
+  }
+  bool operator<=(RandomAccessIterator const& other) const noexcept {
+    return _position <= other._position;
+  }
+  bool operator>=(RandomAccessIterator const& other) const noexcept {
+    return _position >= other._position;
+  }
+
+  ValueLength index() const noexcept { return _position; }
+
+ private:
+  Container const* _container;
+  ValueLength _position;
+};
+
+// a contiguous range of members, which can be split further, e.g. for
+// distributing the members over several threads
+template<typename Iterator>
+class IteratorRange {
+ public:
+  IteratorRange(Iterator first, Iterator last) noexcept
+      : _first(first), _last(last) {}
+
+  Iterator begin() const noexcept { return _first; }
+  Iterator end() const noexcept { return _last; }
+  ValueLength size() const noexcept { return static_cast<ValueLength>(_last - _first); }
+  bool empty() const noexcept { return _first == _last; }
+
+  // splits the range into at most the given number of non-empty ranges,
+  // whose sizes differ by at most one
+  std::vector<IteratorRange> split(std::size_t parts) const {
+    std::vector<IteratorRange> result;
+    ValueLength const n = size();
+    if (n == 0) {
+      return result;
+    }
+    if (parts == 0) {
+      parts = 1;
+    } else if (parts > n) {
+      parts = static_cast<std::size_t>(n);
+    }
+    result.reserve(parts);
+    ValueLength const chunk = n / parts;
+    ValueLength const rest = n % parts;
+    Iterator current = _first;
+    for (std::size_t i = 0; i < parts; ++i) {
+      Iterator next = current + static_cast<std::ptrdiff_t>(chunk + (i < rest ? 1 : 0));
+      result.emplace_back(current, next);
+      current = next;
+    }
+    VELOCYPACK_ASSERT(current == _last);
+    return result;
+  }
+
+ private:
+  Iterator _first;
+  Iterator _last;
+};
+
+// random access to the members of an Array. the object must outlive its
+// iterators, and the Slice must stay valid while the object is in use.
+// lookups do not modify any state, so the object and its iterators can be
+// used from multiple threads concurrently
+class RandomAccessArray {
+ public:
+  using value_type = Slice;
+  using iterator = RandomAccessIterator<RandomAccessArray>;
+  using range = IteratorRange<iterator>;
+
+  explicit RandomAccessArray(Slice slice);
+
+  Slice slice() const noexcept { return _slice; }
+  ValueLength size() const noexcept { return _positions.size(); }
+  bool empty() const noexcept { return size() == 0; }
+
+  // no bounds checking here
+  Slice operator[](ValueLength index) const noexcept {
+    return Slice(_positions[index]).resolveStringReference();
+  }
+
+  Slice at(ValueLength index) const {
+    if (VELOCYPACK_UNLIKELY(index >= size())) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+    return operator[](index);
+  }
+
+  iterator begin() const noexcept { return iterator(this, 0); }
+  iterator end() const noexcept { return iterator(this, size()); }
+
+  range all() const noexcept { return range(begin(), end()); }
+  std::vector<range> split(std::size_t parts) const { return all().split(parts); }
+
+ private:
+  Slice _slice;
+  MemberPositions _positions;
+};
+
+// random access to the members of an Object, in the same order as an
+// ObjectIterator without sequential iteration. see RandomAccessArray
+class RandomAccessObject {
+ public:
+  using value_type = ObjectIteratorPair;
+  using iterator = RandomAccessIterator<RandomAccessObject>;
+  using range = IteratorRange<iterator>;
+
+  explicit RandomAccessObject(Slice slice);
+
+  Slice slice() const noexcept { return _slice; }
+  ValueLength size() const noexcept { return _positions.size(); }
+  bool empty() const noexcept { return size() == 0; }
+
+  // no bounds checking here
+  ObjectIteratorPair operator[](ValueLength index) const {
+    Slice key(_positions[index]);
+    return ObjectIteratorPair(key.makeKey(),
+                              Slice(key.begin() + key.byteSize()).resolveStringReference());
+  }
+
+  Slice key(ValueLength index, bool translate = true) const {
+    if (VELOCYPACK_UNLIKELY(index >= size())) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+    Slice key(_positions[index]);
+    return translate ? key.makeKey() : key;
+  }
+
+  Slice value(ValueLength index) const {
+    if (VELOCYPACK_UNLIKELY(index >= size())) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+    Slice key(_positions[index]);
+    return Slice(key.begin() + key.byteSize()).resolveStringReference();
+  }
+
+  iterator begin() const noexcept { return iterator(this, 0); }
+  iterator end() const noexcept { return iterator(this, size()); }
+
+  range all() const noexcept { return range(begin(), end()); }
+  std::vector<range> split(std::size_t parts) const { return all().split(parts); }
+
+ private:
+  Slice _slice;
+  MemberPositions _positions;
 };
 
 }  // namespace arangodb::velocypack
@@ -336,3 +670,5 @@ std::ostream& operator<<(std::ostream&,
 
 using VPackArrayIterator = arangodb::velocypack::ArrayIterator;
 using VPackObjectIterator = arangodb::velocypack::ObjectIterator;
+using VPackRandomAccessArray = arangodb::velocypack::RandomAccessArray;
+using VPackRandomAccessObject = arangodb::velocypack::RandomAccessObject;
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Options.h"
+#include "velocypack/SharedSlice.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// read-only access to a file of concatenated top-level VPack values via a
+// memory mapping. values are returned without copying them. SharedSlices
+// returned by the source keep the mapping alive, even after the source
+// itself has been destroyed. all const methods are thread-safe.
+class MmapSliceSource {
+ public:
+  enum class Validation {
+    // the data is trusted. only the value sizes are checked against the
+    // file size
+    None,
+    // each value is validated when it is accessed for the first time
+    Lazy,
+    // all values are validated when opening the file
+    Eager
+  };
+
+  // hint for the kernel about the expected access pattern (madvise)
+  enum class AccessPattern { Normal, Sequential, Random, WillNeed };
+
+  // sequential iteration over the values, which does not require the
+  // offset index
+  class Iterator {
+    friend class MmapSliceSource;
+
+   public:
+    bool valid() const noexcept { return _offset < _source->_size; }
+
+    // the value at the current position. only valid as long as the source
+    // is alive
+    Slice value() const noexcept { return Slice(_source->_data + _offset); }
+
+    // the value at the current position, which keeps the mapping alive
+    SharedSlice sharedValue() const;
+
+    // byte offset of the current value in the file
+    std::size_t offset() const noexcept { return _offset; }
+
+    void next();
+
+   private:
+    explicit Iterator(MmapSliceSource const* source);
+
+    void check();
+
+    MmapSliceSource const* _source;
+    std::size_t _offset;
+    std::size_t _valueSize;
+  };
+
+  MmapSliceSource(MmapSliceSource const&) = delete;
+  MmapSliceSource& operator=(MmapSliceSource const&) = delete;
+
+  explicit MmapSliceSource(std::string const& filename,
+                           Validation validation = Validation::Lazy,
+                           AccessPattern pattern = AccessPattern::Normal,
+                           Options const* options = &Options::Defaults);
+  ~MmapSliceSource();
+
+  // changes the access pattern hint for the whole mapping
+  void advise(AccessPattern pattern) const;
+
+  // total number of bytes in the file
+  std::size_t byteSize() const noexcept { return _size; }
+
+  Iterator iterator() const { return Iterator(this); }
+
+  // number of values in the file. builds the offset index on first use
+  std::size_t count() const;
+
+  // returns the value with the specified index, building the offset index
+  // on first use. the returned Slice is only valid as long as the source
+  // is alive
+  Slice at(std::size_t index) const;
+
+  // returns the value with the specified index, keeping the mapping alive
+  SharedSlice sharedAt(std::size_t index) const;
+
+ private:
+  struct Mapping;
+
+  // returns the size of the value at offset, checking that the value fits
+  // into the file
+  std::size_t valueSize(std::size_t offset) const;
+  void validate(std::size_t offset, std::size_t size) const;
+  void buildIndex() const;
+  SharedSlice share(Slice slice) const;
+
+  std::shared_ptr<Mapping> _mapping;
+  uint8_t const* _data;
+  std::size_t _size;
+  Validation const _validation;
+  Options const* _options;
+
+  // offsets of all values plus the end of the file, built on first use
+  mutable std::once_flag _indexBuilt;
+  mutable std::vector<std::size_t> _offsets;
+  // values already validated in lazy mode, indexed like _offsets
+  mutable std::unique_ptr<std::atomic<bool>[]> _validated;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackMmapSliceSource = arangodb::velocypack::MmapSliceSource;
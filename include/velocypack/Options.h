@@ -147,6 +147,26 @@ struct Options {
   // write tags to JSON output
   bool debugTags = false;
 
+  // replace String values of Array and Object members that repeat an
+  // earlier String value of the same Array or Object by a compact
+  // reference when building with a Builder (or Parser). attribute names
+  // are never replaced. references are tagged values (see
+  // Slice::stringReferenceTag) that are resolved by Slice accessors,
+  // iterators, Dumper and Validator. as a reference never points out of
+  // its innermost Array or Object, sub-values can be copied with
+  // Builder::add(Slice). references are only written if
+  // resolveStringReferences is set in Options::Defaults
+  bool deduplicateStrings = false;
+
+  // treat values with Slice::stringReferenceTag as references to earlier
+  // String values. Slices do not have options, so only the setting in
+  // Options::Defaults is used, by Slice, iterators, Dumper, Validator and
+  // Builder alike. when not set, such values are plain tagged values
+  bool resolveStringReferences = false;
+
+  // minimum length of String values that are replaced by references
+  ValueLength deduplicateStringsMinLength = 16;
+
   // default options with the above settings
   static Options Defaults;
 };
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// A query that selects values from a VPack value, using a subset of
+// JSONPath:
+//
+//   $                  the value itself. every query starts with it
+//   .name, ['name']    the attribute "name" of an Object
+//   ['a', 'b']         several attributes of an Object, in this order
+//   [1], [0, -1]       Array members by position. negative positions count
+//                      from the end of the Array
+//   [start:end:step]   an Array slice as in Python. all parts are optional,
+//                      and step must be positive
+//   .*, [*]            all Array members or Object attribute values
+//   [?(expression)]    all Array members or Object attribute values that
+//                      satisfy the expression
+//
+// Filter expressions compare a path relative to the current value (@, @.a,
+// @['a'], @[0], ...) with a literal, using ==, !=, <, <=, > or >=. A path
+// without a comparison tests whether the path exists. Comparisons can be
+// combined with && and ||, where && binds more strongly. Literals are
+// numbers, strings in single or double quotes, true, false and null.
+// Numbers are compared by value, strings byte-wise. Ordering comparisons
+// of values of different types are false.
+//
+// A Query is compiled once, and can then be executed against any number of
+// values, also concurrently. Selected values are not decoded: execute()
+// copies their bytes into the result.
+class Query {
+ public:
+  // return false to stop the execution
+  typedef std::function<bool(Slice)> Callback;
+
+  // throws Exception::InvalidQuery for invalid or unsupported expressions
+  explicit Query(std::string_view expression);
+
+  std::string const& expression() const noexcept { return _expression; }
+
+  // calls callback for every selected value, in the order they are selected
+  void forEach(Slice value, Callback const& callback) const;
+
+  // adds an Array with all selected values to the builder
+  void execute(Slice value, Builder& result) const;
+
+  Builder execute(Slice value) const;
+
+  // returns the first selected value, or a None Slice
+  Slice first(Slice value) const;
+
+  enum class StepType : uint8_t { Names, Indexes, Range, Wildcard, Filter };
+
+  enum class Operator : uint8_t {
+    Exists,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+  };
+
+  // an attribute name or an Array position in a filter path
+  struct PathElement {
+    std::string name;
+    int64_t index;
+    bool isIndex;
+  };
+
+  struct Condition {
+    std::vector<PathElement> path;
+    Operator op;
+    Builder literal;
+  };
+
+  // a disjunction of conjunctions
+  typedef std::vector<std::vector<Condition>> Filter;
+
+  struct Step {
+    StepType type;
+    std::vector<std::string> names;
+    std::vector<int64_t> indexes;
+    // for Range
+    int64_t start;
+    int64_t end;
+    int64_t step;
+    bool hasStart;
+    bool hasEnd;
+    // for Filter
+    Filter filter;
+  };
+
+  std::vector<Step> const& steps() const noexcept { return _steps; }
+
+ private:
+  bool run(Slice value, std::size_t step, Callback const& callback) const;
+
+  std::string _expression;
+  std::vector<Step> _steps;
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackQuery = arangodb::velocypack::Query;
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/velocypack-memory.h"
+#include "velocypack/AllocationObserver.h"
+#include "velocypack/Buffer.h"
+#include "velocypack/SharedSlice.h"
+#include "velocypack/Slice.h"
+
+namespace arangodb::velocypack {
+
+// an owning Slice like SharedSlice, but with an intrusive reference count.
+// the reference count and the VPack bytes are stored in a single
+// allocation, and an instance is only two pointers wide.
+// with Atomic = true, instances can be shared between threads. with
+// Atomic = false, the reference count is a plain integer and all copies of
+// an instance must be used by the same thread only.
+// borrow(), get() and at() return Borrowed views that point into the same
+// memory without touching the reference count. a Borrowed view must not
+// outlive the instance it was obtained from; use share() to turn it into
+// an owning instance.
+template <bool Atomic>
+class BasicRefCountedSlice {
+ private:
+  using Counter = std::conditional_t<Atomic, std::atomic<std::size_t>, std::size_t>;
+
+  struct Header {
+    Counter refs;
+  };
+
+  // the VPack bytes start right after the header, aligned like the header
+  static constexpr std::size_t headerSize =
+      (sizeof(Header) + alignof(std::max_align_t) - 1) &
+      ~(alignof(std::max_align_t) - 1);
+
+ public:
+  class Borrowed {
+    friend class BasicRefCountedSlice;
+
+   public:
+    Slice slice() const noexcept { return Slice(_start); }
+
+    Borrowed get(std::string_view attribute) const {
+      return Borrowed(_header, slice().get(attribute).start());
+    }
+
+    Borrowed at(ValueLength index) const {
+      return Borrowed(_header, slice().at(index).start());
+    }
+
+    // returns an owning instance pointing to the same value
+    BasicRefCountedSlice share() const noexcept {
+      acquire(_header);
+      return BasicRefCountedSlice(_header, _start);
+    }
+
+   private:
+    Borrowed(Header* header, uint8_t const* start) noexcept
+        : _header(header), _start(start) {}
+
+    Header* _header;
+    uint8_t const* _start;
+  };
+
+  // points to a (static) None slice
+  BasicRefCountedSlice() noexcept
+      : _header(nullptr), _start(Slice::noneSliceData) {}
+
+  // copies the value into a new allocation
+  explicit BasicRefCountedSlice(Slice slice)
+      : BasicRefCountedSlice(slice.start(), slice.byteSize()) {}
+
+  explicit BasicRefCountedSlice(Buffer<uint8_t> const& buffer)
+      : BasicRefCountedSlice(buffer.data(), buffer.byteSize()) {}
+
+  BasicRefCountedSlice(uint8_t const* data, ValueLength size)
+      : BasicRefCountedSlice() {
+    if (size == 0) {
+      return;
+    }
+    void* p = velocypack_malloc(headerSize + checkOverflow(size));
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::allocated(p, headerSize + checkOverflow(size),
+                                   AllocationCategory::SharedSliceCopy);
+    }
+    _header = new (p) Header{1};
+    uint8_t* bytes = static_cast<uint8_t*>(p) + headerSize;
+    std::memcpy(bytes, data, checkOverflow(size));
+    _start = bytes;
+  }
+
+  BasicRefCountedSlice(BasicRefCountedSlice const& other) noexcept
+      : _header(other._header), _start(other._start) {
+    acquire(_header);
+  }
+
+  BasicRefCountedSlice(BasicRefCountedSlice&& other) noexcept
+      : _header(other._header), _start(other._start) {
+    other._header = nullptr;
+    other._start = Slice::noneSliceData;
+  }
+
+  BasicRefCountedSlice& operator=(BasicRefCountedSlice const& other) noexcept {
+    if (_header != other._header) {
+      acquire(other._header);
+      release(_header);
+      _header = other._header;
+    }
+    _start = other._start;
+    return *this;
+  }
+
+  BasicRefCountedSlice& operator=(BasicRefCountedSlice&& other) noexcept {
+    if (this != &other) {
+      release(_header);
+      _header = other._header;
+      _start = other._start;
+      other._header = nullptr;
+      other._start = Slice::noneSliceData;
+    }
+    return *this;
+  }
+
+  ~BasicRefCountedSlice() { release(_header); }
+
+  Slice slice() const noexcept { return Slice(_start); }
+
+  // non-owning views, which do not touch the reference count
+  Borrowed borrow() const noexcept { return Borrowed(_header, _start); }
+
+  Borrowed get(std::string_view attribute) const {
+    return borrow().get(attribute);
+  }
+
+  Borrowed at(ValueLength index) const { return borrow().at(index); }
+
+  // returns an owning instance sharing the memory, but pointing to the
+  // given sub value
+  BasicRefCountedSlice alias(Slice slice) const noexcept {
+    acquire(_header);
+    return BasicRefCountedSlice(_header, slice.start());
+  }
+
+  // returns a SharedSlice sharing the memory. the SharedSlice holds one
+  // reference, so this is only available for the thread-safe variant
+  SharedSlice sharedSlice() const {
+    static_assert(Atomic, "sharedSlice() requires an atomic reference count");
+    if (_header == nullptr) {
+      return SharedSlice();
+    }
+    Header* header = _header;
+    acquire(header);
+    try {
+      return SharedSlice(std::shared_ptr<uint8_t const>(
+          _start, [header](uint8_t const*) { release(header); }));
+    } catch (...) {
+      release(header);
+      throw;
+    }
+  }
+
+  // number of owning instances sharing the memory, 0 for the None slice
+  std::size_t useCount() const noexcept {
+    if (_header == nullptr) {
+      return 0;
+    }
+    if constexpr (Atomic) {
+      return _header->refs.load(std::memory_order_relaxed);
+    } else {
+      return _header->refs;
+    }
+  }
+
+ private:
+  BasicRefCountedSlice(Header* header, uint8_t const* start) noexcept
+      : _header(header), _start(start) {}
+
+  static void acquire(Header* header) noexcept {
+    if (header != nullptr) {
+      if constexpr (Atomic) {
+        header->refs.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        ++header->refs;
+      }
+    }
+  }
+
+  static void release(Header* header) noexcept {
+    if (header == nullptr) {
+      return;
+    }
+    if constexpr (Atomic) {
+      if (header->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+      }
+    } else {
+      if (--header->refs != 0) {
+        return;
+      }
+    }
+    header->~Header();
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      uint8_t const* bytes = reinterpret_cast<uint8_t const*>(header) + headerSize;
+      AllocationTracing::freed(header,
+                               headerSize + checkOverflow(Slice(bytes).byteSize()));
+    }
+    velocypack_free(header);
+  }
+
+  Header* _header;
+  uint8_t const* _start;
+};
+
+using RefCountedSlice = BasicRefCountedSlice<true>;
+using LocalRefCountedSlice = BasicRefCountedSlice<false>;
+
+}  // namespace arangodb::velocypack
+
+using VPackRefCountedSlice = arangodb::velocypack::RefCountedSlice;
+using VPackLocalRefCountedSlice = arangodb::velocypack::LocalRefCountedSlice;
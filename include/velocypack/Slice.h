@@ -137,6 +137,30 @@ class Slice {
     return isTagged() ? Slice(valueStart()) : *this;
   }
 
+  // tag of references to earlier String values, as written by a Builder
+  // with Options::deduplicateStrings. the tagged value is a UInt with the
+  // distance in bytes from the start of the referenced String to the start
+  // of the reference
+  static constexpr uint64_t stringReferenceTag = 255;
+
+  // check if slice is a reference to an earlier String value. always false
+  // unless Options::Defaults.resolveStringReferences is set
+  bool isStringReference() const noexcept {
+    return VELOCYPACK_UNLIKELY(Options::Defaults.resolveStringReferences) &&
+           head() == 0xee && _start[1] == stringReferenceTag &&
+           _start[2] >= 0x28 && _start[2] <= 0x2f;
+  }
+
+  // returns the String value referenced by a string reference, or the
+  // Slice itself if it is not a string reference. Array and Object
+  // accessors and iterators resolve references automatically
+  Slice resolveStringReference() const noexcept {
+    if (VELOCYPACK_UNLIKELY(isStringReference())) {
+      return Slice(_start - readIntegerNonEmpty<ValueLength>(_start + 3, _start[2] - 0x27));
+    }
+    return *this;
+  }
+
   constexpr uint64_t getFirstTag() const {
     // always need the actual first byte, so use _start directly
     return !isTagged() ? 0 :
@@ -541,13 +565,13 @@ class Slice {
     }
 
     Slice key = getNthKeyUntranslated(index);
-    return Slice(key.start() + key.byteSize());
+    return Slice(key.start() + key.byteSize()).resolveStringReference();
   }
 
   // extract the nth value from an Object
   Slice getNthValue(ValueLength index) const {
     Slice key = getNthKeyUntranslated(index);
-    return Slice(key.start() + key.byteSize());
+    return Slice(key.start() + key.byteSize()).resolveStringReference();
   }
 
   // look for the specified attribute path inside an Object
@@ -602,6 +626,10 @@ class Slice {
   // returns a Slice(ValueType::None) if not found
   Slice get(std::string_view attribute) const;
 
+  // look for the specified attribute inside an Object, without resolving
+  // a string reference (see Options::deduplicateStrings)
+  Slice getUnresolved(std::string_view attribute) const;
+
   [[deprecated]] Slice get(HashedStringRef attribute) const {
     return get(std::string_view(attribute.data(), attribute.size()));
   }
@@ -1226,7 +1254,7 @@ class Slice {
           return readVariableValueLength<false>(start + 1);
         }
 
-        VELOCYPACK_ASSERT(h > 0x01 && h <= 0x0e && h != 0x0a);
+        VELOCYPACK_ASSERT(h > 0x01 && h <= 0x12 && h != 0x0a);
         if (VELOCYPACK_UNLIKELY(h >= sizeof(SliceStaticData::WidthMap) / sizeof(SliceStaticData::WidthMap[0]))) {
           throw Exception(Exception::InternalError, "invalid Array/Object type");
         }
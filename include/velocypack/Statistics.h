@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "velocypack/velocypack-common.h"
+
+// counters for the hot paths of the library. they are only maintained if
+// the library and all code using it are compiled with VELOCYPACK_STATISTICS
+// defined (CMake option -DEnableStatistics=ON). otherwise the macros below
+// expand to nothing, and all counters stay at 0
+#ifdef VELOCYPACK_STATISTICS
+#ifdef VELOCYPACK_NO_THREADLOCALS
+#error "VELOCYPACK_STATISTICS requires thread-local storage"
+#endif
+#define VELOCYPACK_STATISTICS_ADD(counter, value)                     \
+  ::arangodb::velocypack::Statistics::add(                            \
+      ::arangodb::velocypack::Statistics::counter, (value))
+#define VELOCYPACK_STATISTICS_TIMER(counter)                          \
+  ::arangodb::velocypack::Statistics::Timer velocypackStatisticsTimer( \
+      ::arangodb::velocypack::Statistics::counter)
+#else
+#define VELOCYPACK_STATISTICS_ADD(counter, value) \
+  do {                                            \
+  } while (false)
+#define VELOCYPACK_STATISTICS_TIMER(counter) \
+  do {                                       \
+  } while (false)
+#endif
+
+namespace arangodb::velocypack {
+class Builder;
+
+class Statistics {
+ public:
+  enum Counter : std::size_t {
+    ParseCalls = 0,
+    ParsedBytes,
+    ParseNanos,
+    DumpCalls,
+    DumpedBytes,
+    DumpNanos,
+    BufferReallocations,
+    BufferGrowthBytes,
+    IndexSorts,
+    IndexSortsSkipped,
+    IndexSortNanos,
+    LookupsBinary,
+    LookupsLinear,
+    LookupsCompact,
+    ValidatorCalls,
+    ValidatedBytes,
+    NumCounters  // must be last
+  };
+
+  typedef std::array<uint64_t, NumCounters> Values;
+
+  static constexpr bool enabled() noexcept {
+#ifdef VELOCYPACK_STATISTICS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // counters of a single thread. every thread registers its counters on
+  // first use, so that total() can pick them up. when the thread exits,
+  // its counter values are added to the totals of exited threads
+  class ThreadCounters {
+   public:
+    ThreadCounters();
+    ~ThreadCounters();
+    ThreadCounters(ThreadCounters const&) = delete;
+    ThreadCounters& operator=(ThreadCounters const&) = delete;
+
+    // only the owning thread modifies the counters, so there is no need
+    // for an atomic read-modify-write here. the atomics only make reading
+    // the values from other threads well-defined
+    inline void add(Counter counter, uint64_t value) noexcept {
+      auto& slot = _values[counter];
+      slot.store(slot.load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+    }
+
+    Values values() const noexcept;
+    void reset() noexcept;
+
+   private:
+    std::array<std::atomic<uint64_t>, NumCounters> _values;
+  };
+
+  // measures the lifetime of the timer in nanoseconds
+  class Timer {
+   public:
+    explicit Timer(Counter counter) noexcept
+        : _counter(counter), _start(std::chrono::steady_clock::now()) {}
+    ~Timer() {
+      add(_counter, static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - _start)
+                            .count()));
+    }
+    Timer(Timer const&) = delete;
+    Timer& operator=(Timer const&) = delete;
+
+   private:
+    Counter const _counter;
+    std::chrono::steady_clock::time_point const _start;
+  };
+
+  static inline void add(Counter counter, uint64_t value) noexcept {
+    local.add(counter, value);
+  }
+
+  // counter values of the calling thread
+  static Values thread() noexcept { return local.values(); }
+
+  // counter values summed up over all threads, including exited ones
+  static Values total();
+
+  // resets the counters of the calling thread
+  static void reset() noexcept { local.reset(); }
+
+  // name of a counter, as used by toVelocyPack()
+  static char const* name(Counter counter) noexcept;
+
+  // writes the values as an Object with one attribute per counter,
+  // plus the attribute "enabled"
+  static void toVelocyPack(Values const& values, Builder& builder);
+
+ private:
+#ifndef VELOCYPACK_NO_THREADLOCALS
+  static thread_local ThreadCounters local;
+#else
+  // never modified, as statistics cannot be turned on without thread-locals
+  static ThreadCounters local;
+#endif
+};
+
+}  // namespace arangodb::velocypack
+
+using VPackStatistics = arangodb::velocypack::Statistics;
@@ -0,0 +1,807 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+#include "velocypack/Value.h"
+
+// Describes the members of a plain struct so that it can be converted from
+// and to a VelocyPack Object with serializeStruct() and deserializeStruct().
+// Must be used in the namespace of the struct, and the listed members must
+// be accessible from there:
+//
+//   namespace app {
+//   struct Point { int x; int y; std::optional<std::string> label; };
+//   VPACK_STRUCT(Point, x, y, label)
+//   }
+//
+// At most 32 members can be listed. The members themselves may be of any type
+// supported by StructFieldTraits, including other VPACK_STRUCT types.
+#define VPACK_STRUCT(Type, ...)                                              \
+  [[maybe_unused]] inline constexpr auto velocypackStructFields(            \
+      Type const*) {                                                         \
+    return std::make_tuple(                                                  \
+        VPACK_STRUCT_FOR_EACH_(VPACK_STRUCT_FIELD_, Type, __VA_ARGS__));     \
+  }
+
+#define VPACK_STRUCT_FIELD_(Type, member) \
+  ::arangodb::velocypack::StructField<Type, decltype(Type::member)> { #member, &Type::member }
+
+#define VPACK_STRUCT_NARGS_(...) \
+  VPACK_STRUCT_NARGS_IMPL_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define VPACK_STRUCT_NARGS_IMPL_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define VPACK_STRUCT_CONCAT_(a, b) VPACK_STRUCT_CONCAT_IMPL_(a, b)
+#define VPACK_STRUCT_CONCAT_IMPL_(a, b) a##b
+#define VPACK_STRUCT_FOR_EACH_(m, t, ...)                         \
+  VPACK_STRUCT_CONCAT_(VPACK_STRUCT_FE_, VPACK_STRUCT_NARGS_(__VA_ARGS__)) \
+  (m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_1(m, t, x) m(t, x)
+#define VPACK_STRUCT_FE_2(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_1(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_3(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_2(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_4(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_3(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_5(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_4(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_6(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_5(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_7(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_6(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_8(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_7(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_9(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_8(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_10(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_9(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_11(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_10(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_12(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_11(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_13(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_12(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_14(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_13(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_15(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_14(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_16(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_15(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_17(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_16(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_18(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_17(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_19(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_18(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_20(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_19(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_21(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_20(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_22(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_21(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_23(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_22(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_24(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_23(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_25(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_24(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_26(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_25(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_27(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_26(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_28(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_27(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_29(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_28(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_30(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_29(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_31(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_30(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_FE_32(m, t, x, ...) m(t, x), VPACK_STRUCT_FE_31(m, t, __VA_ARGS__)
+
+// Defines a class View that reads the members of a VPACK_STRUCT type
+// directly from an Object, without copying them. View has an accessor for
+// each listed member, see StructView for the returned types:
+//
+//   VPACK_STRUCT_VIEW(PointView, Point, x, label)
+//
+//   PointView view(slice);
+//   int x = view.x();
+//   std::optional<std::string_view> label = view.label();
+#define VPACK_STRUCT_VIEW(View, Type, ...)                                   \
+  class View : public ::arangodb::velocypack::StructView<Type> {            \
+   public:                                                                   \
+    using ::arangodb::velocypack::StructView<Type>::StructView;             \
+    VPACK_STRUCT_APPLY_(VPACK_STRUCT_VIEW_ACCESSOR_, Type, __VA_ARGS__)      \
+  };                                                                         \
+  View velocypackStructView(Type const*);
+
+#define VPACK_STRUCT_VIEW_ACCESSOR_(Type, member)                 \
+  auto member() const {                                           \
+    return this->template get<                                    \
+        ::arangodb::velocypack::StructInfo<Type>::find(#member)>(); \
+  }
+
+#define VPACK_STRUCT_APPLY_(m, t, ...)                             \
+  VPACK_STRUCT_CONCAT_(VPACK_STRUCT_AP_, VPACK_STRUCT_NARGS_(__VA_ARGS__)) \
+  (m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_1(m, t, x) m(t, x)
+#define VPACK_STRUCT_AP_2(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_1(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_3(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_2(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_4(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_3(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_5(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_4(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_6(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_5(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_7(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_6(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_8(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_7(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_9(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_8(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_10(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_9(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_11(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_10(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_12(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_11(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_13(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_12(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_14(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_13(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_15(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_14(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_16(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_15(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_17(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_16(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_18(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_17(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_19(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_18(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_20(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_19(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_21(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_20(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_22(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_21(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_23(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_22(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_24(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_23(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_25(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_24(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_26(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_25(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_27(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_26(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_28(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_27(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_29(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_28(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_30(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_29(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_31(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_30(m, t, __VA_ARGS__)
+#define VPACK_STRUCT_AP_32(m, t, x, ...) m(t, x) VPACK_STRUCT_AP_31(m, t, __VA_ARGS__)
+
+namespace arangodb::velocypack {
+
+// a single member of a VPACK_STRUCT type
+template <typename S, typename M>
+struct StructField {
+  using Member = M;
+
+  std::string_view name;
+  M S::*member;
+};
+
+// whether a VPACK_STRUCT description is available for T
+template <typename T, typename = void>
+struct IsVPackStruct : std::false_type {};
+
+template <typename T>
+struct IsVPackStruct<T, std::void_t<decltype(velocypackStructFields(
+                            static_cast<T const*>(nullptr)))>>
+    : std::true_type {};
+
+namespace detail {
+
+template <std::size_t N>
+constexpr std::array<std::size_t, N> sortedStructOrder(
+    std::array<std::string_view, N> const& names) {
+  // insertion sort. string_view compares like the Object index does
+  std::array<std::size_t, N> result{};
+  for (std::size_t i = 0; i < N; ++i) {
+    std::size_t j = i;
+    while (j > 0 && names[i] < names[result[j - 1]]) {
+      result[j] = result[j - 1];
+      --j;
+    }
+    result[j] = i;
+  }
+  return result;
+}
+
+template <std::size_t N>
+constexpr bool hasUniqueStructNames(
+    std::array<std::string_view, N> const& names,
+    std::array<std::size_t, N> const& order) {
+  for (std::size_t i = 1; i < N; ++i) {
+    if (names[order[i - 1]] == names[order[i]]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr std::size_t structKeyLength(std::string_view name) {
+  return (name.size() <= 126 ? 1 : 9) + name.size();
+}
+
+template <std::size_t N>
+constexpr std::size_t structKeysLength(
+    std::array<std::string_view, N> const& names) {
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    length += structKeyLength(names[i]);
+  }
+  return length;
+}
+
+template <std::size_t N>
+constexpr std::array<std::size_t, N> structKeyOffsets(
+    std::array<std::string_view, N> const& names) {
+  std::array<std::size_t, N> result{};
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    result[i] = offset;
+    offset += structKeyLength(names[i]);
+  }
+  return result;
+}
+
+// encodes all names as VPack Strings, one after the other
+template <std::size_t L, std::size_t N>
+constexpr std::array<uint8_t, L> encodeStructKeys(
+    std::array<std::string_view, N> const& names) {
+  std::array<uint8_t, L> result{};
+  std::size_t p = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    std::string_view name = names[i];
+    if (name.size() <= 126) {
+      result[p++] = static_cast<uint8_t>(0x40 + name.size());
+    } else {
+      result[p++] = 0xbf;
+      uint64_t v = name.size();
+      for (std::size_t j = 0; j < 8; ++j) {
+        result[p++] = static_cast<uint8_t>(v & 0xff);
+        v >>= 8;
+      }
+    }
+    for (char c : name) {
+      result[p++] = static_cast<uint8_t>(c);
+    }
+  }
+  return result;
+}
+
+template <typename Fields, std::size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)> structNames(
+    Fields const& fields, std::index_sequence<I...>) {
+  return {{std::get<I>(fields).name...}};
+}
+
+}  // namespace detail
+
+// compile-time information about a VPACK_STRUCT type: its members, the order
+// in which they are written (sorted by name, like an Object index is), and
+// the already encoded attribute names
+template <typename T>
+struct StructInfo {
+  static_assert(IsVPackStruct<T>::value, "type is not described by VPACK_STRUCT");
+
+  static constexpr auto fields =
+      velocypackStructFields(static_cast<T const*>(nullptr));
+  static constexpr std::size_t size =
+      std::tuple_size_v<std::remove_const_t<decltype(fields)>>;
+
+  // member names, in declaration order
+  static constexpr std::array<std::string_view, size> names =
+      detail::structNames(fields, std::make_index_sequence<size>());
+  // member indexes, sorted by member name
+  static constexpr std::array<std::size_t, size> order =
+      detail::sortedStructOrder(names);
+  // VPack-encoded member names, in declaration order
+  static constexpr auto keys =
+      detail::encodeStructKeys<detail::structKeysLength(names) + 1>(names);
+  static constexpr std::array<std::size_t, size> keyOffsets =
+      detail::structKeyOffsets(names);
+
+  static_assert(detail::hasUniqueStructNames(names, order),
+                "VPACK_STRUCT members must be unique");
+
+  // returns the index of the member with the given name, or size if there
+  // is no such member
+  static constexpr std::size_t find(std::string_view name) noexcept {
+    std::size_t lo = 0;
+    std::size_t hi = size;
+    while (lo < hi) {
+      std::size_t mid = lo + (hi - lo) / 2;
+      std::string_view candidate = names[order[mid]];
+      if (candidate < name) {
+        lo = mid + 1;
+      } else if (name < candidate) {
+        hi = mid;
+      } else {
+        return order[mid];
+      }
+    }
+    return size;
+  }
+};
+
+// conversion of a single member value from and to VPack. can be specialized
+// for further types
+template <typename T, typename = void>
+struct StructFieldTraits;
+
+template <typename T>
+void serializeStruct(Builder& b, T const& value);
+
+template <typename T>
+void deserializeStruct(Slice slice, T& value);
+
+template <>
+struct StructFieldTraits<bool> {
+  static void write(Builder& b, bool value) { b.add(Value(value)); }
+  static void read(Slice slice, bool& value) { value = slice.getBool(); }
+};
+
+template <typename T>
+struct StructFieldTraits<
+    T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+  static void write(Builder& b, T value) {
+    if constexpr (std::is_signed_v<T>) {
+      b.add(Value(static_cast<int64_t>(value)));
+    } else {
+      b.add(Value(static_cast<uint64_t>(value)));
+    }
+  }
+  static void read(Slice slice, T& value) { value = slice.getNumber<T>(); }
+};
+
+template <typename T>
+struct StructFieldTraits<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  static void write(Builder& b, T value) {
+    b.add(Value(static_cast<double>(value)));
+  }
+  static void read(Slice slice, T& value) { value = slice.getNumber<T>(); }
+};
+
+template <>
+struct StructFieldTraits<std::string> {
+  static void write(Builder& b, std::string const& value) {
+    b.add(Value(value));
+  }
+  static void read(Slice slice, std::string& value) {
+    std::string_view sv = slice.stringView();
+    value.assign(sv.data(), sv.size());
+  }
+};
+
+template <typename T, typename A>
+struct StructFieldTraits<std::vector<T, A>> {
+  static void write(Builder& b, std::vector<T, A> const& value) {
+    if constexpr ((std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) ||
+                  std::is_same_v<T, std::string>) {
+      b.addArray(value);
+    } else {
+      b.openArray();
+      for (auto const& it : value) {
+        StructFieldTraits<T>::write(b, it);
+      }
+      b.close();
+    }
+  }
+  static void read(Slice slice, std::vector<T, A>& value) {
+    ArrayIterator it(slice);
+    value.clear();
+    value.reserve(checkOverflow(it.size()));
+    while (it.valid()) {
+      StructFieldTraits<T>::read(it.value(), value.emplace_back());
+      it.next();
+    }
+  }
+};
+
+// an empty optional is written as null. null or a missing attribute are
+// read as an empty optional
+template <typename T>
+struct StructFieldTraits<std::optional<T>> {
+  static void write(Builder& b, std::optional<T> const& value) {
+    if (value.has_value()) {
+      StructFieldTraits<T>::write(b, *value);
+    } else {
+      b.add(Value(ValueType::Null));
+    }
+  }
+  static void read(Slice slice, std::optional<T>& value) {
+    if (slice.isNull()) {
+      value.reset();
+    } else {
+      StructFieldTraits<T>::read(slice, value.emplace());
+    }
+  }
+};
+
+// maps with string keys are written as Objects
+template <typename M>
+struct StructFieldMapTraits {
+  static void write(Builder& b, M const& value) {
+    b.openObject();
+    for (auto const& [k, v] : value) {
+      b.add(ValuePair(k.data(), k.size(), ValueType::String));
+      StructFieldTraits<typename M::mapped_type>::write(b, v);
+    }
+    b.close();
+  }
+  static void read(Slice slice, M& value) {
+    ObjectIterator it(slice, true);
+    value.clear();
+    while (it.valid()) {
+      StructFieldTraits<typename M::mapped_type>::read(
+          it.value(), value[it.key(true).copyString()]);
+      it.next();
+    }
+  }
+};
+
+template <typename V, typename C, typename A>
+struct StructFieldTraits<std::map<std::string, V, C, A>>
+    : StructFieldMapTraits<std::map<std::string, V, C, A>> {};
+
+template <typename V, typename H, typename E, typename A>
+struct StructFieldTraits<std::unordered_map<std::string, V, H, E, A>>
+    : StructFieldMapTraits<std::unordered_map<std::string, V, H, E, A>> {};
+
+template <typename T>
+struct StructFieldTraits<T, std::enable_if_t<IsVPackStruct<T>::value>> {
+  static void write(Builder& b, T const& value) { serializeStruct(b, value); }
+  static void read(Slice slice, T& value) { deserializeStruct(slice, value); }
+};
+
+namespace detail {
+
+template <typename T, std::size_t I>
+void writeStructField(Builder& b, T const& value) {
+  using Info = StructInfo<T>;
+  auto const& field = std::get<I>(Info::fields);
+  using Member = typename std::remove_reference_t<decltype(field)>::Member;
+
+  b.add(Slice(Info::keys.data() + Info::keyOffsets[I]));
+  StructFieldTraits<Member>::write(b, value.*(field.member));
+}
+
+template <typename T, std::size_t... I>
+void writeStructFields(Builder& b, T const& value, std::index_sequence<I...>) {
+  (writeStructField<T, StructInfo<T>::order[I]>(b, value), ...);
+}
+
+template <typename T, std::size_t I>
+bool readStructField(std::size_t index, Slice slice, T& value) {
+  if (index != I) {
+    return false;
+  }
+  auto const& field = std::get<I>(StructInfo<T>::fields);
+  using Member = typename std::remove_reference_t<decltype(field)>::Member;
+  StructFieldTraits<Member>::read(slice, value.*(field.member));
+  return true;
+}
+
+template <typename T, std::size_t... I>
+void readStructField(std::size_t index, Slice slice, T& value,
+                     std::index_sequence<I...>) {
+  (readStructField<T, I>(index, slice, value) || ...);
+}
+
+}  // namespace detail
+
+// writes value as an Object. the attributes are written in sorted order, so
+// that close() does not need to sort the index table. attribute names are
+// not translated by Options::attributeTranslator
+template <typename T>
+void serializeStruct(Builder& b, T const& value) {
+  b.openObject();
+  detail::writeStructFields(b, value,
+                            std::make_index_sequence<StructInfo<T>::size>());
+  b.close();
+}
+
+// reads the members of value from an Object, in a single pass over the
+// Object. attributes without a matching member are ignored, and members
+// without a matching attribute keep their current values
+template <typename T>
+void deserializeStruct(Slice slice, T& value) {
+  if (!slice.isObject()) {
+    throw Exception(Exception::InvalidValueType, "Expecting Object");
+  }
+  ObjectIterator it(slice, true);
+  while (it.valid()) {
+    std::size_t index = StructInfo<T>::find(it.key(true).stringView());
+    if (index != StructInfo<T>::size) {
+      detail::readStructField(index, it.value(), value,
+                              std::make_index_sequence<StructInfo<T>::size>());
+    }
+    it.next();
+  }
+}
+
+template <typename T>
+T deserializeStruct(Slice slice) {
+  T value{};
+  deserializeStruct(slice, value);
+  return value;
+}
+
+template <typename T>
+class StructView;
+
+// the view type used for members of VPACK_STRUCT type T: the class defined
+// by VPACK_STRUCT_VIEW if there is one, StructView<T> otherwise
+template <typename T, typename = void>
+struct StructViewType {
+  using type = StructView<T>;
+};
+
+template <typename T>
+struct StructViewType<T, std::void_t<decltype(velocypackStructView(
+                             static_cast<T const*>(nullptr)))>> {
+  using type =
+      decltype(velocypackStructView(static_cast<T const*>(nullptr)));
+};
+
+// how a member of type T is presented by a StructView. read() returns the
+// view of a present attribute, missing() the view of an absent one.
+// scalars are returned by value
+template <typename T, typename = void>
+struct StructViewTraits {
+  using type = T;
+  static type read(Slice slice) {
+    T value{};
+    StructFieldTraits<T>::read(slice, value);
+    return value;
+  }
+  static type missing(T const& defaultValue) { return defaultValue; }
+};
+
+template <>
+struct StructViewTraits<std::string> {
+  using type = std::string_view;
+  static type read(Slice slice) { return slice.stringView(); }
+  static type missing(std::string const& defaultValue) {
+    return defaultValue;
+  }
+};
+
+// a typed range over the members of an Array
+template <typename T>
+class StructArrayView {
+ public:
+  using value_type = typename StructViewTraits<T>::type;
+
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename StructViewTraits<T>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    explicit iterator(ArrayIterator it) noexcept : _it(it) {}
+
+    value_type operator*() const {
+      return StructViewTraits<T>::read(_it.value());
+    }
+    iterator& operator++() {
+      _it.next();
+      return *this;
+    }
+    bool operator==(iterator const& other) const noexcept {
+      return _it == other._it;
+    }
+    bool operator!=(iterator const& other) const noexcept {
+      return _it != other._it;
+    }
+
+   private:
+    ArrayIterator _it;
+  };
+
+  explicit StructArrayView(Slice slice) : _slice(slice) {
+    if (!slice.isArray()) {
+      throw Exception(Exception::InvalidValueType, "Expecting Array");
+    }
+  }
+
+  Slice slice() const noexcept { return _slice; }
+  ValueLength size() const { return _slice.length(); }
+  bool empty() const { return _slice.isEmptyArray(); }
+
+  value_type operator[](ValueLength index) const {
+    return StructViewTraits<T>::read(_slice.at(index));
+  }
+
+  iterator begin() const { return iterator(ArrayIterator(_slice)); }
+  iterator end() const { return iterator(ArrayIterator(_slice).end()); }
+
+ private:
+  Slice _slice;
+};
+
+// a typed view of an Object that represents a map with string keys
+template <typename T>
+class StructMapView {
+ public:
+  using mapped_type = typename StructViewTraits<T>::type;
+  using value_type = std::pair<std::string_view, mapped_type>;
+
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::string_view, mapped_type>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    explicit iterator(ObjectIterator it) noexcept : _it(it) {}
+
+    value_type operator*() const {
+      return value_type(_it.key(true).stringView(),
+                        StructViewTraits<T>::read(_it.value()));
+    }
+    iterator& operator++() {
+      _it.next();
+      return *this;
+    }
+    bool operator==(iterator const& other) const noexcept {
+      return _it == other._it;
+    }
+    bool operator!=(iterator const& other) const noexcept {
+      return _it != other._it;
+    }
+
+   private:
+    ObjectIterator _it;
+  };
+
+  explicit StructMapView(Slice slice) : _slice(slice) {
+    if (!slice.isObject()) {
+      throw Exception(Exception::InvalidValueType, "Expecting Object");
+    }
+  }
+
+  Slice slice() const noexcept { return _slice; }
+  ValueLength size() const { return _slice.length(); }
+  bool empty() const { return _slice.isEmptyObject(); }
+
+  std::optional<mapped_type> get(std::string_view key) const {
+    Slice value = _slice.get(key);
+    if (value.isNone()) {
+      return std::nullopt;
+    }
+    return StructViewTraits<T>::read(value);
+  }
+
+  iterator begin() const { return iterator(ObjectIterator(_slice, true)); }
+  iterator end() const { return iterator(ObjectIterator(_slice, true).end()); }
+
+ private:
+  Slice _slice;
+};
+
+template <typename T, typename A>
+struct StructViewTraits<std::vector<T, A>> {
+  using type = StructArrayView<T>;
+  static type read(Slice slice) { return type(slice); }
+  static type missing(std::vector<T, A> const&) {
+    return type(Slice::emptyArraySlice());
+  }
+};
+
+template <typename T>
+struct StructViewTraits<std::optional<T>> {
+  using type = std::optional<typename StructViewTraits<T>::type>;
+  static type read(Slice slice) {
+    if (slice.isNull()) {
+      return std::nullopt;
+    }
+    return StructViewTraits<T>::read(slice);
+  }
+  static type missing(std::optional<T> const&) { return std::nullopt; }
+};
+
+template <typename M>
+struct StructViewMapTraits {
+  using type = StructMapView<typename M::mapped_type>;
+  static type read(Slice slice) { return type(slice); }
+  static type missing(M const&) { return type(Slice::emptyObjectSlice()); }
+};
+
+template <typename V, typename C, typename A>
+struct StructViewTraits<std::map<std::string, V, C, A>>
+    : StructViewMapTraits<std::map<std::string, V, C, A>> {};
+
+template <typename V, typename H, typename E, typename A>
+struct StructViewTraits<std::unordered_map<std::string, V, H, E, A>>
+    : StructViewMapTraits<std::unordered_map<std::string, V, H, E, A>> {};
+
+template <typename T>
+struct StructViewTraits<T, std::enable_if_t<IsVPackStruct<T>::value>> {
+  using type = typename StructViewType<T>::type;
+  static type read(Slice slice) { return type(slice); }
+  static type missing(T const&) { return type(Slice::emptyObjectSlice()); }
+};
+
+// read-only access to the members of a VPACK_STRUCT type, directly from an
+// Object and without copying anything. the positions of all members are
+// looked up once on construction, so every later access is O(1). the view
+// refers to the memory of the Object, which must stay valid while the view
+// is in use.
+//
+// get<I>() returns the I-th member as given to VPACK_STRUCT:
+// - strings as std::string_view
+// - vectors as StructArrayView and string-keyed maps as StructMapView
+// - other VPACK_STRUCT types as their views
+// - optionals as optionals of the above
+// - all other types by value, converted like deserializeStruct() does
+// if the attribute is missing, the member's value in a default-constructed
+// T is returned for scalars and strings, and empty views otherwise.
+// conversion errors throw when a member is accessed
+template <typename T>
+class StructView {
+ public:
+  using Info = StructInfo<T>;
+
+  explicit StructView(Slice slice) : _slice(slice), _members{} {
+    if (!slice.isObject()) {
+      throw Exception(Exception::InvalidValueType, "Expecting Object");
+    }
+    ObjectIterator it(slice, true);
+    while (it.valid()) {
+      std::size_t index = Info::find(it.key(true).stringView());
+      if (index != Info::size) {
+        _members[index] = it.value().start();
+      }
+      it.next();
+    }
+  }
+
+  Slice slice() const noexcept { return _slice; }
+
+  // whether the Object has an attribute for the I-th member
+  template <std::size_t I>
+  bool has() const noexcept {
+    static_assert(I < Info::size, "invalid member index");
+    return _members[I] != nullptr;
+  }
+
+  // the raw value of the I-th member, or a None slice if it is missing
+  template <std::size_t I>
+  Slice member() const noexcept {
+    static_assert(I < Info::size, "invalid member index");
+    return _members[I] != nullptr ? Slice(_members[I]) : Slice();
+  }
+
+  template <std::size_t I>
+  auto get() const {
+    static_assert(I < Info::size, "invalid member index");
+    auto const& field = std::get<I>(Info::fields);
+    using Member = typename std::remove_reference_t<decltype(field)>::Member;
+
+    if (_members[I] == nullptr) {
+      return StructViewTraits<Member>::missing(defaults().*(field.member));
+    }
+    return StructViewTraits<Member>::read(Slice(_members[I]));
+  }
+
+  // copies all members into a T
+  T toStruct() const { return deserializeStruct<T>(_slice); }
+
+ private:
+  static T const& defaults() {
+    static T const value{};
+    return value;
+  }
+
+  Slice _slice;
+  std::array<uint8_t const*, Info::size> _members;
+};
+
+}  // namespace arangodb::velocypack
+
+template<typename T> using VPackStructInfo = arangodb::velocypack::StructInfo<T>;
+template<typename T> using VPackStructFieldTraits = arangodb::velocypack::StructFieldTraits<T>;
+template<typename T> using VPackStructView = arangodb::velocypack::StructView<T>;
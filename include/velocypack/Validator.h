@@ -49,6 +49,7 @@ class Validator {
   bool validate(uint8_t const* ptr, std::size_t length, bool isSubPart = false);
 
  private:
+  void validateStringReference(uint8_t const* ptr, std::size_t length);
   void validateArray(uint8_t const* ptr, std::size_t length);
   void validateCompactArray(uint8_t const* ptr, std::size_t length);
   void validateUnindexedArray(uint8_t const* ptr, std::size_t length);
@@ -65,6 +66,8 @@ class Validator {
 
  private:
   int _level;
+  // start of the innermost compound value that is validated
+  uint8_t const* _start;
 };
 
 }  // namespace arangodb::velocypack
@@ -37,6 +37,13 @@
 #define VELOCYPACK_UNLIKELY(v) v
 #endif
 
+// hint that the memory at the given address will be read soon
+#if defined(__GNUC__) || defined(__GNUG__)
+#define VELOCYPACK_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define VELOCYPACK_PREFETCH(addr) ((void)(addr))
+#endif
+
 // debug mode
 #ifndef NDEBUG
 #ifndef VELOCYPACK_DEBUG
@@ -25,22 +25,34 @@
 #pragma once
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
+#include "velocypack/AllocationRecorder.h"
+#include "velocypack/AttributeDictionary.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
 #include "velocypack/Compare.h"
+#include "velocypack/Compression.h"
+#include "velocypack/Container.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
+#include "velocypack/ExternalSorter.h"
+#include "velocypack/FixedBuilder.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/MmapSliceSource.h"
 #include "velocypack/Options.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Query.h"
+#include "velocypack/RefCountedSlice.h"
 #include "velocypack/Serializable.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/StringRef.h"
+#include "velocypack/Struct.h"
 #include "velocypack/Utf8Helper.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Value.h"
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+#
+# Compares two result files written by "bench-micro --json FILE" and reports
+# benchmarks that got slower (or faster) by more than a threshold.
+#
+# Usage:
+#   scripts/bench-compare.py BASELINE.json CURRENT.json [--threshold PERCENT]
+#                            [--filter TEXT]
+#
+# The exit code is 1 if at least one benchmark regressed by more than the
+# threshold (default: 10 percent), and 0 otherwise. Benchmarks present in
+# only one of the files are listed but do not count as regressions.
+#
+
+import argparse
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    return {b["name"]: b for b in data["benchmarks"]}, data.get("context", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two bench-micro JSON result files")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: 10)")
+    parser.add_argument("--filter", default="",
+                        help="only compare benchmarks whose name contains this")
+    args = parser.parse_args()
+
+    baseline, baselineContext = load(args.baseline)
+    current, currentContext = load(args.current)
+
+    for key in ("library_version", "compiler", "debug"):
+        if baselineContext.get(key) != currentContext.get(key):
+            print("note: %s differs: %s vs. %s" %
+                  (key, baselineContext.get(key), currentContext.get(key)))
+
+    regressions = []
+    improvements = []
+    print("%-36s %14s %14s %9s" % ("benchmark", "baseline ns", "current ns", "change"))
+    for name in sorted(set(baseline) | set(current)):
+        if args.filter not in name:
+            continue
+        if name not in baseline or name not in current:
+            print("%-36s %s" % (name, "only in current" if name in current
+                                else "only in baseline"))
+            continue
+        old = baseline[name]["ns_per_op"]
+        new = current[name]["ns_per_op"]
+        change = (new - old) * 100.0 / old if old > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            marker = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            marker = "  improvement"
+            improvements.append(name)
+        print("%-36s %14.1f %14.1f %+8.1f%%%s" % (name, old, new, change, marker))
+
+    print("")
+    print("%d regression(s), %d improvement(s) beyond %.1f%%" %
+          (len(regressions), len(improvements), args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
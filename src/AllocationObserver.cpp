@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// counts all allocations while an observer is installed, for sampling
+std::atomic<uint64_t> allocationCounter{0};
+
+#ifndef VELOCYPACK_NO_THREADLOCALS
+// category that Buffer allocations of this thread are attributed to
+thread_local AllocationCategory bufferCategory = AllocationCategory::Buffer;
+#endif
+
+}  // namespace
+
+char const* arangodb::velocypack::allocationCategoryName(
+    AllocationCategory category) noexcept {
+  switch (category) {
+    case AllocationCategory::Buffer:
+      return "buffer";
+    case AllocationCategory::SharedSliceCopy:
+      return "sharedSliceCopy";
+    case AllocationCategory::BuilderIndex:
+      return "builderIndex";
+    case AllocationCategory::Parser:
+      return "parser";
+    case AllocationCategory::NumCategories:
+      break;
+  }
+  return "unknown";
+}
+
+void AllocationTracing::install(AllocationObserver* observer,
+                                uint32_t sampleInterval) noexcept {
+  _sampleInterval.store(sampleInterval == 0 ? 1 : sampleInterval,
+                        std::memory_order_relaxed);
+  ::allocationCounter.store(0, std::memory_order_relaxed);
+  _observer.store(observer, std::memory_order_release);
+}
+
+void AllocationTracing::allocated(void* ptr, std::size_t size,
+                                  AllocationCategory category) noexcept {
+  AllocationObserver* o = observer();
+  if (o == nullptr) {
+    return;
+  }
+  uint32_t const interval = _sampleInterval.load(std::memory_order_relaxed);
+  if (interval > 1 &&
+      ::allocationCounter.fetch_add(1, std::memory_order_relaxed) % interval != 0) {
+    return;
+  }
+#ifndef VELOCYPACK_NO_THREADLOCALS
+  if (category == AllocationCategory::Buffer) {
+    category = ::bufferCategory;
+  }
+#endif
+  o->allocated(ptr, size, category);
+}
+
+void AllocationTracing::reallocated(void const* oldPtr, void const* newPtr,
+                                    std::size_t size, std::size_t used) noexcept {
+  AllocationObserver* o = observer();
+  if (o != nullptr) {
+    o->reallocated(oldPtr, newPtr, size, used);
+  }
+}
+
+void AllocationTracing::freed(void const* ptr, std::size_t used) noexcept {
+  AllocationObserver* o = observer();
+  if (o != nullptr) {
+    o->freed(ptr, used);
+  }
+}
+
+AllocationTracing::Scope::Scope(AllocationCategory category) noexcept
+    : _previous(AllocationCategory::Buffer), _active(false) {
+#ifndef VELOCYPACK_NO_THREADLOCALS
+  if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+    _previous = ::bufferCategory;
+    _active = true;
+    ::bufferCategory = category;
+  }
+#else
+  (void)category;
+#endif
+}
+
+AllocationTracing::Scope::~Scope() {
+#ifndef VELOCYPACK_NO_THREADLOCALS
+  if (_active) {
+    ::bufferCategory = _previous;
+  }
+#endif
+}
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationRecorder.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+std::size_t histogramBucket(uint64_t value) noexcept {
+  std::size_t bucket = 0;
+  while (value > 0 && bucket < AllocationRecorder::histogramBuckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void addHistogram(Builder& builder, char const* name,
+                  std::array<uint64_t, AllocationRecorder::histogramBuckets> const& values) {
+  // only write buckets up to the last non-empty one
+  std::size_t n = values.size();
+  while (n > 0 && values[n - 1] == 0) {
+    --n;
+  }
+  builder.add(name, Value(ValueType::Array));
+  for (std::size_t i = 0; i < n; ++i) {
+    builder.add(Value(values[i]));
+  }
+  builder.close();
+}
+
+}  // namespace
+
+void AllocationRecorder::allocated(void const* ptr, std::size_t size,
+                                   AllocationCategory category) noexcept {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(_mutex);
+  try {
+    _blocks[ptr] = Block{size, category, now};
+  } catch (...) {
+    // cannot keep track of the block, so ignore it
+    return;
+  }
+  CategoryStatistics& s = _statistics[static_cast<std::size_t>(category)];
+  ++s.allocations;
+  ++s.liveBlocks;
+  s.liveBytes += size;
+  s.peakLiveBytes = std::max(s.peakLiveBytes, s.liveBytes);
+}
+
+void AllocationRecorder::reallocated(void const* oldPtr, void const* newPtr,
+                                     std::size_t size, std::size_t /*used*/) noexcept {
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto it = _blocks.find(oldPtr);
+  if (it == _blocks.end()) {
+    // not sampled
+    return;
+  }
+  Block block = it->second;
+  CategoryStatistics& s = _statistics[static_cast<std::size_t>(block.category)];
+  ++s.reallocations;
+  s.liveBytes = s.liveBytes - block.size + size;
+  s.peakLiveBytes = std::max(s.peakLiveBytes, s.liveBytes);
+  block.size = size;
+  if (oldPtr == newPtr) {
+    it->second = block;
+    return;
+  }
+  _blocks.erase(it);
+  try {
+    _blocks.emplace(newPtr, block);
+  } catch (...) {
+    // cannot keep track of the block anymore
+    --s.liveBlocks;
+    s.liveBytes -= size;
+  }
+}
+
+void AllocationRecorder::freed(void const* ptr, std::size_t used) noexcept {
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(_mutex);
+  auto it = _blocks.find(ptr);
+  if (it == _blocks.end()) {
+    // not sampled
+    return;
+  }
+  Block const block = it->second;
+  _blocks.erase(it);
+
+  uint64_t const lifetime = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - block.allocated)
+          .count());
+
+  CategoryStatistics& s = _statistics[static_cast<std::size_t>(block.category)];
+  ++s.frees;
+  --s.liveBlocks;
+  s.liveBytes -= block.size;
+  s.freedCapacity += block.size;
+  s.freedUsed += std::min<uint64_t>(used, block.size);
+  s.totalLifetimeNanos += lifetime;
+  s.maxLifetimeNanos = std::max(s.maxLifetimeNanos, lifetime);
+  ++s.sizes[::histogramBucket(block.size)];
+  ++s.lifetimes[::histogramBucket(lifetime / 1000)];
+}
+
+AllocationRecorder::Statistics AllocationRecorder::statistics() const {
+  std::lock_guard<std::mutex> guard(_mutex);
+  return _statistics;
+}
+
+void AllocationRecorder::reset() {
+  std::lock_guard<std::mutex> guard(_mutex);
+  _blocks.clear();
+  _statistics = Statistics();
+}
+
+void AllocationRecorder::toVelocyPack(Builder& builder,
+                                      uint32_t sampleInterval) const {
+  Statistics const statistics = this->statistics();
+
+  builder.openObject();
+  builder.add("sampleInterval", Value(sampleInterval));
+  for (std::size_t i = 0; i < statistics.size(); ++i) {
+    CategoryStatistics const& s = statistics[i];
+    builder.add(allocationCategoryName(static_cast<AllocationCategory>(i)),
+                Value(ValueType::Object));
+    builder.add("allocations", Value(s.allocations));
+    builder.add("reallocations", Value(s.reallocations));
+    builder.add("frees", Value(s.frees));
+    builder.add("liveBlocks", Value(s.liveBlocks));
+    builder.add("liveBytes", Value(s.liveBytes));
+    builder.add("peakLiveBytes", Value(s.peakLiveBytes));
+    builder.add("freedCapacity", Value(s.freedCapacity));
+    builder.add("freedUsed", Value(s.freedUsed));
+    builder.add("totalLifetimeNanos", Value(s.totalLifetimeNanos));
+    builder.add("maxLifetimeNanos", Value(s.maxLifetimeNanos));
+    ::addHistogram(builder, "sizes", s.sizes);
+    ::addHistogram(builder, "lifetimes", s.lifetimes);
+    builder.close();
+  }
+  builder.close();
+}
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/AttributeDictionary.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Slice.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+AttributeDictionary::AttributeDictionary() : _current(nullptr) {
+  auto initial = std::make_unique<Version>();
+  initial->number = 0;
+  initial->previous = nullptr;
+  initial->added = 0;
+  _current.store(initial.get(), std::memory_order_release);
+  _versions.push_back(std::move(initial));
+}
+
+AttributeDictionary::~AttributeDictionary() {}
+
+AttributeTranslator* AttributeDictionary::translator(uint64_t version) const noexcept {
+  Version const* current = _current.load(std::memory_order_acquire);
+  while (current != nullptr && current->number > version) {
+    current = current->previous;
+  }
+  if (current == nullptr || current->number != version) {
+    return nullptr;
+  }
+  return &current->translator;
+}
+
+uint64_t AttributeDictionary::add(std::vector<std::string_view> const& keys) {
+  std::lock_guard<std::mutex> guard(_lock);
+
+  Version const* current = _versions.back().get();
+  std::size_t const before = _keys.size();
+
+  try {
+    for (auto const& key : keys) {
+      if (_known.find(key) == _known.end()) {
+        _keys.emplace_back(key);
+        _known.emplace(_keys.back());
+      }
+    }
+
+    if (_keys.size() == before) {
+      // nothing new
+      return current->number;
+    }
+
+    auto version = std::make_unique<Version>();
+    version->number = current->number + 1;
+    version->previous = current;
+    version->added = _keys.size() - before;
+
+    uint64_t id = 0;
+    for (auto const& key : _keys) {
+      version->translator.add(key, ++id);
+    }
+    version->translator.seal();
+
+    _versions.reserve(_versions.size() + 1);
+    // publish the new version
+    _current.store(version.get(), std::memory_order_release);
+    _versions.push_back(std::move(version));
+    return current->number + 1;
+  } catch (...) {
+    // roll back the keys of the unpublished version
+    while (_keys.size() > before) {
+      _known.erase(_keys.back());
+      _keys.pop_back();
+    }
+    throw;
+  }
+}
+
+void AttributeDictionary::toVelocyPack(Builder& builder) const {
+  std::lock_guard<std::mutex> guard(_lock);
+
+  builder.openObject();
+  builder.add("versions", Value(ValueType::Array));
+  std::size_t offset = 0;
+  for (std::size_t i = 1; i < _versions.size(); ++i) {
+    builder.openArray();
+    for (std::size_t j = 0; j < _versions[i]->added; ++j) {
+      builder.add(Value(_keys[offset + j]));
+    }
+    offset += _versions[i]->added;
+    builder.close();
+  }
+  builder.close();
+  builder.close();
+}
+
+void AttributeDictionary::fromVelocyPack(Slice slice) {
+  if (!slice.isObject()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Object");
+  }
+  Slice versions = slice.get("versions");
+  if (!versions.isArray()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting attribute 'versions' to be an Array");
+  }
+  if (version() != 0) {
+    throw Exception(Exception::InternalError,
+                    "Dictionary must be empty when loading versions");
+  }
+
+  // validate everything before modifying the dictionary
+  std::unordered_set<std::string_view> seen;
+  for (auto const& keys : ArrayIterator(versions)) {
+    if (!keys.isArray() || keys.isEmptyArray()) {
+      throw Exception(Exception::InvalidValueType,
+                      "Expecting dictionary version to be a non-empty Array");
+    }
+    for (auto const& key : ArrayIterator(keys)) {
+      if (!key.isString()) {
+        throw Exception(Exception::InvalidValueType,
+                        "Expecting dictionary key to be a String");
+      }
+      if (!seen.emplace(key.stringView()).second) {
+        throw Exception(Exception::DuplicateAttributeName);
+      }
+    }
+  }
+
+  std::vector<std::string_view> added;
+  for (auto const& keys : ArrayIterator(versions)) {
+    added.clear();
+    for (auto const& key : ArrayIterator(keys)) {
+      added.push_back(key.stringView());
+    }
+    add(added);
+  }
+}
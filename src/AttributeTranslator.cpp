@@ -22,8 +22,15 @@
 /// @author Jan Steemann
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Builder.h"
+#include "velocypack/Exception.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Options.h"
 #include "velocypack/Slice.h"
@@ -46,27 +53,152 @@ void AttributeTranslator::add(std::string_view key, uint64_t id) {
   _count++;
 }
 
+namespace {
+
+// expected number of keys per displacement bucket of the perfect hash
+constexpr std::size_t keysPerBucket = 4;
+
+// number of times the perfect hash construction is restarted with more
+// buckets before giving up
+constexpr std::size_t maxRestarts = 8;
+
+}  // namespace
+
 void AttributeTranslator::seal() {
   if (_builder == nullptr) {
     return;
   }
 
+  auto const start = std::chrono::steady_clock::now();
+
   _builder->close();
 
   Slice s(_builder->slice());
 
+  std::vector<Entry> entries;
+  entries.reserve(_count);
+  std::unordered_set<std::string_view> seen;
+  // ids below this limit are stored in the dense id array
+  std::size_t const denseLimit = 4 * _count + 64;
+
   ObjectIterator it(s);
 
   while (it.valid()) {
     Slice const key(it.key(false));
     VELOCYPACK_ASSERT(key.isString());
+    std::string_view const name = key.stringView();
+    uint8_t const* id = it.value().begin();
+
+    // the first occurrence of a key wins
+    if (seen.emplace(name).second) {
+      entries.push_back(Entry{name, id});
+    }
 
-    // insert into string and char lookup maps
-    _keyToId.emplace(key.stringView(), it.value().begin());
-    // insert into id to slice lookup map
-    _idToKey.emplace(it.value().getUInt(), key.begin());
+    uint64_t const value = it.value().getUInt();
+    if (value < denseLimit) {
+      if (value >= _idToKey.size()) {
+        _idToKey.resize(static_cast<std::size_t>(value) + 1, nullptr);
+      }
+      if (_idToKey[value] == nullptr) {
+        _idToKey[value] = key.begin();
+        ++_statistics.denseIds;
+      }
+    } else if (_sparseIdToKey.emplace(value, key.begin()).second) {
+      ++_statistics.sparseIds;
+    }
     it.next();
   }
+
+  _statistics.keys = entries.size();
+  if (!entries.empty()) {
+    std::size_t numBuckets = entries.size() / keysPerBucket + 1;
+    while (!buildPerfectHash(entries, numBuckets)) {
+      if (++_statistics.restarts > maxRestarts) {
+        throw Exception(Exception::InternalError,
+                        "Unable to build perfect hash for attribute translator");
+      }
+      numBuckets *= 2;
+    }
+    _statistics.buckets = numBuckets;
+  }
+
+  _statistics.buildMicroseconds = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start).count());
+}
+
+// builds a minimal perfect hash using hash and displace: keys are
+// distributed into buckets, and for each bucket, starting with the largest,
+// a displacement value is searched that maps all keys of the bucket to
+// free slots
+bool AttributeTranslator::buildPerfectHash(std::vector<Entry> const& entries,
+                                           std::size_t numBuckets) {
+  std::size_t const n = entries.size();
+
+  std::vector<uint64_t> hashes;
+  hashes.reserve(n);
+  std::vector<std::vector<std::size_t>> buckets(numBuckets);
+  for (std::size_t i = 0; i < n; ++i) {
+    uint64_t const hash = hashKey(entries[i].key);
+    hashes.push_back(hash);
+    buckets[(hash >> 32) % numBuckets].push_back(i);
+  }
+
+  std::vector<std::size_t> order(numBuckets);
+  for (std::size_t i = 0; i < numBuckets; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&buckets](std::size_t lhs, std::size_t rhs) {
+                     return buckets[lhs].size() > buckets[rhs].size();
+                   });
+
+  _keyToId.assign(n, Entry{std::string_view(), nullptr});
+  _displacements.assign(numBuckets, 0);
+  std::vector<bool> taken(n, false);
+  std::vector<std::size_t> slots;
+  uint64_t const maxTrials = 64 * static_cast<uint64_t>(n) + 1024;
+
+  for (std::size_t b : order) {
+    auto const& bucket = buckets[b];
+    if (bucket.empty()) {
+      // buckets are sorted by size, so all remaining ones are empty
+      break;
+    }
+
+    for (uint64_t displacement = 0; ; ++displacement) {
+      if (displacement == maxTrials) {
+        _keyToId.clear();
+        _displacements.clear();
+        return false;
+      }
+      ++_statistics.displacementTrials;
+
+      slots.clear();
+      bool fits = true;
+      for (std::size_t i : bucket) {
+        std::size_t const slot = displacedSlot(hashes[i], displacement, n);
+        if (taken[slot] ||
+            std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+          fits = false;
+          break;
+        }
+        slots.push_back(slot);
+      }
+
+      if (fits) {
+        for (std::size_t j = 0; j < bucket.size(); ++j) {
+          taken[slots[j]] = true;
+          _keyToId[slots[j]] = entries[bucket[j]];
+        }
+        _displacements[b] = displacement;
+        _statistics.maxDisplacement =
+            (std::max)(_statistics.maxDisplacement, displacement);
+        break;
+      }
+    }
+  }
+  return true;
 }
   
 AttributeTranslatorScope::AttributeTranslatorScope(AttributeTranslator* translator)
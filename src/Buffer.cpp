@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Buffer.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+#ifdef __linux__
+
+constexpr ValueLength hugePageSize = 2 * 1024 * 1024;
+
+ValueLength systemPageSize() noexcept {
+  static ValueLength const size = [] {
+    long value = sysconf(_SC_PAGESIZE);
+    return value > 0 ? static_cast<ValueLength>(value) : ValueLength(4096);
+  }();
+  return size;
+}
+
+// applies the huge page and NUMA settings to a mapping. both are only
+// hints to the kernel, so errors are ignored
+void adviseMapping(void* p, ValueLength capacity,
+                   BufferGrowthPolicy const& policy) noexcept {
+#ifdef MADV_HUGEPAGE
+  if (policy.hugePages) {
+    madvise(p, capacity, MADV_HUGEPAGE);
+  }
+#endif
+#ifdef SYS_mbind
+  if (policy.numaNode >= 0 &&
+      static_cast<std::size_t>(policy.numaNode) < 8 * sizeof(unsigned long)) {
+    // MPOL_PREFERRED from <numaif.h>, which is not necessarily installed
+    constexpr int mpolPreferred = 1;
+    unsigned long nodeMask = 1UL << policy.numaNode;
+    syscall(SYS_mbind, p, capacity, mpolPreferred, &nodeMask,
+            8 * sizeof(nodeMask) + 1, 0);
+  }
+#endif
+}
+
+#endif
+
+}  // namespace
+
+bool MappedMemory::supported() noexcept {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+ValueLength MappedMemory::capacity(ValueLength len,
+                                   BufferGrowthPolicy const& policy) noexcept {
+#ifdef __linux__
+  ValueLength const unit = policy.hugePages ? ::hugePageSize : ::systemPageSize();
+  return len + (unit - len % unit) % unit;
+#else
+  (void)policy;
+  return len;
+#endif
+}
+
+void* MappedMemory::map(ValueLength capacity,
+                        BufferGrowthPolicy const& policy) noexcept {
+#ifdef __linux__
+  if (!policy.hugePages) {
+    void* p = mmap(nullptr, checkOverflow(capacity), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+      return nullptr;
+    }
+    ::adviseMapping(p, capacity, policy);
+    return p;
+  }
+
+  // huge pages are only used for 2 MB aligned ranges, so map a bit more
+  // and cut off the unaligned parts at both ends
+  std::size_t const length = checkOverflow(capacity + ::hugePageSize);
+  void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  uintptr_t const start = reinterpret_cast<uintptr_t>(p);
+  uintptr_t const aligned =
+      (start + ::hugePageSize - 1) & ~uintptr_t(::hugePageSize - 1);
+  if (aligned > start) {
+    munmap(p, aligned - start);
+  }
+  std::size_t const tail = length - (aligned - start) - checkOverflow(capacity);
+  if (tail > 0) {
+    munmap(reinterpret_cast<void*>(aligned + capacity), tail);
+  }
+  p = reinterpret_cast<void*>(aligned);
+  ::adviseMapping(p, capacity, policy);
+  return p;
+#else
+  (void)capacity;
+  (void)policy;
+  return nullptr;
+#endif
+}
+
+void* MappedMemory::remap(void* p, ValueLength oldCapacity,
+                          ValueLength newCapacity,
+                          BufferGrowthPolicy const& policy) noexcept {
+#ifdef __linux__
+  // resize in place if possible, which keeps the alignment
+  void* result = mremap(p, checkOverflow(oldCapacity),
+                        checkOverflow(newCapacity), 0);
+  if (result != MAP_FAILED) {
+    ::adviseMapping(result, newCapacity, policy);
+    return result;
+  }
+  if (newCapacity <= oldCapacity) {
+    return nullptr;
+  }
+
+#ifdef MREMAP_FIXED
+  if (policy.hugePages) {
+    // mremap() would move the pages to an address of its own choosing,
+    // which is not necessarily 2 MB aligned. so map an aligned range of the
+    // new capacity, and move the old pages onto its start without copying
+    void* target = map(newCapacity, policy);
+    if (target == nullptr) {
+      return nullptr;
+    }
+    result = mremap(p, checkOverflow(oldCapacity), checkOverflow(oldCapacity),
+                    MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (result == MAP_FAILED) {
+      unmap(target, newCapacity);
+      return nullptr;
+    }
+    ::adviseMapping(result, newCapacity, policy);
+    return result;
+  }
+#endif
+
+  result = mremap(p, checkOverflow(oldCapacity), checkOverflow(newCapacity),
+                  MREMAP_MAYMOVE);
+  if (result == MAP_FAILED) {
+    return nullptr;
+  }
+  ::adviseMapping(result, newCapacity, policy);
+  return result;
+#else
+  (void)p;
+  (void)oldCapacity;
+  (void)newCapacity;
+  (void)policy;
+  return nullptr;
+#endif
+}
+
+void MappedMemory::unmap(void* p, ValueLength capacity) noexcept {
+#ifdef __linux__
+  munmap(p, checkOverflow(capacity));
+#else
+  (void)p;
+  (void)capacity;
+#endif
+}
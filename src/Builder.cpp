@@ -22,6 +22,7 @@
 /// @author Jan Steemann
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <string_view>
@@ -32,6 +33,7 @@
 #include "velocypack/Dumper.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Sink.h"
+#include "velocypack/Statistics.h"
 
 using namespace arangodb::velocypack;
 
@@ -39,8 +41,8 @@ namespace {
   
 // checks whether a memmove operation is allowed to get rid of the padding
 bool isAllowedToMemmove(Options const* options, uint8_t const* start, 
-                        std::vector<ValueLength>::iterator indexStart, 
-                        std::vector<ValueLength>::iterator indexEnd,
+                        Builder::IndexVector::iterator indexStart, 
+                        Builder::IndexVector::iterator indexEnd,
                         ValueLength offsetSize) {
   VELOCYPACK_ASSERT(offsetSize == 1 || offsetSize == 2);
 
@@ -59,6 +61,72 @@ bool isAllowedToMemmove(Options const* options, uint8_t const* start,
   return false;
 }
 
+// determines the byte width of the byte length, the number of subvalues
+// and the index table entries of an Array with n subvalues, which
+// currently occupies byteSize bytes including the 9 bytes reserved for its
+// header. also determines whether the subvalues can be moved down to get
+// rid of unused header bytes. [indexStart, indexEnd) are the offsets of
+// the subvalues, see isAllowedToMemmove()
+unsigned int determineArrayOffsetSize(Options const* options, uint8_t const* start,
+                                      Builder::IndexVector::iterator indexStart,
+                                      Builder::IndexVector::iterator indexEnd,
+                                      ValueLength byteSize, ValueLength n,
+                                      bool needIndexTable, bool& allowMemmove) {
+  bool const needNrSubs = needIndexTable;
+  unsigned int offsetSize;
+  allowMemmove = ::isAllowedToMemmove(options, start, indexStart, indexEnd, 1);
+  if (byteSize + 
+      (needIndexTable ? n : 0) - 
+      (allowMemmove ? (needNrSubs ? 6 : 7) : 0) <= 0xff) {
+    // We have so far used byteSize bytes, including the reserved 8
+    // bytes for byte length and number of subvalues. In the 1-byte number
+    // case we would win back 6 bytes but would need one byte per subvalue
+    // for the index table
+    offsetSize = 1;
+  } else {
+    allowMemmove = ::isAllowedToMemmove(options, start, indexStart, indexEnd, 2);
+    if (byteSize + 
+        (needIndexTable ? 2 * n : 0) - 
+        (allowMemmove ? (needNrSubs ? 4 : 6) : 0) <= 0xffff) {
+      offsetSize = 2;
+    } else {
+      allowMemmove = false;
+      if (byteSize + 
+          (needIndexTable ? 4 * n : 0) <= 0xffffffffu) {
+        offsetSize = 4;
+      } else {
+        offsetSize = 8;
+      }
+    }
+  }
+
+  if (offsetSize < 8 &&
+      !needIndexTable && 
+      options->paddingBehavior == Options::PaddingBehavior::UsePadding) {
+    // if we are allowed to use padding, we will pad to 8 bytes anyway. as we are not
+    // using an index table, we can also use type 0x05 for all Arrays without making
+    // things worse space-wise
+    offsetSize = 8;
+    allowMemmove = false;
+  }
+  return offsetSize;
+}
+
+// computes the byte length of a compact Array or Object whose head byte
+// and subvalues occupy size bytes, and whose number of subvalues takes
+// nLen bytes. bLen is set to the number of bytes of the byte length
+ValueLength compactByteSize(ValueLength size, ValueLength nLen, ValueLength& bLen) {
+  ValueLength byteSize = size + nLen;
+  VELOCYPACK_ASSERT(byteSize > 0);
+  bLen = getVariableValueLength(byteSize);
+  byteSize += bLen;
+  if (getVariableValueLength(byteSize) != bLen) {
+    byteSize += 1;
+    bLen += 1;
+  }
+  return byteSize;
+}
+
 uint8_t determineArrayType(bool needIndexTable, ValueLength offsetSize) {
   uint8_t type;
   // Now build the table:
@@ -270,6 +338,7 @@ Builder::Builder(Builder const& that)
         _stack(_arena),
         _indexes(that._indexes),
         _keyWritten(that._keyWritten),
+        _strings(that._strings == nullptr ? nullptr : std::make_unique<StringTable>(*that._strings)),
         options(that.options) {
   VELOCYPACK_ASSERT(options != nullptr);
 
@@ -308,6 +377,7 @@ Builder& Builder::operator=(Builder const& that) {
     _stack = that._stack;
     _indexes = that._indexes;
     _keyWritten = that._keyWritten;
+    _strings = that._strings == nullptr ? nullptr : std::make_unique<StringTable>(*that._strings);
     options = that.options;
   }
   VELOCYPACK_ASSERT(options != nullptr);
@@ -323,6 +393,7 @@ Builder::Builder(Builder&& that) noexcept
       _stack(_arena),
       _indexes(std::move(that._indexes)),
       _keyWritten(that._keyWritten),
+      _strings(std::move(that._strings)),
       options(that.options) {
       
   // do a full initial allocation in the arena, so we can maximize its usage
@@ -361,6 +432,7 @@ Builder& Builder::operator=(Builder&& that) noexcept {
     _stack = std::move(that._stack);
     _indexes = std::move(that._indexes);
     _keyWritten = that._keyWritten;
+    _strings = std::move(that._strings);
     options = that.options;
     VELOCYPACK_ASSERT(that._buffer == nullptr);
     that._bufferPtr = nullptr;
@@ -387,9 +459,9 @@ std::string Builder::toJson() const {
 }
   
 void Builder::sortObjectIndexShort(uint8_t* objBase,
-                                   std::vector<ValueLength>::iterator indexStart,
-                                   std::vector<ValueLength>::iterator indexEnd) const {
-  std::sort(indexStart, indexEnd, [objBase](ValueLength const& a, ValueLength const& b) {
+                                   IndexVector::iterator indexStart,
+                                   IndexVector::iterator indexEnd) const {
+  auto const less = [objBase](ValueLength const& a, ValueLength const& b) {
     uint8_t const* aa = objBase + a;
     uint8_t const* bb = objBase + b;
     if (*aa >= 0x40 && *aa <= 0xbe && *bb >= 0x40 && *bb <= 0xbe) {
@@ -406,12 +478,26 @@ void Builder::sortObjectIndexShort(uint8_t* objBase,
       int c = std::memcmp(aa, bb, checkOverflow(m));
       return (c < 0 || (c == 0 && lena < lenb));
     }
-  });
+  };
+
+  // attributes are often added in sorted order already, e.g. by the struct
+  // serializer or when parsing JSON that was produced from VPack
+  VELOCYPACK_STATISTICS_ADD(IndexSorts, 1);
+  VELOCYPACK_STATISTICS_TIMER(IndexSortNanos);
+
+  if (!std::is_sorted(indexStart, indexEnd, less)) {
+    std::sort(indexStart, indexEnd, less);
+  } else {
+    VELOCYPACK_STATISTICS_ADD(IndexSortsSkipped, 1);
+  }
 }
 
 void Builder::sortObjectIndexLong(uint8_t* objBase,
-                                  std::vector<ValueLength>::iterator indexStart,
-                                  std::vector<ValueLength>::iterator indexEnd) const {
+                                  IndexVector::iterator indexStart,
+                                  IndexVector::iterator indexEnd) const {
+  VELOCYPACK_STATISTICS_ADD(IndexSorts, 1);
+  VELOCYPACK_STATISTICS_TIMER(IndexSortNanos);
+
 #ifndef VELOCYPACK_NO_THREADLOCALS
   std::unique_ptr<std::vector<SortEntry>>& tmp = ::sortEntries;
 
@@ -436,8 +522,7 @@ void Builder::sortObjectIndexLong(uint8_t* objBase,
     tmp->push_back(e);
   }
   VELOCYPACK_ASSERT(tmp->size() == n);
-  std::sort(tmp->begin(), tmp->end(), [](SortEntry const& a,
-                                         SortEntry const& b)
+  auto const less = [](SortEntry const& a, SortEntry const& b)
 #ifdef VELOCYPACK_64BIT
     noexcept
 #endif
@@ -449,7 +534,14 @@ void Builder::sortObjectIndexLong(uint8_t* objBase,
     int res = std::memcmp(a.nameStart, b.nameStart, compareLength);
 
     return (res < 0 || (res == 0 && sizea < sizeb));
-  });
+  };
+
+  if (std::is_sorted(tmp->begin(), tmp->end(), less)) {
+    // nothing to do, see sortObjectIndexShort()
+    VELOCYPACK_STATISTICS_ADD(IndexSortsSkipped, 1);
+    return;
+  }
+  std::sort(tmp->begin(), tmp->end(), less);
 
   // copy back the sorted offsets
   for (std::size_t i = 0; i < n; i++) {
@@ -467,42 +559,42 @@ Builder& Builder::closeEmptyArrayOrObject(ValueLength pos, bool isArray) {
 }
 
 bool Builder::closeCompactArrayOrObject(ValueLength pos, bool isArray,
-                                        std::vector<ValueLength>::iterator indexStart,
-                                        std::vector<ValueLength>::iterator indexEnd) {
+                                        IndexVector::iterator indexStart,
+                                        IndexVector::iterator indexEnd) {
   std::size_t const n = std::distance(indexStart, indexEnd);
 
   // use compact notation
   ValueLength nLen =
       getVariableValueLength(static_cast<ValueLength>(n));
   VELOCYPACK_ASSERT(nLen > 0);
-  ValueLength byteSize = _pos - (pos + 8) + nLen;
-  VELOCYPACK_ASSERT(byteSize > 0);
-  ValueLength bLen = getVariableValueLength(byteSize);
-  byteSize += bLen;
-  if (getVariableValueLength(byteSize) != bLen) {
-    byteSize += 1;
-    bLen += 1;
-  }
+  ValueLength bLen;
+  ValueLength const byteSize = ::compactByteSize(_pos - (pos + 8), nLen, bLen);
 
   if (bLen < 9) {
     // can only use compact notation if total byte length is at most 8 bytes
     // long
+
+    // need additional memory for storing the number of values. reserve it
+    // before modifying anything, so a failure leaves the value untouched
+    if (nLen > 8 - bLen) {
+      reserve(nLen);
+    }
+
     _start[pos] = (isArray ? 0x13 : 0x14);
     ValueLength targetPos = 1 + bLen;
 
     if (_pos > (pos + 9)) {
       ValueLength len = _pos - (pos + 9);
       memmove(_start + pos + targetPos, _start + pos + 9, checkOverflow(len));
+      if (_strings != nullptr) {
+        shiftStrings(pos + 9, 9 - targetPos);
+      }
     }
 
     // store byte length
     VELOCYPACK_ASSERT(byteSize > 0);
     storeVariableValueLength<false>(_start + pos + 1, byteSize);
 
-    // need additional memory for storing the number of values
-    if (nLen > 8 - bLen) {
-      reserve(nLen);
-    }
     storeVariableValueLength<true>(_start + pos + byteSize - 1,
                                    static_cast<ValueLength>(n));
 
@@ -516,8 +608,8 @@ bool Builder::closeCompactArrayOrObject(ValueLength pos, bool isArray,
 }
 
 Builder& Builder::closeArray(ValueLength pos, 
-                             std::vector<ValueLength>::iterator indexStart,
-                             std::vector<ValueLength>::iterator indexEnd) {
+                             IndexVector::iterator indexStart,
+                             IndexVector::iterator indexEnd) {
   std::size_t const n = std::distance(indexStart, indexEnd);
   VELOCYPACK_ASSERT(n > 0);
 
@@ -554,46 +646,28 @@ Builder& Builder::closeArray(ValueLength pos,
   VELOCYPACK_ASSERT(needIndexTable == needNrSubs);
 
   // First determine byte length and its format:
-  unsigned int offsetSize;
   // can be 1, 2, 4 or 8 for the byte width of the offsets,
   // the byte length and the number of subvalues:
-  bool allowMemmove = ::isAllowedToMemmove(options, _start + pos, indexStart, indexEnd, 1);
-  if (_pos - pos + 
-      (needIndexTable ? n : 0) - 
-      (allowMemmove ? (needNrSubs ? 6 : 7) : 0) <= 0xff) {
-    // We have so far used _pos - pos bytes, including the reserved 8
-    // bytes for byte length and number of subvalues. In the 1-byte number
-    // case we would win back 6 bytes but would need one byte per subvalue
-    // for the index table
-    offsetSize = 1;
-  } else {
-    allowMemmove = ::isAllowedToMemmove(options, _start + pos, indexStart, indexEnd, 2);
-    if (_pos - pos + 
-        (needIndexTable ? 2 * n : 0) - 
-        (allowMemmove ? (needNrSubs ? 4 : 6) : 0) <= 0xffff) {
-      offsetSize = 2;
-    } else {
-      allowMemmove = false;
-      if (_pos - pos + 
-          (needIndexTable ? 4 * n : 0) <= 0xffffffffu) {
-        offsetSize = 4;
-      } else {
-        offsetSize = 8;
-      }
-    }
-  }
+  bool allowMemmove;
+  unsigned int const offsetSize = ::determineArrayOffsetSize(
+      options, _start + pos, indexStart, indexEnd, _pos - pos, n,
+      needIndexTable, allowMemmove);
 
   VELOCYPACK_ASSERT(offsetSize == 1 || offsetSize == 2 || offsetSize == 4 || offsetSize == 8); 
   VELOCYPACK_ASSERT(!allowMemmove || offsetSize == 1 || offsetSize == 2);
 
-  if (offsetSize < 8 &&
-      !needIndexTable && 
-      options->paddingBehavior == Options::PaddingBehavior::UsePadding) {
-    // if we are allowed to use padding, we will pad to 8 bytes anyway. as we are not
-    // using an index table, we can also use type 0x05 for all Arrays without making
-    // things worse space-wise
-    offsetSize = 8;
-    allowMemmove = false;
+  ValueLength targetPos = 1 + 2 * offsetSize;
+  if (!needIndexTable) {
+    targetPos -= offsetSize;
+  }
+
+  // reserve memory for the index table and the number of subvalues before
+  // modifying anything, so a failure leaves the Array untouched
+  ValueLength const tableSize = (needIndexTable ? offsetSize * n : 0) +
+                                (offsetSize == 8 && needNrSubs ? 8 : 0);
+  ValueLength const gain = allowMemmove ? 9 - targetPos : 0;
+  if (tableSize > gain) {
+    reserve(tableSize - gain);
   }
 
   // fix head byte
@@ -604,13 +678,12 @@ Builder& Builder::closeArray(ValueLength pos,
     // check if one of the first entries in the array is ValueType::None 
     // (0x00). in this case, we could not distinguish between a None (0x00) 
     // and the optional padding. so we must prevent the memmove here
-    ValueLength targetPos = 1 + 2 * offsetSize;
-    if (!needIndexTable) {
-      targetPos -= offsetSize;
-    }
     if (_pos > (pos + 9)) {
       ValueLength len = _pos - (pos + 9);
       memmove(_start + pos + targetPos, _start + pos + 9, checkOverflow(len));
+      if (_strings != nullptr) {
+        shiftStrings(pos + 9, 9 - targetPos);
+      }
     }
     ValueLength const diff = 9 - targetPos;
     rollback(diff);
@@ -675,8 +748,8 @@ Builder& Builder::close() {
                     head == 0x14);
 
   bool const isArray = (head == 0x06 || head == 0x13);
-  std::vector<ValueLength>::iterator indexStart = _indexes.begin() + indexStartPos; 
-  std::vector<ValueLength>::iterator indexEnd = _indexes.end();
+  IndexVector::iterator indexStart = _indexes.begin() + indexStartPos; 
+  IndexVector::iterator indexEnd = _indexes.end();
   ValueLength const n = std::distance(indexStart, indexEnd);
 
   if (n == 0) {
@@ -711,9 +784,6 @@ Builder& Builder::close() {
 
   // from here on we are sure that we are dealing with Object types only.
 
-  // fix head byte in case a compact Array / Object was originally requested
-  _start[pos] = 0x0b;
-
   // First determine byte length and its format:
   unsigned int offsetSize = 8;
   // can be 1, 2, 4 or 8 for the byte width of the offsets,
@@ -732,15 +802,31 @@ Builder& Builder::close() {
   } else if (_pos - pos + 4 * n <= 0xffffffffu) {
     offsetSize = 4;
   }
-    
-  if (offsetSize < 4 &&
+
+  bool const moveDown = offsetSize < 4 &&
       (options->paddingBehavior == Options::PaddingBehavior::NoPadding ||
-       (offsetSize == 1 && options->paddingBehavior == Options::PaddingBehavior::Flexible))) {
+       (offsetSize == 1 && options->paddingBehavior == Options::PaddingBehavior::Flexible));
+  ValueLength const targetPos = 1 + 2 * offsetSize;
+
+  // reserve memory for the index table before modifying anything, so a
+  // failure leaves the Object untouched
+  ValueLength const tableSize = offsetSize * n + (offsetSize == 8 ? 8 : 0);
+  ValueLength const gain = moveDown ? 9 - targetPos : 0;
+  if (tableSize > gain) {
+    reserve(tableSize - gain);
+  }
+
+  // fix head byte in case a compact Array / Object was originally requested
+  _start[pos] = 0x0b;
+    
+  if (moveDown) {
     // Maybe we need to move down data:
-    ValueLength targetPos = 1 + 2 * offsetSize;
     if (_pos > (pos + 9)) {
       ValueLength len = _pos - (pos + 9);
       memmove(_start + pos + targetPos, _start + pos + 9, checkOverflow(len));
+      if (_strings != nullptr) {
+        shiftStrings(pos + 9, 9 - targetPos);
+      }
     }
     ValueLength const diff = 9 - targetPos;
     rollback(diff);
@@ -807,6 +893,110 @@ Builder& Builder::close() {
   return *this;
 }
 
+Builder::ArrayLayout Builder::prepareArray(ValueLength n,
+                                           ValueLength payloadSize,
+                                           bool equalSizes, bool unindexed) {
+  ArrayLayout layout{};
+
+  if (n == 0) {
+    reserve(1);
+    _start[_pos] = 0x01;
+    layout.byteSize = 1;
+    layout.headerSize = 1;
+    return layout;
+  }
+
+  if (unindexed || options->buildUnindexedArrays) {
+    ValueLength const nLen = getVariableValueLength(n);
+    ValueLength bLen;
+    ValueLength const byteSize = ::compactByteSize(1 + payloadSize, nLen, bLen);
+    if (bLen < 9) {
+      reserve(byteSize);
+      _start[_pos] = 0x13;
+      storeVariableValueLength<false>(_start + _pos + 1, byteSize);
+      layout.byteSize = byteSize;
+      layout.headerSize = 1 + bLen;
+      layout.compact = true;
+      return layout;
+    }
+  }
+
+  // same decisions as in closeArray()
+  bool const needIndexTable = n > 1 && !equalSizes;
+  bool allowMemmove;
+  // none of the members can be a None value, so there is nothing to check
+  // for isAllowedToMemmove()
+  IndexVector::iterator none = _indexes.end();
+  unsigned int const offsetSize = ::determineArrayOffsetSize(
+      options, _start + _pos, none, none, 9 + payloadSize, n, needIndexTable,
+      allowMemmove);
+
+  ValueLength headerSize = 9;
+  if (allowMemmove) {
+    headerSize = 1 + 2 * offsetSize;
+    if (!needIndexTable) {
+      headerSize -= offsetSize;
+    }
+  }
+  ValueLength const tableSize =
+      needIndexTable ? offsetSize * n + (offsetSize == 8 ? 8 : 0) : 0;
+
+  layout.byteSize = headerSize + payloadSize + tableSize;
+  layout.headerSize = headerSize;
+  layout.tableOffset = headerSize + payloadSize;
+  layout.offsetSize = needIndexTable ? offsetSize : 0;
+
+  reserve(layout.byteSize);
+  uint8_t* start = _start + _pos;
+  start[0] = ::determineArrayType(needIndexTable, offsetSize);
+  std::memset(start + 1, 0, checkOverflow(headerSize - 1));
+  ValueLength x = layout.byteSize;
+  for (unsigned int i = 1; i <= offsetSize; i++) {
+    start[i] = x & 0xff;
+    x >>= 8;
+  }
+  if (offsetSize < 8 && needIndexTable) {
+    x = n;
+    for (unsigned int i = offsetSize + 1; i <= 2 * offsetSize; i++) {
+      start[i] = x & 0xff;
+      x >>= 8;
+    }
+  }
+  return layout;
+}
+
+void Builder::finishArray(ArrayLayout const& layout, ValueLength n) {
+  uint8_t* start = _start + _pos;
+  if (layout.compact) {
+    storeVariableValueLength<true>(start + layout.byteSize - 1, n);
+  } else if (layout.offsetSize == 8) {
+    uint8_t* p = start + layout.byteSize - 8;
+    for (unsigned int i = 0; i < 8; i++) {
+      *p++ = n & 0xff;
+      n >>= 8;
+    }
+  }
+  advance(layout.byteSize);
+}
+
+void Builder::rollback(Savepoint const& savepoint) {
+  if (VELOCYPACK_UNLIKELY(
+          savepoint.pos > _pos || savepoint.stackSize > _stack.size() ||
+          savepoint.indexesSize > _indexes.size() ||
+          (savepoint.stackSize > 0 &&
+           _stack[savepoint.stackSize - 1].startPos != savepoint.compoundStart))) {
+    throw Exception(Exception::BuilderInvalidSavepoint);
+  }
+
+  // the compound values that were open at the time of the savepoint are
+  // still open, and their members in front of the savepoint were not
+  // touched since then. so truncating everything is sufficient
+  _stack.erase(_stack.begin() + savepoint.stackSize, _stack.end());
+  _indexes.erase(_indexes.begin() + savepoint.indexesSize, _indexes.end());
+  _keyWritten = savepoint.keyWritten;
+  resetTo(savepoint.pos);
+}
+
 // checks whether an Object value has a specific key attribute
 bool Builder::hasKey(std::string_view key) const {
   return !getKey(key).isNone();
@@ -823,8 +1013,8 @@ Slice Builder::getKey(std::string_view key) const {
   if (VELOCYPACK_UNLIKELY(_start[pos] != 0x0b && _start[pos] != 0x14)) {
     throw Exception(Exception::BuilderNeedOpenObject);
   }
-  std::vector<ValueLength>::const_iterator indexStart = _indexes.begin() + indexStartPos;
-  std::vector<ValueLength>::const_iterator indexEnd = _indexes.end();
+  IndexVector::const_iterator indexStart = _indexes.begin() + indexStartPos;
+  IndexVector::const_iterator indexEnd = _indexes.end();
   while (indexStart != indexEnd) {
     Slice s(_start + pos + *indexStart);
     if (s.makeKey().isEqualString(key)) {
@@ -849,6 +1039,9 @@ void Builder::appendTag(uint64_t tag) {
     appendByte(0xef);
     appendLengthUnchecked<8>(tag);
   }
+  if (_strings != nullptr) {
+    _strings->tagEnd = _pos;
+  }
 }
 
 uint8_t* Builder::set(Value const& item) {
@@ -1004,6 +1197,7 @@ uint8_t* Builder::set(Value const& item) {
       }
       std::memcpy(_start + _pos, p, size);
       advance(size);
+      checkStringDeduplication(oldPos);
       break;
     }
     case ValueType::Array: {
@@ -1118,11 +1312,15 @@ uint8_t* Builder::set(Slice const& item) {
     throw Exception(Exception::BuilderCustomDisallowed);
   }
 
+  auto const oldPos = _pos;
   ValueLength const l = item.byteSize();
   reserve(l);
   std::memcpy(_start + _pos, item.start(), checkOverflow(l));
   advance(l);
-  return _start + _pos - l;
+  if (item.isString()) {
+    checkStringDeduplication(oldPos);
+  }
+  return _start + oldPos;
 }
 
 uint8_t* Builder::set(ValuePair const& pair) {
@@ -1150,6 +1348,7 @@ uint8_t* Builder::set(ValuePair const& pair) {
     VELOCYPACK_ASSERT(pair.getStart() != nullptr);
     std::memcpy(_start + _pos, pair.getStart(), checkOverflow(size));
     advance(size);
+    checkStringDeduplication(oldPos);
     return _start + oldPos;
   } else if (pair.valueType() == ValueType::Binary) {
     uint64_t v = pair.getSize();
@@ -1202,6 +1401,79 @@ void Builder::closeLevel() noexcept {
   ValueLength const indexStartPos = _stack.back().indexStartPos; 
   _stack.pop_back();
   _indexes.erase(_indexes.begin() + indexStartPos, _indexes.end());
+  if (_stack.empty() && _strings != nullptr) {
+    // references never point into another top-level value
+    _strings->clear();
+  }
+}
+
+void Builder::deduplicateString(ValueLength pos) {
+  if (_strings == nullptr) {
+    _strings = std::make_unique<StringTable>();
+  }
+  StringTable& table = *_strings;
+  if (pos == table.tagEnd) {
+    return;
+  }
+
+  std::string_view const value = Slice(_start + pos).stringView();
+  uint64_t const hash = VELOCYPACK_HASH(value.data(), value.size(), 0xdeadbeef);
+
+  auto it = table.lookup.find(hash);
+  if (it != table.lookup.end() && it->second < table.strings.size()) {
+    ValueLength const target = table.strings[it->second];
+    // only reference Strings inside the innermost open compound, so that
+    // any copied sub-value contains the Strings referenced in it
+    if (target < pos && target > _stack.back().startPos &&
+        Slice(_start + target).stringView() == value) {
+      // replace the String by a reference to the earlier one
+      ValueLength const distance = pos - target;
+      uint8_t width = 1;
+      while (width < 8 && (distance >> (8 * width)) != 0) {
+        ++width;
+      }
+      resetTo(pos);
+      reserve(3 + width);
+      appendByteUnchecked(0xee);
+      appendByteUnchecked(static_cast<uint8_t>(Slice::stringReferenceTag));
+      appendByteUnchecked(0x27 + width);
+      ValueLength x = distance;
+      for (uint8_t i = 0; i < width; ++i) {
+        appendByteUnchecked(static_cast<uint8_t>(x & 0xff));
+        x >>= 8;
+      }
+      table.references.push_back(pos);
+      return;
+    }
+  }
+
+  table.lookup[hash] = table.strings.size();
+  table.strings.push_back(pos);
+}
+
+void Builder::shiftStrings(ValueLength from, ValueLength delta) noexcept {
+  StringTable& table = *_strings;
+  for (auto it = table.strings.rbegin();
+       it != table.strings.rend() && *it >= from; ++it) {
+    *it -= delta;
+  }
+  for (auto it = table.references.rbegin();
+       it != table.references.rend() && *it >= from; ++it) {
+    ValueLength const old = *it;
+    *it -= delta;
+    uint8_t* p = _start + *it;
+    ValueLength const width = p[2] - 0x27;
+    ValueLength distance = readIntegerNonEmpty<ValueLength>(p + 3, width);
+    if (old - distance < from) {
+      // the referenced String was not moved. keep the width of the
+      // distance, as it only gets smaller
+      distance -= delta;
+      for (ValueLength i = 0; i < width; ++i) {
+        p[3 + i] = static_cast<uint8_t>(distance & 0xff);
+        distance >>= 8;
+      }
+    }
+  }
 }
 
 bool Builder::checkAttributeUniqueness(Slice obj) const {
@@ -22,12 +22,20 @@
 /// @author Jan Steemann
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "velocypack/velocypack-common.h"
 #include "velocypack/Collection.h"
+#include "velocypack/Compare.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Slice.h"
 #include "velocypack/Value.h"
@@ -50,6 +58,146 @@ Builder& Collection::appendArray(Builder& builder, Slice const& slice) {
   return builder;
 }
 
+namespace {
+
+// minimum number of array members each thread has to sort in sortParallel.
+// for smaller arrays the thread startup costs dominate
+constexpr std::size_t minParallelSortChunk = 16384;
+
+// collect the members of an array, using the iterator so that compact
+// arrays are not scanned from the start for every member
+std::vector<Slice> arrayMembers(Slice const& array) {
+  if (!array.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  }
+  std::vector<Slice> subValues;
+  ArrayIterator it(array);
+  subValues.reserve(checkOverflow(it.size()));
+  while (it.valid()) {
+    subValues.push_back(it.value());
+    it.next();
+  }
+  return subValues;
+}
+
+// runs tasks on their own threads. an exception thrown by a task is
+// caught and rethrown by wait() once all threads have been joined. the
+// destructor joins all threads still running, so that a failure to start
+// a thread does not leave joinable threads behind
+class ParallelTasks {
+ public:
+  explicit ParallelTasks(std::size_t expectedTasks) {
+    _threads.reserve(expectedTasks);
+  }
+
+  ~ParallelTasks() { join(); }
+
+  ParallelTasks(ParallelTasks const&) = delete;
+  ParallelTasks& operator=(ParallelTasks const&) = delete;
+
+  template<typename F>
+  void run(F task) {
+    _threads.emplace_back([this, task = std::move(task)]() {
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        if (_exception == nullptr) {
+          _exception = std::current_exception();
+        }
+      }
+    });
+  }
+
+  // waits for all tasks started so far, and rethrows the first exception
+  // thrown by any of them
+  void wait() {
+    join();
+    if (_exception != nullptr) {
+      std::rethrow_exception(std::exchange(_exception, nullptr));
+    }
+  }
+
+ private:
+  void join() noexcept {
+    for (auto& t : _threads) {
+      t.join();
+    }
+    _threads.clear();
+  }
+
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::exception_ptr _exception;
+};
+
+// open-addressing hash set of Slices, using linear probing. the set only
+// stores pointers to the Slices' data, so the data must outlive the set.
+// the capacity is fixed at construction time
+class SliceHashSet {
+ public:
+  static constexpr std::size_t NotFound = SIZE_MAX;
+
+  explicit SliceHashSet(std::size_t expectedSize) : _size(0) {
+    // keep the load factor at or below 0.5
+    std::size_t capacity = 16;
+    while (capacity < 2 * expectedSize) {
+      capacity *= 2;
+    }
+    _entries.resize(capacity);
+  }
+
+  // looks up the Slice, and inserts it if it is not yet contained. returns
+  // the insertion order number of the Slice's entry, and whether or not the
+  // Slice has been inserted by this call
+  std::pair<std::size_t, bool> insert(Slice slice) {
+    uint64_t const hash = _hasher(slice);
+    std::size_t const mask = _entries.size() - 1;
+    std::size_t pos = static_cast<std::size_t>(hash) & mask;
+
+    while (true) {
+      Entry& e = _entries[pos];
+      if (e.data == nullptr) {
+        VELOCYPACK_ASSERT(_size < _entries.size() / 2);
+        e.hash = hash;
+        e.data = slice.start();
+        e.number = _size++;
+        return std::make_pair(e.number, true);
+      }
+      if (e.hash == hash && _equal(Slice(e.data), slice)) {
+        return std::make_pair(e.number, false);
+      }
+      pos = (pos + 1) & mask;
+    }
+  }
+
+  std::size_t size() const noexcept { return _size; }
+
+ private:
+  struct Entry {
+    uint64_t hash = 0;
+    uint8_t const* data = nullptr;
+    std::size_t number = 0;
+  };
+
+  std::vector<Entry> _entries;
+  std::size_t _size;
+  NormalizedCompare::Hash _hasher;
+  NormalizedCompare::Equal _equal;
+};
+
+Builder buildArray(std::vector<Slice> const& subValues) {
+  Builder b;
+  b.openArray();
+  for (auto const& s : subValues) {
+    b.add(s);
+  }
+  b.close();
+  return b;
+}
+
+} // namespace
+
 // convert a vector of strings into an unordered_set of strings
 static inline std::unordered_set<std::string> makeSet(
     std::vector<std::string> const& keys) {
@@ -417,6 +565,591 @@ Builder& Collection::merge(Builder& builder, Slice const& left, Slice const& rig
   return builder;
 }
 
+namespace {
+
+enum class PatchAction { Add, Remove, Replace };
+
+// splits an RFC 6901 JSON pointer into its unescaped reference tokens
+std::vector<std::string> parsePointer(std::string_view pointer) {
+  std::vector<std::string> tokens;
+  if (pointer.empty()) {
+    // refers to the whole document
+    return tokens;
+  }
+  if (pointer[0] != '/') {
+    throw Exception(Exception::InvalidAttributePath,
+                    "JSON pointer must start with '/'");
+  }
+
+  std::string current;
+  for (std::size_t i = 1; i < pointer.size(); ++i) {
+    char c = pointer[i];
+    if (c == '/') {
+      tokens.emplace_back(std::move(current));
+      current.clear();
+    } else if (c == '~') {
+      if (i + 1 < pointer.size() && pointer[i + 1] == '0') {
+        current.push_back('~');
+      } else if (i + 1 < pointer.size() && pointer[i + 1] == '1') {
+        current.push_back('/');
+      } else {
+        throw Exception(Exception::InvalidAttributePath,
+                        "Invalid escape sequence in JSON pointer");
+      }
+      ++i;
+    } else {
+      current.push_back(c);
+    }
+  }
+  tokens.emplace_back(std::move(current));
+  return tokens;
+}
+
+// returns the array index the token refers to. "-" refers to the position
+// after the last member, which is only valid if allowAppend is set
+ValueLength arrayIndex(std::string const& token, ValueLength length,
+                       bool allowAppend) {
+  if (allowAppend && token == "-") {
+    return length;
+  }
+  if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+    throw Exception(Exception::InvalidAttributePath,
+                    "Invalid array index in JSON pointer");
+  }
+  ValueLength index = 0;
+  for (char c : token) {
+    if (c < '0' || c > '9') {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Invalid array index in JSON pointer");
+    }
+    index = index * 10 + (c - '0');
+    if (index > length) {
+      throw Exception(Exception::IndexOutOfBounds);
+    }
+  }
+  if (index == length && !allowAppend) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  return index;
+}
+
+// returns the value the pointer tokens refer to
+Slice lookupPointer(Slice slice, std::vector<std::string> const& tokens) {
+  for (auto const& token : tokens) {
+    if (slice.isObject()) {
+      slice = slice.get(token);
+      if (slice.isNone()) {
+        throw Exception(Exception::InvalidAttributePath,
+                        "JSON pointer refers to a non-existing value");
+      }
+    } else if (slice.isArray()) {
+      slice = slice.at(::arrayIndex(token, slice.length(), false));
+    } else {
+      throw Exception(Exception::InvalidAttributePath,
+                      "JSON pointer traverses a non-compound value");
+    }
+  }
+  return slice;
+}
+
+// rebuilds current into builder with the action applied at the position
+// the tokens refer to. only the compound values along the path are
+// rebuilt, all other members are copied as raw bytes
+void patchPath(Builder& builder, Slice current,
+               std::vector<std::string> const& tokens, std::size_t depth,
+               PatchAction action, Slice value) {
+  std::string const& token = tokens[depth];
+  bool const isLast = (depth + 1 == tokens.size());
+
+  if (current.isObject()) {
+    bool found = false;
+    builder.openObject();
+    ObjectIterator it(current, true);
+    while (it.valid()) {
+      std::string_view key = it.key(true).stringView();
+      if (!found && key == token) {
+        found = true;
+        if (!isLast) {
+          builder.add(Value(key));
+          ::patchPath(builder, it.value(), tokens, depth + 1, action, value);
+        } else if (action != PatchAction::Remove) {
+          builder.add(key, value);
+        }
+      } else {
+        builder.add(key, it.value());
+      }
+      it.next();
+    }
+    if (!found) {
+      if (!isLast || action != PatchAction::Add) {
+        throw Exception(Exception::InvalidAttributePath,
+                        "JSON pointer refers to a non-existing value");
+      }
+      builder.add(token, value);
+    }
+    builder.close();
+  } else if (current.isArray()) {
+    ArrayIterator it(current);
+    ValueLength const index = ::arrayIndex(
+        token, it.size(), isLast && action == PatchAction::Add);
+    builder.openArray();
+    while (it.valid()) {
+      if (it.index() != index) {
+        builder.add(it.value());
+      } else if (!isLast) {
+        ::patchPath(builder, it.value(), tokens, depth + 1, action, value);
+      } else if (action == PatchAction::Add) {
+        builder.add(value);
+        builder.add(it.value());
+      } else if (action == PatchAction::Replace) {
+        builder.add(value);
+      }
+      it.next();
+    }
+    if (index == it.size()) {
+      // append
+      builder.add(value);
+    }
+    builder.close();
+  } else {
+    throw Exception(Exception::InvalidAttributePath,
+                    "JSON pointer traverses a non-compound value");
+  }
+}
+
+void patchPointer(Builder& builder, Slice current,
+                  std::vector<std::string> const& tokens, PatchAction action,
+                  Slice value) {
+  if (tokens.empty()) {
+    if (action == PatchAction::Remove) {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Cannot remove the whole document");
+    }
+    builder.add(value);
+    return;
+  }
+  ::patchPath(builder, current, tokens, 0, action, value);
+}
+
+Slice operationMember(Slice operation, std::string_view name) {
+  Slice value = operation.get(name);
+  if (value.isNone()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Patch operation misses a required attribute");
+  }
+  return value;
+}
+
+std::vector<std::string> operationPointer(Slice operation,
+                                          std::string_view name) {
+  Slice value = ::operationMember(operation, name);
+  if (!value.isString()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting JSON pointer to be a String");
+  }
+  return ::parsePointer(value.stringView());
+}
+
+// applies a single patch operation to current and writes the result into
+// builder. returns false if the operation did not modify current, in which
+// case nothing is written
+bool applyOperation(Builder& builder, Slice current, Slice operation) {
+  if (!operation.isObject()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting patch operation to be an Object");
+  }
+  Slice op = ::operationMember(operation, "op");
+  if (!op.isString()) {
+    throw Exception(Exception::InvalidValueType,
+                    "Expecting patch operation name to be a String");
+  }
+  std::string_view name = op.stringView();
+  std::vector<std::string> path = ::operationPointer(operation, "path");
+
+  if (name == "add") {
+    ::patchPointer(builder, current, path, PatchAction::Add,
+                   ::operationMember(operation, "value"));
+  } else if (name == "remove") {
+    ::patchPointer(builder, current, path, PatchAction::Remove, Slice());
+  } else if (name == "replace") {
+    ::patchPointer(builder, current, path, PatchAction::Replace,
+                   ::operationMember(operation, "value"));
+  } else if (name == "copy") {
+    Slice value = ::lookupPointer(current, ::operationPointer(operation, "from"));
+    ::patchPointer(builder, current, path, PatchAction::Add, value);
+  } else if (name == "move") {
+    std::vector<std::string> from = ::operationPointer(operation, "from");
+    if (from.size() < path.size() &&
+        std::equal(from.begin(), from.end(), path.begin())) {
+      throw Exception(Exception::InvalidAttributePath,
+                      "Cannot move a value into one of its children");
+    }
+    if (from == path) {
+      return false;
+    }
+    // value points into current, which stays valid while patching
+    Slice value = ::lookupPointer(current, from);
+    Builder removed;
+    ::patchPointer(removed, current, from, PatchAction::Remove, Slice());
+    ::patchPointer(builder, removed.slice(), path, PatchAction::Add, value);
+  } else if (name == "test") {
+    if (!NormalizedCompare::equals(::lookupPointer(current, path),
+                                   ::operationMember(operation, "value"))) {
+      throw Exception(Exception::PatchTestFailed);
+    }
+    return false;
+  } else {
+    throw Exception(Exception::InvalidValueType,
+                    "Unknown patch operation");
+  }
+  return true;
+}
+
+}  // namespace
+
+Builder Collection::mergePatch(Slice const& target, Slice const& patch) {
+  Builder b;
+  Collection::mergePatch(b, target, patch);
+  return b;
+}
+
+Builder& Collection::mergePatch(Builder& builder, Slice const& target,
+                                Slice const& patch) {
+  if (!patch.isObject()) {
+    builder.add(patch);
+    return builder;
+  }
+
+  builder.openObject();
+  bool const targetIsObject = target.isObject();
+  if (targetIsObject) {
+    ObjectIterator it(target, true);
+    while (it.valid()) {
+      std::string_view key = it.key(true).stringView();
+      Slice value = patch.get(key);
+      if (value.isNone()) {
+        // untouched by the patch
+        builder.add(key, it.value());
+      } else if (!value.isNull()) {
+        builder.add(Value(key));
+        Collection::mergePatch(builder, it.value(), value);
+      }
+      it.next();
+    }
+  }
+
+  // add remaining values that are only in the patch
+  ObjectIterator it(patch, true);
+  while (it.valid()) {
+    Slice value = it.value();
+    if (!value.isNull()) {
+      std::string_view key = it.key(true).stringView();
+      if (!targetIsObject || target.get(key).isNone()) {
+        builder.add(Value(key));
+        // merging into a non-Object strips null values from nested Objects
+        Collection::mergePatch(builder, Slice(), value);
+      }
+    }
+    it.next();
+  }
+  builder.close();
+  return builder;
+}
+
+Builder Collection::applyPatch(Slice const& target, Slice const& operations) {
+  if (!operations.isArray()) {
+    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  }
+
+  Builder result;
+  Builder next;
+  Slice current = target;
+  bool modified = false;
+
+  ArrayIterator it(operations);
+  while (it.valid()) {
+    next.clear();
+    if (::applyOperation(next, current, it.value())) {
+      // current may point into result, so swap only after patching
+      std::swap(result, next);
+      current = result.slice();
+      modified = true;
+    }
+    it.next();
+  }
+
+  if (!modified) {
+    result.add(target);
+  }
+  return result;
+}
+
+bool Collection::replaceInPlace(uint8_t* data, std::string_view pointer,
+                                Slice const& value) {
+  Slice target = ::lookupPointer(Slice(data), ::parsePointer(pointer));
+  ValueLength const size = target.byteSize();
+  if (size != value.byteSize()) {
+    return false;
+  }
+  std::memmove(data + (target.start() - data), value.start(),
+               checkOverflow(size));
+  return true;
+}
+
+bool Collection::replaceInPlace(Builder& builder, std::string_view pointer,
+                                Slice const& value) {
+  return Collection::replaceInPlace(builder.start(), pointer, value);
+}
+
+namespace {
+
+// appends an escaped reference token to a JSON pointer
+void appendPointerToken(std::string& pointer, std::string_view token) {
+  pointer.push_back('/');
+  for (char c : token) {
+    if (c == '~') {
+      pointer.append("~0");
+    } else if (c == '/') {
+      pointer.append("~1");
+    } else {
+      pointer.push_back(c);
+    }
+  }
+}
+
+void appendPointerIndex(std::string& pointer, ValueLength index) {
+  pointer.push_back('/');
+  pointer.append(std::to_string(index));
+}
+
+void addOperation(Builder& builder, std::string_view op,
+                  std::string const& path, Slice value) {
+  builder.openObject();
+  builder.add("op", Value(op));
+  builder.add("path", Value(path));
+  if (!value.isNone()) {
+    builder.add("value", value);
+  }
+  builder.close();
+}
+
+// byte-wise equality, which is the cheap check for unchanged subtrees
+bool sameBytes(Slice lhs, Slice rhs) {
+  ValueLength const size = lhs.byteSize();
+  return size == rhs.byteSize() &&
+         std::memcmp(lhs.start(), rhs.start(), checkOverflow(size)) == 0;
+}
+
+void diffValues(Builder& builder, Slice oldValue, Slice newValue,
+                std::string& path);
+
+void diffObjects(Builder& builder, Slice oldValue, Slice newValue,
+                 std::string& path) {
+  std::size_t const length = path.size();
+
+  ObjectIterator it(oldValue, true);
+  while (it.valid()) {
+    std::string_view key = it.key(true).stringView();
+    ::appendPointerToken(path, key);
+    Slice value = newValue.get(key);
+    if (value.isNone()) {
+      ::addOperation(builder, "remove", path, Slice());
+    } else {
+      ::diffValues(builder, it.value(), value, path);
+    }
+    path.resize(length);
+    it.next();
+  }
+
+  ObjectIterator it2(newValue, true);
+  while (it2.valid()) {
+    std::string_view key = it2.key(true).stringView();
+    if (oldValue.get(key).isNone()) {
+      ::appendPointerToken(path, key);
+      ::addOperation(builder, "add", path, it2.value());
+      path.resize(length);
+    }
+    it2.next();
+  }
+}
+
+void diffArrays(Builder& builder, Slice oldValue, Slice newValue,
+                std::string& path) {
+  std::size_t const length = path.size();
+
+  std::vector<Slice> oldMembers;
+  for (auto const& it : ArrayIterator(oldValue)) {
+    oldMembers.push_back(it);
+  }
+  std::vector<Slice> newMembers;
+  for (auto const& it : ArrayIterator(newValue)) {
+    newMembers.push_back(it);
+  }
+
+  // skip the unchanged head and tail, so that a single insertion or removal
+  // does not turn into replacements of all following members
+  std::size_t const n = std::min(oldMembers.size(), newMembers.size());
+  std::size_t head = 0;
+  while (head < n && ::sameBytes(oldMembers[head], newMembers[head])) {
+    ++head;
+  }
+  std::size_t tail = 0;
+  while (tail < n - head &&
+         ::sameBytes(oldMembers[oldMembers.size() - 1 - tail],
+                     newMembers[newMembers.size() - 1 - tail])) {
+    ++tail;
+  }
+
+  std::size_t const oldEnd = oldMembers.size() - tail;
+  std::size_t const newEnd = newMembers.size() - tail;
+  std::size_t i = head;
+  for (; i < oldEnd && i < newEnd; ++i) {
+    ::appendPointerIndex(path, i);
+    ::diffValues(builder, oldMembers[i], newMembers[i], path);
+    path.resize(length);
+  }
+  // each removal shifts the following members down, so all removals
+  // refer to the same index
+  for (std::size_t j = i; j < oldEnd; ++j) {
+    ::appendPointerIndex(path, i);
+    ::addOperation(builder, "remove", path, Slice());
+    path.resize(length);
+  }
+  for (; i < newEnd; ++i) {
+    ::appendPointerIndex(path, i);
+    ::addOperation(builder, "add", path, newMembers[i]);
+    path.resize(length);
+  }
+}
+
+void diffValues(Builder& builder, Slice oldValue, Slice newValue,
+                std::string& path) {
+  if (::sameBytes(oldValue, newValue)) {
+    return;
+  }
+  if (oldValue.isObject() && newValue.isObject()) {
+    ::diffObjects(builder, oldValue, newValue, path);
+  } else if (oldValue.isArray() && newValue.isArray()) {
+    ::diffArrays(builder, oldValue, newValue, path);
+  } else if (!NormalizedCompare::equals(oldValue, newValue)) {
+    ::addOperation(builder, "replace", path, newValue);
+  }
+}
+
+}  // namespace
+
+Builder Collection::diff(Slice const& oldValue, Slice const& newValue) {
+  Builder b;
+  Collection::diff(b, oldValue, newValue);
+  return b;
+}
+
+Builder& Collection::diff(Builder& builder, Slice const& oldValue,
+                          Slice const& newValue) {
+  std::string path;
+  builder.openArray();
+  ::diffValues(builder, oldValue, newValue, path);
+  builder.close();
+  return builder;
+}
+
+Builder Collection::distinct(Slice const& array) {
+  Builder b;
+  distinct(b, array);
+  return b;
+}
+
+Builder& Collection::distinct(Builder& builder, Slice const& array) {
+  ArrayIterator it(array);
+  ::SliceHashSet seen(checkOverflow(it.size()));
+
+  builder.openArray();
+  while (it.valid()) {
+    Slice s = it.value();
+    if (seen.insert(s).second) {
+      builder.add(s);
+    }
+    it.next();
+  }
+  builder.close();
+  return builder;
+}
+
+Builder Collection::groupBy(Slice const& array,
+                            std::function<Slice(Slice const&)> const& keyFunc) {
+  Builder b;
+  groupBy(b, array, keyFunc);
+  return b;
+}
+
+Builder& Collection::groupBy(Builder& builder, Slice const& array,
+                             std::function<Slice(Slice const&)> const& keyFunc) {
+  ArrayIterator it(array);
+  std::size_t const n = checkOverflow(it.size());
+  ::SliceHashSet groups(n);
+
+  // first pass: determine the group of each member, and the key and the
+  // number of members of each group
+  std::vector<Slice> members;
+  std::vector<std::size_t> memberGroups;
+  std::vector<Slice> keys;
+  std::vector<std::size_t> counts;
+  members.reserve(n);
+  memberGroups.reserve(n);
+
+  while (it.valid()) {
+    Slice s = it.value();
+    Slice key = keyFunc(s);
+    auto result = groups.insert(key);
+    if (result.second) {
+      keys.push_back(key);
+      counts.push_back(0);
+    }
+    ++counts[result.first];
+    members.push_back(s);
+    memberGroups.push_back(result.first);
+    it.next();
+  }
+
+  // second pass: order the members by group, keeping their original order
+  // inside each group
+  std::vector<std::size_t> offsets(keys.size() + 1, 0);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    offsets[i + 1] = offsets[i] + counts[i];
+  }
+  std::vector<Slice> ordered(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ordered[offsets[memberGroups[i]]++] = members[i];
+  }
+
+  builder.openArray();
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    builder.openArray();
+    builder.add(keys[i]);
+    builder.openArray();
+    for (std::size_t j = 0; j < counts[i]; ++j) {
+      builder.add(ordered[pos++]);
+    }
+    builder.close();
+    builder.close();
+  }
+  builder.close();
+  return builder;
+}
+
+Builder Collection::groupBy(Slice const& array, std::string_view attribute) {
+  return groupBy(array, [attribute](Slice const& s) {
+    if (s.isObject()) {
+      Slice value = s.get(attribute);
+      if (!value.isNone()) {
+        return value;
+      }
+    }
+    return Slice::nullSlice();
+  });
+}
+
 template <Collection::VisitationOrder order>
 static bool doVisit(
     Slice const& slice,
@@ -516,22 +1249,73 @@ void Collection::visitRecursive(
 Builder Collection::sort(
       Slice const& array,
       std::function<bool (Slice const&, Slice const&)> lessthan) {
-  if (!array.isArray()) {
-    throw Exception(Exception::InvalidValueType, "Expecting type Array");
+  std::vector<Slice> subValues = ::arrayMembers(array);
+  std::sort(subValues.begin(), subValues.end(), lessthan);
+  return ::buildArray(subValues);
+}
+
+Builder Collection::sortParallel(
+      Slice const& array,
+      std::function<bool (Slice const&, Slice const&)> lessthan,
+      std::size_t numThreads) {
+  std::vector<Slice> subValues = ::arrayMembers(array);
+
+  if (numThreads == 0) {
+    numThreads = (std::max)(1U, std::thread::hardware_concurrency());
   }
-  std::vector<Slice> subValues;
-  ValueLength len = array.length();
-  subValues.reserve(checkOverflow(len));
-  for (ValueLength i = 0; i < len; i++) {
-    subValues.push_back(array[i]);
+  numThreads = (std::min)(numThreads, subValues.size() / ::minParallelSortChunk);
+
+  if (numThreads <= 1) {
+    std::sort(subValues.begin(), subValues.end(), lessthan);
+    return ::buildArray(subValues);
   }
-  std::sort(subValues.begin(), subValues.end(), lessthan);
-  Builder b;
-  b.openArray();
-  for (auto const&s : subValues) {
-    b.add(s);
+
+  // split the members into one chunk per thread. chunk i covers the range
+  // [bounds[i], bounds[i + 1])
+  std::vector<std::size_t> bounds;
+  bounds.reserve(numThreads + 1);
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    bounds.push_back(i * subValues.size() / numThreads);
   }
-  b.close();
-  return b;
+  bounds.push_back(subValues.size());
+
+  auto first = subValues.begin();
+  ::ParallelTasks tasks(numThreads);
+
+  // sort all chunks in parallel
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    tasks.run([&, i]() {
+      std::sort(first + bounds[i], first + bounds[i + 1], lessthan);
+    });
+  }
+  tasks.wait();
+
+  // merge neighboring chunks pairwise, halving the number of chunks in
+  // each round. the merges of one round are independent of each other
+  while (bounds.size() > 2) {
+    std::vector<std::size_t> merged;
+    merged.reserve(bounds.size() / 2 + 1);
+    std::size_t i = 0;
+    for (; i + 2 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      tasks.run([&, i]() {
+        std::inplace_merge(first + bounds[i], first + bounds[i + 1],
+                           first + bounds[i + 2], lessthan);
+      });
+    }
+    if (i + 1 < bounds.size()) {
+      // odd number of chunks: the last one is carried over unmerged
+      merged.push_back(bounds[i]);
+    }
+    merged.push_back(bounds.back());
+    tasks.wait();
+    bounds = std::move(merged);
+  }
+
+  return ::buildArray(subValues);
 }
 
+
+Builder Collection::sort(Slice const& array) {
+  return sort(array, NormalizedCompare::Less());
+}
@@ -30,10 +30,204 @@
 #include "velocypack/Slice.h"
 #include "velocypack/ValueType.h"
 
+#include <algorithm>
 #include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace arangodb::velocypack;
 
+namespace {
+
+// ranks of the type groups in the total order, also used as the leading
+// byte of each value in a sort key. 0x00 is reserved as terminator for
+// Arrays and Objects inside sort keys, 0x01 as marker for Object members
+enum SortRank : uint8_t {
+  RankMinKey = 0x02,
+  RankNone = 0x03,
+  RankIllegal = 0x04,
+  RankNull = 0x05,
+  RankBool = 0x06,
+  RankNumber = 0x07,
+  RankUTCDate = 0x08,
+  RankString = 0x09,
+  RankBinary = 0x0a,
+  RankArray = 0x0b,
+  RankObject = 0x0c,
+  RankMaxKey = 0x0d
+};
+
+constexpr uint8_t sortKeyTerminator = 0x00;
+constexpr uint8_t sortKeyMember = 0x01;
+
+uint8_t sortRank(Slice slice) {
+  switch (slice.type()) {
+    case ValueType::MinKey:
+      return RankMinKey;
+    case ValueType::None:
+      return RankNone;
+    case ValueType::Illegal:
+      return RankIllegal;
+    case ValueType::Null:
+      return RankNull;
+    case ValueType::Bool:
+      return RankBool;
+    case ValueType::Double:
+    case ValueType::Int:
+    case ValueType::UInt:
+    case ValueType::SmallInt:
+      return RankNumber;
+    case ValueType::UTCDate:
+      return RankUTCDate;
+    case ValueType::String:
+      return RankString;
+    case ValueType::Binary:
+      return RankBinary;
+    case ValueType::Array:
+      return RankArray;
+    case ValueType::Object:
+      return RankObject;
+    case ValueType::MaxKey:
+      return RankMaxKey;
+    case ValueType::Custom:
+      throw Exception(Exception::NotImplemented, "compare for Custom type is not implemented");
+    case ValueType::BCD:
+      throw Exception(Exception::NotImplemented, "compare for BCD type is not implemented");
+    default:
+      throw Exception(Exception::InternalError, "invalid value type for compare");
+  }
+}
+
+// strips tags and resolves externals, so that only the actual value
+// takes part in comparisons
+Slice comparable(Slice slice) {
+  return slice.resolveExternals().value().resolveExternals();
+}
+
+// a number is represented by its value rounded to double, plus the
+// (small) difference between its exact integer value and the rounded
+// double. ordering by (double, residue) is the exact numeric order
+struct NumberKey {
+  uint64_t bits;
+  int64_t residue;
+};
+
+// maps the bits of a double to an unsigned value with the same order.
+// -0.0 is folded into 0.0, and all NaNs sort after +Infinity
+uint64_t orderedDoubleBits(double v) noexcept {
+  if (v == 0.0) {
+    v = 0.0;
+  }
+  uint64_t bits;
+  if (v != v) {
+    bits = 0x7ff8000000000000ULL;
+  } else {
+    std::memcpy(&bits, &v, sizeof(double));
+  }
+  if (bits & 0x8000000000000000ULL) {
+    return ~bits;
+  }
+  return bits | 0x8000000000000000ULL;
+}
+
+NumberKey unsignedNumberKey(uint64_t v) noexcept {
+  double d = static_cast<double>(v);
+  int64_t residue;
+  if (d >= 18446744073709551616.0) {
+    // rounded up to 2^64
+    residue = -static_cast<int64_t>(uint64_t(0) - v);
+  } else {
+    residue = static_cast<int64_t>(v - static_cast<uint64_t>(d));
+  }
+  return NumberKey{orderedDoubleBits(d), residue};
+}
+
+NumberKey numberKey(Slice slice) {
+  switch (slice.type()) {
+    case ValueType::Double:
+      return NumberKey{orderedDoubleBits(slice.getDouble()), 0};
+    case ValueType::UInt:
+      return unsignedNumberKey(slice.getUIntUnchecked());
+    default: {
+      int64_t v = slice.getIntUnchecked();
+      if (v >= 0) {
+        return unsignedNumberKey(static_cast<uint64_t>(v));
+      }
+      // all negative int64 values round to doubles inside the int64 range
+      double d = static_cast<double>(v);
+      return NumberKey{orderedDoubleBits(d), v - static_cast<int64_t>(d)};
+    }
+  }
+}
+
+template<typename T>
+int compareValues(T lhs, T rhs) noexcept {
+  return (lhs < rhs) ? -1 : ((rhs < lhs) ? 1 : 0);
+}
+
+int compareBytes(std::string_view lhs, std::string_view rhs) noexcept {
+  std::size_t const n = (std::min)(lhs.size(), rhs.size());
+  int res = std::memcmp(lhs.data(), rhs.data(), n);
+  if (res != 0) {
+    return res < 0 ? -1 : 1;
+  }
+  return compareValues(lhs.size(), rhs.size());
+}
+
+std::string_view binaryView(Slice slice) {
+  ValueLength length;
+  uint8_t const* p = slice.getBinary(length);
+  return std::string_view(reinterpret_cast<char const*>(p), checkOverflow(length));
+}
+
+// collects the members of an Object in attribute name order
+void sortedMembers(Slice slice, std::vector<std::pair<std::string_view, Slice>>& members) {
+  ObjectIterator it(slice, !slice.isSorted());
+  members.reserve(checkOverflow(it.size()));
+  while (it.valid()) {
+    auto current = (*it);
+    members.emplace_back(current.key.stringView(), current.value);
+    it.next();
+  }
+  if (!slice.isSorted()) {
+    std::sort(members.begin(), members.end(), [](auto const& a, auto const& b) {
+      return compareBytes(a.first, b.first) < 0;
+    });
+  }
+}
+
+void appendBigEndian(std::string& out, uint64_t v) {
+  char buffer[8];
+  for (int i = 7; i >= 0; --i) {
+    buffer[i] = static_cast<char>(v & 0xff);
+    v >>= 8;
+  }
+  out.append(buffer, sizeof(buffer));
+}
+
+// appends the bytes so that no encoded sequence is a prefix of another one:
+// 0x00 bytes are escaped as 0x00 0xff, and the sequence ends with 0x00 0x00
+void appendEscaped(std::string& out, std::string_view value) {
+  char const* p = value.data();
+  char const* e = p + value.size();
+  while (p < e) {
+    char const* zero = static_cast<char const*>(std::memchr(p, '\0', e - p));
+    if (zero == nullptr) {
+      out.append(p, e - p);
+      break;
+    }
+    out.append(p, zero - p);
+    out.push_back('\x00');
+    out.push_back('\xff');
+    p = zero + 1;
+  }
+  out.push_back('\x00');
+  out.push_back('\x00');
+}
+
+} // namespace
+
 bool BinaryCompare::equals(Slice lhs, Slice rhs) {
   return lhs.binaryEquals(rhs);
 }
@@ -157,3 +351,150 @@ bool NormalizedCompare::Equal::operator()(arangodb::velocypack::Slice const& lhs
                                           arangodb::velocypack::Slice const& rhs) const {
   return NormalizedCompare::equals(lhs, rhs);
 }
+
+bool NormalizedCompare::Less::operator()(arangodb::velocypack::Slice const& lhs,
+                                         arangodb::velocypack::Slice const& rhs) const {
+  return NormalizedCompare::compare(lhs, rhs) < 0;
+}
+
+int NormalizedCompare::compare(Slice lhs, Slice rhs) {
+  lhs = ::comparable(lhs);
+  rhs = ::comparable(rhs);
+
+  uint8_t const lhsRank = ::sortRank(lhs);
+  uint8_t const rhsRank = ::sortRank(rhs);
+
+  if (lhsRank != rhsRank) {
+    return lhsRank < rhsRank ? -1 : 1;
+  }
+
+  switch (lhsRank) {
+    case RankBool: {
+      return ::compareValues(lhs.getBoolean(), rhs.getBoolean());
+    }
+    case RankNumber: {
+      if (lhs.isDouble() && rhs.isDouble()) {
+        return ::compareValues(::orderedDoubleBits(lhs.getDouble()),
+                               ::orderedDoubleBits(rhs.getDouble()));
+      }
+      ::NumberKey l = ::numberKey(lhs);
+      ::NumberKey r = ::numberKey(rhs);
+      int res = ::compareValues(l.bits, r.bits);
+      if (res == 0) {
+        res = ::compareValues(l.residue, r.residue);
+      }
+      return res;
+    }
+    case RankUTCDate: {
+      return ::compareValues(lhs.getUTCDate(), rhs.getUTCDate());
+    }
+    case RankString: {
+      return ::compareBytes(lhs.stringView(), rhs.stringView());
+    }
+    case RankBinary: {
+      return ::compareBytes(::binaryView(lhs), ::binaryView(rhs));
+    }
+    case RankArray: {
+      ArrayIterator lhsValue(lhs);
+      ArrayIterator rhsValue(rhs);
+
+      while (lhsValue.valid() && rhsValue.valid()) {
+        // recurse
+        int res = compare(lhsValue.value(), rhsValue.value());
+        if (res != 0) {
+          return res;
+        }
+        lhsValue.next();
+        rhsValue.next();
+      }
+      return ::compareValues(lhsValue.size(), rhsValue.size());
+    }
+    case RankObject: {
+      std::vector<std::pair<std::string_view, Slice>> lhsMembers;
+      std::vector<std::pair<std::string_view, Slice>> rhsMembers;
+      ::sortedMembers(lhs, lhsMembers);
+      ::sortedMembers(rhs, rhsMembers);
+
+      std::size_t const n = (std::min)(lhsMembers.size(), rhsMembers.size());
+      for (std::size_t i = 0; i < n; ++i) {
+        int res = ::compareBytes(lhsMembers[i].first, rhsMembers[i].first);
+        if (res == 0) {
+          // recurse
+          res = compare(lhsMembers[i].second, rhsMembers[i].second);
+        }
+        if (res != 0) {
+          return res;
+        }
+      }
+      return ::compareValues(lhsMembers.size(), rhsMembers.size());
+    }
+    default: {
+      // all other type groups consist of a single value only
+      return 0;
+    }
+  }
+}
+
+void NormalizedCompare::sortKey(Slice slice, std::string& out) {
+  slice = ::comparable(slice);
+  uint8_t const rank = ::sortRank(slice);
+
+  out.push_back(static_cast<char>(rank));
+
+  switch (rank) {
+    case RankBool: {
+      out.push_back(slice.getBoolean() ? '\x01' : '\x00');
+      break;
+    }
+    case RankNumber: {
+      ::NumberKey key = ::numberKey(slice);
+      ::appendBigEndian(out, key.bits);
+      ::appendBigEndian(out, static_cast<uint64_t>(key.residue) ^ 0x8000000000000000ULL);
+      break;
+    }
+    case RankUTCDate: {
+      ::appendBigEndian(out, static_cast<uint64_t>(slice.getUTCDate()) ^ 0x8000000000000000ULL);
+      break;
+    }
+    case RankString: {
+      ::appendEscaped(out, slice.stringView());
+      break;
+    }
+    case RankBinary: {
+      ::appendEscaped(out, ::binaryView(slice));
+      break;
+    }
+    case RankArray: {
+      ArrayIterator it(slice);
+      while (it.valid()) {
+        // recurse
+        sortKey(it.value(), out);
+        it.next();
+      }
+      out.push_back(static_cast<char>(::sortKeyTerminator));
+      break;
+    }
+    case RankObject: {
+      std::vector<std::pair<std::string_view, Slice>> members;
+      ::sortedMembers(slice, members);
+      for (auto const& it : members) {
+        out.push_back(static_cast<char>(::sortKeyMember));
+        ::appendEscaped(out, it.first);
+        // recurse
+        sortKey(it.second, out);
+      }
+      out.push_back(static_cast<char>(::sortKeyTerminator));
+      break;
+    }
+    default: {
+      // the rank alone identifies the value
+      break;
+    }
+  }
+}
+
+std::string NormalizedCompare::sortKey(Slice slice) {
+  std::string out;
+  sortKey(slice, out);
+  return out;
+}
@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Compression.h"
+#include "velocypack/Exception.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// parameters of the LZ4 block format
+constexpr std::size_t minMatch = 4;
+// the last 5 bytes are always literals
+constexpr std::size_t lastLiterals = 5;
+// the last match must start at least 12 bytes before the end
+constexpr std::size_t matchFindLimit = 12;
+constexpr std::size_t maxOffset = 65535;
+
+constexpr unsigned hashLog = 12;
+
+inline uint32_t read32(uint8_t const* p) noexcept {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint32_t hash32(uint8_t const* p) noexcept {
+  return (read32(p) * 2654435761U) >> (32 - hashLog);
+}
+
+// writes the continuation bytes of a length that did not fit into the
+// 4 bits of the token
+inline uint8_t* writeLength(uint8_t* op, std::size_t length) noexcept {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = static_cast<uint8_t>(length);
+  return op;
+}
+
+// writes the token and the literals of a sequence and returns the token
+inline uint8_t* writeLiterals(uint8_t*& op, uint8_t const* literals,
+                              std::size_t length) noexcept {
+  uint8_t* token = op++;
+  if (length >= 15) {
+    *token = 15 << 4;
+    op = ::writeLength(op, length - 15);
+  } else {
+    *token = static_cast<uint8_t>(length << 4);
+  }
+  std::memcpy(op, literals, length);
+  op += length;
+  return token;
+}
+
+// reads the continuation bytes of a length from the token
+inline std::size_t readLength(uint8_t const*& ip, uint8_t const* end,
+                              std::size_t length) {
+  if (length == 15) {
+    uint8_t b;
+    do {
+      if (ip >= end) {
+        throw Exception(Exception::ValidatorInvalidLength,
+                        "compressed data is truncated");
+      }
+      b = *ip++;
+      length += b;
+    } while (b == 255);
+  }
+  return length;
+}
+
+}  // namespace
+
+std::size_t BlockCodec::compress(uint8_t const* data, std::size_t size,
+                                 Buffer<uint8_t>& out) {
+  out.reserve(maxCompressedSize(size));
+  uint8_t* const start = out.data() + out.size();
+  uint8_t* op = start;
+
+  uint8_t const* const end = data + size;
+  uint8_t const* anchor = data;
+
+  if (size > matchFindLimit) {
+    // position of the last occurrence of each 4 byte sequence, by hash
+    uint32_t table[1 << hashLog];
+    std::memset(&table[0], 0, sizeof(table));
+
+    uint8_t const* const matchLimit = end - lastLiterals;
+    uint8_t const* const searchLimit = end - matchFindLimit;
+    uint8_t const* ip = data + 1;
+
+    while (ip <= searchLimit) {
+      uint32_t const h = ::hash32(ip);
+      uint8_t const* match = data + table[h];
+      table[h] = static_cast<uint32_t>(ip - data);
+
+      if (static_cast<std::size_t>(ip - match) > maxOffset ||
+          ::read32(match) != ::read32(ip)) {
+        // step faster through data that does not compress
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      while (ip > anchor && match > data && ip[-1] == match[-1]) {
+        --ip;
+        --match;
+      }
+      std::size_t length = minMatch;
+      while (ip + length < matchLimit && ip[length] == match[length]) {
+        ++length;
+      }
+
+      uint8_t* token =
+          ::writeLiterals(op, anchor, static_cast<std::size_t>(ip - anchor));
+      std::size_t const offset = static_cast<std::size_t>(ip - match);
+      *op++ = static_cast<uint8_t>(offset & 0xffU);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+      length -= minMatch;
+      if (length >= 15) {
+        *token |= 15;
+        op = ::writeLength(op, length - 15);
+      } else {
+        *token |= static_cast<uint8_t>(length);
+      }
+
+      ip += length + minMatch;
+      anchor = ip;
+      if (ip <= searchLimit) {
+        table[::hash32(ip - 2)] = static_cast<uint32_t>(ip - 2 - data);
+      }
+    }
+  }
+
+  ::writeLiterals(op, anchor, static_cast<std::size_t>(end - anchor));
+
+  std::size_t const written = static_cast<std::size_t>(op - start);
+  out.advance(written);
+  return written;
+}
+
+void BlockCodec::decompress(uint8_t const* data, std::size_t size, uint8_t* out,
+                            std::size_t originalSize) {
+  uint8_t const* ip = data;
+  uint8_t const* const end = data + size;
+  uint8_t* op = out;
+  uint8_t* const outEnd = out + originalSize;
+
+  while (true) {
+    if (ip >= end) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "compressed data is truncated");
+    }
+    uint8_t const token = *ip++;
+
+    std::size_t const literals = ::readLength(ip, end, token >> 4);
+    if (literals > static_cast<std::size_t>(end - ip) ||
+        literals > static_cast<std::size_t>(outEnd - op)) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "invalid literal length in compressed data");
+    }
+    std::memcpy(op, ip, literals);
+    ip += literals;
+    op += literals;
+
+    if (ip == end) {
+      // the last sequence consists of literals only
+      break;
+    }
+
+    if (end - ip < 2) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "compressed data is truncated");
+    }
+    std::size_t const offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<std::size_t>(op - out)) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "invalid match offset in compressed data");
+    }
+
+    std::size_t const length = ::readLength(ip, end, token & 15) + minMatch;
+    if (length > static_cast<std::size_t>(outEnd - op)) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "invalid match length in compressed data");
+    }
+    uint8_t const* match = op - offset;
+    if (offset >= length) {
+      std::memcpy(op, match, length);
+      op += length;
+    } else {
+      // overlapping match, repeating the last offset bytes
+      for (std::size_t i = 0; i < length; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  if (op != outEnd) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "compressed data does not match the original size");
+  }
+}
+
+void BlockCodec::decompress(uint8_t const* data, std::size_t size,
+                            Buffer<uint8_t>& out, std::size_t originalSize) {
+  out.reserve(originalSize);
+  decompress(data, size, out.data() + out.size(), originalSize);
+  out.advance(originalSize);
+}
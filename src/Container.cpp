@@ -0,0 +1,413 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Compression.h"
+#include "velocypack/Container.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Validator.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// number of bits per value and number of probes of the Bloom filters
+constexpr std::size_t bloomBitsPerValue = 10;
+constexpr std::size_t bloomProbes = 6;
+
+// calls func for each bit position of hash in a Bloom filter with the
+// specified number of bits, using double hashing
+template <typename F>
+void bloomPositions(uint64_t hash, std::size_t bits, F&& func) {
+  uint64_t const delta = ((hash >> 32) | (hash << 32)) | 1;
+  for (std::size_t i = 0; i < bloomProbes; ++i) {
+    func(static_cast<std::size_t>(hash % bits));
+    hash += delta;
+  }
+}
+
+void appendUInt32(Buffer<uint8_t>& buffer, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    buffer.push_back(static_cast<uint8_t>(value & 0xffU));
+    value >>= 8;
+  }
+}
+
+std::size_t readSize(Slice block, std::string_view name) {
+  Slice value = block.get(name);
+  if (!value.isInteger()) {
+    throw Exception(Exception::ValidatorInvalidType,
+                    "invalid container block index");
+  }
+  return checkOverflow(value.getUInt());
+}
+
+}  // namespace
+
+ContainerWriter::ContainerWriter(Sink* sink, std::string attribute,
+                                 std::size_t blockSize, bool compress)
+    : _sink(sink),
+      _attribute(std::move(attribute)),
+      _blockSize(blockSize),
+      _compress(compress),
+      _blockCount(0),
+      _written(0),
+      _count(0),
+      _finished(false) {
+  _sink->append(ContainerFormat::magic, ContainerFormat::magicSize);
+  _written += ContainerFormat::magicSize;
+  _blocks.openArray();
+}
+
+void ContainerWriter::add(Slice value) {
+  if (_finished) {
+    throw Exception(Exception::InternalError, "ContainerWriter is already finished");
+  }
+
+  ValueLength const size = value.byteSize();
+  // offsets within a block are stored as 4 byte numbers
+  if (_block.size() > UINT32_MAX) {
+    flushBlock();
+  }
+
+  ::appendUInt32(_offsets, static_cast<uint32_t>(_block.size()));
+  _block.append(value.start(), size);
+
+  if (!_attribute.empty() && value.isObject()) {
+    Slice a = value.get(_attribute);
+    if (!a.isNone()) {
+      if (_min.isEmpty() || NormalizedCompare::compare(a, _min.slice()) < 0) {
+        _min.clear();
+        _min.add(a);
+      }
+      if (_max.isEmpty() || NormalizedCompare::compare(a, _max.slice()) > 0) {
+        _max.clear();
+        _max.add(a);
+      }
+      _hashes.push_back(a.normalizedHash());
+    }
+  }
+
+  ++_blockCount;
+  ++_count;
+
+  if (_block.size() >= _blockSize) {
+    flushBlock();
+  }
+}
+
+void ContainerWriter::finish() {
+  if (_finished) {
+    throw Exception(Exception::InternalError, "ContainerWriter is already finished");
+  }
+
+  flushBlock();
+  _blocks.close();
+
+  Builder footer;
+  footer.openObject();
+  footer.add("count", Value(_count));
+  if (_attribute.empty()) {
+    footer.add("attribute", Value(ValueType::Null));
+  } else {
+    footer.add("attribute", Value(_attribute));
+  }
+  footer.add("blocks", _blocks.slice());
+  footer.add("offsets", ValuePair(_offsets.data(), _offsets.size(), ValueType::Binary));
+  footer.close();
+
+  uint8_t trailer[ContainerFormat::trailerSize];
+  storeUInt64(&trailer[0], _written);
+  std::memcpy(&trailer[8], ContainerFormat::magic, ContainerFormat::magicSize);
+
+  _sink->append(reinterpret_cast<char const*>(footer.start()), footer.size());
+  _sink->append(reinterpret_cast<char const*>(&trailer[0]), sizeof(trailer));
+  _written += footer.size() + sizeof(trailer);
+  _finished = true;
+}
+
+void ContainerWriter::flushBlock() {
+  if (_blockCount == 0) {
+    return;
+  }
+
+  uint8_t const* data = _block.data();
+  std::size_t size = _block.size();
+  if (_compress) {
+    _compressed.clear();
+    std::size_t compressed = BlockCodec::compress(_block.data(), _block.size(), _compressed);
+    if (compressed < _block.size()) {
+      data = _compressed.data();
+      size = compressed;
+    }
+  }
+
+  _blocks.openObject();
+  _blocks.add("offset", Value(_written));
+  _blocks.add("size", Value(size));
+  if (data != _block.data()) {
+    _blocks.add("rawSize", Value(_block.size()));
+  }
+  _blocks.add("first", Value(_count - _blockCount));
+  _blocks.add("count", Value(_blockCount));
+  if (!_hashes.empty()) {
+    _blocks.add("min", _min.slice());
+    _blocks.add("max", _max.slice());
+
+    std::size_t const bits =
+        (std::max)(std::size_t(64), _hashes.size() * bloomBitsPerValue + 7) & ~std::size_t(7);
+    std::vector<uint8_t> bloom(bits / 8, 0);
+    for (uint64_t hash : _hashes) {
+      ::bloomPositions(hash, bits, [&bloom](std::size_t bit) {
+        bloom[bit / 8] |= static_cast<uint8_t>(1U << (bit % 8));
+      });
+    }
+    _blocks.add("bloom", ValuePair(bloom.data(), bloom.size(), ValueType::Binary));
+  }
+  _blocks.close();
+
+  _sink->append(reinterpret_cast<char const*>(data), size);
+  _written += size;
+
+  _block.clear();
+  _blockCount = 0;
+  _min.clear();
+  _max.clear();
+  _hashes.clear();
+}
+
+struct ContainerReader::DecompressedBlock {
+  std::once_flag once;
+  Buffer<uint8_t> data;
+};
+
+ContainerReader::ContainerReader(uint8_t const* data, std::size_t size)
+    : _data(data), _count(0), _offsets(nullptr) {
+  if (size < ContainerFormat::magicSize + ContainerFormat::trailerSize ||
+      std::memcmp(data, ContainerFormat::magic, ContainerFormat::magicSize) != 0 ||
+      std::memcmp(data + size - ContainerFormat::magicSize,
+                  ContainerFormat::magic, ContainerFormat::magicSize) != 0) {
+    throw Exception(Exception::ValidatorInvalidType, "not a VPack container");
+  }
+
+  std::size_t const footerEnd = size - ContainerFormat::trailerSize;
+  uint64_t const footerOffset = readUInt64(data + footerEnd);
+  if (footerOffset < ContainerFormat::magicSize || footerOffset >= footerEnd) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "invalid container footer offset");
+  }
+
+  Validator validator;
+  validator.validate(data + footerOffset, footerEnd - footerOffset);
+  Slice footer(data + footerOffset);
+  Slice count = footer.get("count");
+  Slice attribute = footer.get("attribute");
+  Slice blocks = footer.get("blocks");
+  Slice offsets = footer.get("offsets");
+  if (!footer.isObject() || !count.isInteger() ||
+      !(attribute.isString() || attribute.isNull()) || !blocks.isArray() ||
+      !offsets.isBinary()) {
+    throw Exception(Exception::ValidatorInvalidType, "invalid container footer");
+  }
+
+  _count = checkOverflow(count.getUInt());
+  if (attribute.isString()) {
+    _attribute = attribute.stringView();
+  }
+
+  ValueLength offsetsLength;
+  _offsets = offsets.getBinary(offsetsLength);
+  if (offsetsLength != 4 * static_cast<ValueLength>(_count)) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "invalid container offsets");
+  }
+
+  std::size_t first = 0;
+  for (auto const& it : ArrayIterator(blocks)) {
+    if (!it.isObject()) {
+      throw Exception(Exception::ValidatorInvalidType,
+                      "invalid container block index");
+    }
+    Block block;
+    block.offset = ::readSize(it, "offset");
+    block.size = ::readSize(it, "size");
+    block.compressed = !it.get("rawSize").isNone();
+    block.rawSize = block.compressed ? ::readSize(it, "rawSize") : block.size;
+    block.first = ::readSize(it, "first");
+    block.count = ::readSize(it, "count");
+    block.min = it.get("min");
+    block.max = it.get("max");
+    block.bloom = it.get("bloom");
+    if (block.offset < ContainerFormat::magicSize ||
+        block.offset > footerOffset ||
+        block.size > footerOffset - block.offset ||
+        block.first != first || block.count > _count - first ||
+        block.min.isNone() != block.max.isNone() ||
+        !(block.bloom.isNone() || block.bloom.isBinary())) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "invalid container block index");
+    }
+    first += block.count;
+    _blocks.push_back(block);
+  }
+  if (first != _count) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "invalid container block index");
+  }
+
+  _decompressed = std::make_unique<DecompressedBlock[]>(_blocks.size());
+}
+
+ContainerReader::~ContainerReader() = default;
+
+Slice ContainerReader::at(std::size_t index) const {
+  if (index >= _count) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  std::size_t const block = blockOf(index);
+  uint32_t const offset = readIntegerFixed<uint32_t, 4>(_offsets + 4 * index);
+  if (offset >= _blocks[block].rawSize) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "invalid container value offset");
+  }
+  return Slice(blockData(block) + offset);
+}
+
+std::size_t ContainerReader::blockOf(std::size_t index) const {
+  if (index >= _count) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  auto it = std::upper_bound(_blocks.begin(), _blocks.end(), index,
+                             [](std::size_t value, Block const& block) {
+                               return value < block.first;
+                             });
+  return static_cast<std::size_t>(it - _blocks.begin()) - 1;
+}
+
+bool ContainerReader::mayContain(std::size_t block, Slice value) const {
+  if (_attribute.empty()) {
+    return true;
+  }
+
+  Block const& b = _blocks.at(block);
+  if (b.min.isNone()) {
+    // no value in the block has the attribute
+    return false;
+  }
+  if (NormalizedCompare::compare(value, b.min) < 0 ||
+      NormalizedCompare::compare(value, b.max) > 0) {
+    return false;
+  }
+  if (b.bloom.isBinary()) {
+    ValueLength length;
+    uint8_t const* bloom = b.bloom.getBinary(length);
+    if (length == 0) {
+      return true;
+    }
+    bool found = true;
+    ::bloomPositions(value.normalizedHash(), checkOverflow(length) * 8,
+                     [bloom, &found](std::size_t bit) {
+                       if ((bloom[bit / 8] & (1U << (bit % 8))) == 0) {
+                         found = false;
+                       }
+                     });
+    return found;
+  }
+  return true;
+}
+
+void ContainerReader::forEach(std::function<bool(Block const&)> const& blockFilter,
+                              std::function<bool(Slice)> const& callback) const {
+  for (std::size_t i = 0; i < _blocks.size(); ++i) {
+    if (blockFilter(_blocks[i]) && !visitBlock(i, callback)) {
+      return;
+    }
+  }
+}
+
+void ContainerReader::find(Slice value,
+                           std::function<bool(Slice)> const& callback) const {
+  if (_attribute.empty()) {
+    throw Exception(Exception::InternalError,
+                    "container does not have an indexed attribute");
+  }
+
+  for (std::size_t i = 0; i < _blocks.size(); ++i) {
+    if (!mayContain(i, value)) {
+      continue;
+    }
+    bool const goOn = visitBlock(i, [&](Slice current) {
+      if (current.isObject() &&
+          NormalizedCompare::equals(current.get(_attribute), value)) {
+        return callback(current);
+      }
+      return true;
+    });
+    if (!goOn) {
+      return;
+    }
+  }
+}
+
+uint8_t const* ContainerReader::blockData(std::size_t block) const {
+  Block const& b = _blocks[block];
+  if (!b.compressed) {
+    return _data + b.offset;
+  }
+  DecompressedBlock& d = _decompressed[block];
+  std::call_once(d.once, [this, &b, &d]() {
+    BlockCodec::decompress(_data + b.offset, b.size, d.data, b.rawSize);
+  });
+  return d.data.data();
+}
+
+bool ContainerReader::visitBlock(std::size_t block,
+                                 std::function<bool(Slice)> const& callback) const {
+  Block const& b = _blocks[block];
+  uint8_t const* data = _data + b.offset;
+  Buffer<uint8_t> decompressed;
+  if (b.compressed) {
+    BlockCodec::decompress(data, b.size, decompressed, b.rawSize);
+    data = decompressed.data();
+  }
+
+  for (std::size_t i = b.first; i < b.first + b.count; ++i) {
+    uint32_t const offset = readIntegerFixed<uint32_t, 4>(_offsets + 4 * i);
+    if (offset >= b.rawSize) {
+      throw Exception(Exception::ValidatorInvalidLength,
+                      "invalid container value offset");
+    }
+    if (!callback(Slice(data + offset))) {
+      return false;
+    }
+  }
+  return true;
+}
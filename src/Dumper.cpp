@@ -30,6 +30,7 @@
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
 #include "velocypack/Sink.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/ValueType.h"
 
 using namespace arangodb::velocypack;
@@ -54,6 +55,10 @@ Dumper::Dumper(Sink* sink, Options const* options)
 }
   
 void Dumper::dump(Slice const& slice) {
+  VELOCYPACK_STATISTICS_ADD(DumpCalls, 1);
+  VELOCYPACK_STATISTICS_ADD(DumpedBytes, slice.byteSize());
+  VELOCYPACK_STATISTICS_TIMER(DumpNanos);
+
   _indentation = 0;
   _sink->reserve(slice.byteSize());
   dumpValue(&slice);
@@ -385,6 +390,12 @@ void Dumper::dumpValue(Slice const* slice, Slice const* base) {
     VELOCYPACK_ASSERT(base != nullptr);
   }
 
+  if (VELOCYPACK_UNLIKELY(slice->isStringReference())) {
+    Slice const resolved = slice->resolveStringReference();
+    dumpValue(&resolved, base);
+    return;
+  }
+
   if (options->debugTags && slice->isTagged()) {
     _sink->append(std::to_string(slice->getFirstTag()));
     _sink->push_back(':');
@@ -66,6 +66,12 @@ char const* Exception::message(ExceptionType type) noexcept {
       return "Key not found";
     case BadTupleSize:
       return "Array size does not match tuple size";
+    case PatchTestFailed:
+      return "Patch test operation failed";
+    case BufferCapacityExceeded:
+      return "Buffer capacity exceeded";
+    case InvalidQuery:
+      return "Invalid query expression";
     case BuilderNotSealed:
       return "Builder value not yet sealed";
     case BuilderNeedOpenObject:
@@ -92,6 +98,8 @@ char const* Exception::message(ExceptionType type) noexcept {
       return "Tagged types are not allowed in this configuration";
     case BuilderBCDDisallowed:
       return "BCD types are not allowed in this configuration";
+    case BuilderInvalidSavepoint:
+      return "Savepoint is not valid for the current Builder state";
   
     case ValidatorInvalidType:
       return "Invalid type found in binary data";
@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <queue>
+
+#include "velocypack/ExternalSorter.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// counter for generating unique run file names
+std::atomic<uint64_t> runFileCounter{0};
+
+// size of the chunks read from run files
+constexpr std::size_t runReadChunkSize = 64 * 1024;
+
+// sequential reader for a run file, which contains concatenated VPack values
+class RunReader {
+ public:
+  explicit RunReader(std::string const& filename)
+      : _stream(filename, std::ios::in | std::ios::binary), _pos(0), _currentSize(0), _eof(false) {
+    if (!_stream.is_open()) {
+      throw Exception(Exception::InternalError, "cannot open sort run file");
+    }
+  }
+
+  // read the next value from the run. returns false at the end of the run.
+  // the returned Slice is valid until the next call
+  bool next(Slice& value) {
+    // drop the previous value
+    _pos += _currentSize;
+    _currentSize = 0;
+
+    if (!fill(1)) {
+      return false;
+    }
+    // skip over tags to find the actual head byte
+    std::size_t headerSize = 0;
+    while (true) {
+      uint8_t h = _buffer[_pos + headerSize];
+      if (h == 0xee) {
+        headerSize += 2;
+      } else if (h == 0xef) {
+        headerSize += 9;
+      } else {
+        break;
+      }
+      if (!fill(headerSize + 1)) {
+        throw Exception(Exception::InternalError, "truncated sort run file");
+      }
+    }
+    // the byte length of any value is contained in its first 9 bytes
+    fill(headerSize + 9);
+
+    ValueLength size = Slice(_buffer.data() + _pos).byteSize();
+    if (!fill(checkOverflow(size))) {
+      throw Exception(Exception::InternalError, "truncated sort run file");
+    }
+    _currentSize = checkOverflow(size);
+    value = Slice(_buffer.data() + _pos);
+    return true;
+  }
+
+ private:
+  // make sure that at least n bytes are buffered after _pos. returns false
+  // if the end of the file is reached before
+  bool fill(std::size_t n) {
+    while (_buffer.size() - _pos < n) {
+      if (_eof) {
+        return false;
+      }
+      if (_pos > 0) {
+        // discard consumed data
+        _buffer.erase(_buffer.begin(), _buffer.begin() + _pos);
+        _pos = 0;
+      }
+      std::size_t const old = _buffer.size();
+      std::size_t const chunk = (std::max)(runReadChunkSize, n - old);
+      _buffer.resize(old + chunk);
+      _stream.read(reinterpret_cast<char*>(_buffer.data() + old), chunk);
+      std::size_t const read = static_cast<std::size_t>(_stream.gcount());
+      _buffer.resize(old + read);
+      if (read < chunk) {
+        _eof = true;
+      }
+    }
+    return true;
+  }
+
+  std::ifstream _stream;
+  std::vector<uint8_t> _buffer;
+  std::size_t _pos;
+  std::size_t _currentSize;
+  bool _eof;
+};
+
+} // namespace
+
+ExternalSorter::ExternalSorter(std::string tempDirectory, ValueLength memoryLimit,
+                               LessThan lessthan)
+    : _tempDirectory(std::move(tempDirectory)),
+      _memoryLimit(memoryLimit),
+      _lessthan(std::move(lessthan)),
+      _count(0),
+      _finished(false) {
+  if (!_lessthan) {
+    _lessthan = NormalizedCompare::Less();
+  }
+}
+
+ExternalSorter::~ExternalSorter() {
+  for (auto const& run : _runs) {
+    std::remove(run.c_str());
+  }
+}
+
+void ExternalSorter::add(Slice value) {
+  if (VELOCYPACK_UNLIKELY(_finished)) {
+    throw Exception(Exception::InternalError, "ExternalSorter is already finished");
+  }
+  ValueLength const size = value.byteSize();
+  if (!_offsets.empty() && _data.size() + size > _memoryLimit) {
+    spill();
+  }
+  _offsets.push_back(_data.size());
+  _data.append(value.start(), size);
+  ++_count;
+}
+
+void ExternalSorter::addArray(Slice array) {
+  ArrayIterator it(array);
+  while (it.valid()) {
+    add(it.value());
+    it.next();
+  }
+}
+
+void ExternalSorter::sortMemory() {
+  uint8_t const* base = _data.data();
+  std::sort(_offsets.begin(), _offsets.end(),
+            [this, base](ValueLength a, ValueLength b) {
+    return _lessthan(Slice(base + a), Slice(base + b));
+  });
+}
+
+void ExternalSorter::spill() {
+  sortMemory();
+
+#ifdef _WIN32
+  std::string const separator("\\");
+#else
+  std::string const separator("/");
+#endif
+  std::string filename = _tempDirectory + separator + "vpack-sort-" +
+      std::to_string(reinterpret_cast<uintptr_t>(this)) + "-" +
+      std::to_string(::runFileCounter++) + ".vpack";
+
+  std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    throw Exception(Exception::InternalError, "cannot create sort run file");
+  }
+  _runs.push_back(filename);
+
+  uint8_t const* base = _data.data();
+  for (auto const& offset : _offsets) {
+    Slice s(base + offset);
+    out.write(reinterpret_cast<char const*>(s.start()),
+              static_cast<std::streamsize>(s.byteSize()));
+  }
+  out.close();
+  if (out.fail()) {
+    throw Exception(Exception::InternalError, "cannot write sort run file");
+  }
+
+  _offsets.clear();
+  _data.clear();
+}
+
+void ExternalSorter::finish(std::function<void(Slice)> const& consumer) {
+  if (VELOCYPACK_UNLIKELY(_finished)) {
+    throw Exception(Exception::InternalError, "ExternalSorter is already finished");
+  }
+  _finished = true;
+
+  if (_runs.empty()) {
+    // everything fits into memory
+    sortMemory();
+    uint8_t const* base = _data.data();
+    for (auto const& offset : _offsets) {
+      consumer(Slice(base + offset));
+    }
+    return;
+  }
+
+  if (!_offsets.empty()) {
+    spill();
+  }
+
+  // k-way merge of all runs
+  std::vector<std::unique_ptr<RunReader>> readers;
+  std::vector<Slice> current;
+  readers.reserve(_runs.size());
+  current.reserve(_runs.size());
+  for (auto const& run : _runs) {
+    readers.emplace_back(std::make_unique<RunReader>(run));
+    current.emplace_back();
+  }
+
+  // the queue contains the indexes of all readers that still have values,
+  // with the reader with the smallest current value on top. ties are broken
+  // by the run index to make the output deterministic
+  auto greater = [this, &current](std::size_t a, std::size_t b) {
+    if (_lessthan(current[b], current[a])) {
+      return true;
+    }
+    if (_lessthan(current[a], current[b])) {
+      return false;
+    }
+    return a > b;
+  };
+  std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> queue(greater);
+  for (std::size_t i = 0; i < readers.size(); ++i) {
+    if (readers[i]->next(current[i])) {
+      queue.push(i);
+    }
+  }
+
+  while (!queue.empty()) {
+    std::size_t i = queue.top();
+    queue.pop();
+    consumer(current[i]);
+    if (readers[i]->next(current[i])) {
+      queue.push(i);
+    }
+  }
+}
+
+void ExternalSorter::finish(Builder& builder) {
+  finish([&builder](Slice s) { builder.add(s); });
+}
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/FixedBuilder.h"
+
+using namespace arangodb::velocypack;
+
+FixedBuilder::FixedBuilder(uint8_t* data, ValueLength capacity,
+                           Options const* options)
+    : _buffer(data, capacity),
+      _builder(_buffer, options),
+      _committed(_builder.savepoint()),
+      _overflowed(false) {}
+
+void FixedBuilder::rollback() noexcept {
+  // all open Arrays and Objects were opened behind _committed, so this
+  // cannot fail
+  _builder.rollback(_committed);
+  _overflowed = false;
+}
+
+void FixedBuilder::rollback(Builder::Savepoint const& savepoint) {
+  _builder.rollback(savepoint);
+  _overflowed = false;
+  if (_builder.isClosed()) {
+    _committed = _builder.savepoint();
+  }
+}
+
+void FixedBuilder::clear() noexcept {
+  _builder.clear();
+  _committed = _builder.savepoint();
+  _overflowed = false;
+}
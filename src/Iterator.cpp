@@ -29,6 +29,63 @@
 
 using namespace arangodb::velocypack;
 
+namespace {
+
+Slice expectType(Slice slice, ValueType type) {
+  if (VELOCYPACK_UNLIKELY(slice.type() != type)) {
+    throw Exception(Exception::InvalidValueType,
+                    type == ValueType::Array ? "Expecting Array slice"
+                                             : "Expecting Object slice");
+  }
+  return slice;
+}
+
+}  // namespace
+
+MemberPositions::MemberPositions(Slice slice)
+    : _size(slice.length()),
+      _first(nullptr),
+      _stride(0),
+      _indexTable(nullptr),
+      _offsetSize(0) {
+  if (_size == 0) {
+    return;
+  }
+
+  uint8_t const head = slice.head();
+  if (head == 0x13 || head == 0x14) {
+    // compact Array or Object: no index table, so walk over the members
+    // once and remember their positions
+    _members.reserve(checkOverflow(_size));
+    uint8_t const* current = slice.start() + slice.getNthOffset(0);
+    for (ValueLength i = 0; i < _size; ++i) {
+      _members.push_back(current);
+      current += Slice(current).byteSize();
+      if (head == 0x14) {
+        // skip over value
+        current += Slice(current).byteSize();
+      }
+    }
+  } else if (head <= 0x05 || _size == 1) {
+    // no index table, but all members have the same byte size
+    _first = slice.start() + slice.getNthOffset(0);
+    _stride = Slice(_first).byteSize();
+  } else {
+    // index table at the end. with 8-byte offsets, the number of members
+    // follows the index table
+    _offsetSize = SliceStaticData::WidthMap[head];
+    _first = slice.start();
+    _indexTable = slice.start() + slice.byteSize() - _size * _offsetSize -
+                  (_offsetSize == 8 ? 8 : 0);
+  }
+}
+
+RandomAccessArray::RandomAccessArray(Slice slice)
+    : _slice(slice), _positions(::expectType(slice, ValueType::Array)) {}
+
+RandomAccessObject::RandomAccessObject(Slice slice)
+    : _slice(slice), _positions(::expectType(slice, ValueType::Object)) {}
+
 std::ostream& operator<<(std::ostream& stream, ArrayIterator const* it) {
   stream << "[ArrayIterator " << it->index() << " / " << it->size() << "]";
   return stream;
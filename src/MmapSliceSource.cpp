@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Exception.h"
+#include "velocypack/MmapSliceSource.h"
+#include "velocypack/Validator.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// maximum number of bytes Slice::byteSize() reads from the header of an
+// untagged value
+constexpr std::size_t maxHeaderSize = 1 + 8;
+
+#ifndef _WIN32
+int adviceFor(MmapSliceSource::AccessPattern pattern) {
+  switch (pattern) {
+    case MmapSliceSource::AccessPattern::Sequential:
+      return MADV_SEQUENTIAL;
+    case MmapSliceSource::AccessPattern::Random:
+      return MADV_RANDOM;
+    case MmapSliceSource::AccessPattern::WillNeed:
+      return MADV_WILLNEED;
+    case MmapSliceSource::AccessPattern::Normal:
+    default:
+      return MADV_NORMAL;
+  }
+}
+#endif
+
+}  // namespace
+
+struct MmapSliceSource::Mapping {
+  void* address = nullptr;
+  std::size_t size = 0;
+
+  ~Mapping() {
+#ifndef _WIN32
+    if (address != nullptr) {
+      munmap(address, size);
+    }
+#endif
+  }
+};
+
+MmapSliceSource::MmapSliceSource(std::string const& filename,
+                                 Validation validation, AccessPattern pattern,
+                                 Options const* options)
+    : _mapping(std::make_shared<Mapping>()),
+      _data(nullptr),
+      _size(0),
+      _validation(validation),
+      _options(options) {
+#ifdef _WIN32
+  throw Exception(Exception::NotImplemented,
+                  "memory-mapped files are not supported on this platform");
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Exception(Exception::InternalError, "cannot open file");
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw Exception(Exception::InternalError, "cannot stat file");
+  }
+  _size = static_cast<std::size_t>(info.st_size);
+
+  if (_size > 0) {
+    void* address = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+      ::close(fd);
+      throw Exception(Exception::InternalError, "cannot map file");
+    }
+    _mapping->address = address;
+    _mapping->size = _size;
+    _data = static_cast<uint8_t const*>(address);
+  }
+  // the mapping stays valid after closing the file
+  ::close(fd);
+
+  if (_validation == Validation::Eager) {
+    // the whole file will be read anyway
+    advise(AccessPattern::Sequential);
+    std::call_once(_indexBuilt, [this]() { buildIndex(); });
+    for (std::size_t i = 0; i + 1 < _offsets.size(); ++i) {
+      validate(_offsets[i], _offsets[i + 1] - _offsets[i]);
+    }
+  }
+  advise(pattern);
+#endif
+}
+
+MmapSliceSource::~MmapSliceSource() = default;
+
+void MmapSliceSource::advise(AccessPattern pattern) const {
+#ifndef _WIN32
+  if (_size > 0) {
+    // the advice is only a hint, so failures are ignored
+    ::madvise(_mapping->address, _size, ::adviceFor(pattern));
+  }
+#endif
+}
+
+std::size_t MmapSliceSource::count() const {
+  std::call_once(_indexBuilt, [this]() { buildIndex(); });
+  return _offsets.size() - 1;
+}
+
+Slice MmapSliceSource::at(std::size_t index) const {
+  if (index >= count()) {
+    throw Exception(Exception::IndexOutOfBounds);
+  }
+  std::size_t const offset = _offsets[index];
+  if (_validation == Validation::Lazy &&
+      !_validated[index].load(std::memory_order_acquire)) {
+    validate(offset, _offsets[index + 1] - offset);
+    _validated[index].store(true, std::memory_order_release);
+  }
+  return Slice(_data + offset);
+}
+
+SharedSlice MmapSliceSource::sharedAt(std::size_t index) const {
+  return share(at(index));
+}
+
+std::size_t MmapSliceSource::valueSize(std::size_t offset) const {
+  // skip the tags, which byteSize() would follow recursively
+  std::size_t position = offset;
+  while (position < _size && (_data[position] == 0xee || _data[position] == 0xef)) {
+    position += (_data[position] == 0xee) ? 1 + 1 : 1 + 8;
+  }
+
+  ValueLength size = ValueLength(position - offset);
+  if (position >= _size) {
+    size = _size - offset + 1;
+  } else if (_size - position >= maxHeaderSize) {
+    size += Slice(_data + position).byteSize();
+  } else {
+    // the header may extend beyond the end of the file, so read it from a
+    // zero-padded copy. if the header is truncated, the value appears to
+    // be larger than the remaining bytes
+    uint8_t header[maxHeaderSize] = {};
+    std::memcpy(header, _data + position, _size - position);
+    size += Slice(header).byteSize();
+  }
+
+  if (size > _size - offset) {
+    throw Exception(Exception::ValidatorInvalidLength,
+                    "value exceeds the end of the file");
+  }
+  return static_cast<std::size_t>(size);
+}
+
+void MmapSliceSource::validate(std::size_t offset, std::size_t size) const {
+  Validator validator(_options);
+  validator.validate(_data + offset, size, false);
+}
+
+void MmapSliceSource::buildIndex() const {
+  std::vector<std::size_t> offsets;
+  std::size_t offset = 0;
+  while (offset < _size) {
+    offsets.push_back(offset);
+    offset += valueSize(offset);
+  }
+  offsets.push_back(_size);
+
+  if (_validation == Validation::Lazy) {
+    _validated = std::make_unique<std::atomic<bool>[]>(offsets.size());
+    for (std::size_t i = 0; i < offsets.size(); ++i) {
+      _validated[i].store(false, std::memory_order_relaxed);
+    }
+  }
+  _offsets = std::move(offsets);
+}
+
+SharedSlice MmapSliceSource::share(Slice slice) const {
+  // aliasing shared_ptr, which keeps the mapping alive without copying
+  return SharedSlice(std::shared_ptr<uint8_t const>(_mapping, slice.start()));
+}
+
+MmapSliceSource::Iterator::Iterator(MmapSliceSource const* source)
+    : _source(source), _offset(0), _valueSize(0) {
+  check();
+}
+
+SharedSlice MmapSliceSource::Iterator::sharedValue() const {
+  return _source->share(value());
+}
+
+void MmapSliceSource::Iterator::next() {
+  _offset += _valueSize;
+  check();
+}
+
+void MmapSliceSource::Iterator::check() {
+  if (!valid()) {
+    _valueSize = 0;
+    return;
+  }
+  _valueSize = _source->valueSize(_offset);
+  if (_source->_validation == Validation::Lazy) {
+    _source->validate(_offset, _valueSize);
+  }
+}
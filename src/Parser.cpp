@@ -23,7 +23,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
 #include "asm-functions.h"
@@ -40,6 +42,12 @@ using namespace arangodb::velocypack;
 // build the result (build phase).
 
 ValueLength Parser::parseInternal(bool multi) {
+  VELOCYPACK_STATISTICS_ADD(ParseCalls, 1);
+  VELOCYPACK_STATISTICS_ADD(ParsedBytes, _size);
+  VELOCYPACK_STATISTICS_TIMER(ParseNanos);
+  // attribute the Builder's memory to the parser
+  AllocationTracing::Scope scope(AllocationCategory::Parser);
+
   // skip over optional BOM
   if (_size >= 3 && _start[0] == 0xef && _start[1] == 0xbb &&
       _start[2] == 0xbf) {
@@ -553,9 +561,12 @@ void Parser::parseJson() {
     case 'n':
       parseNull();  // this consumes "ull" or throws
       break;
-    case '"':
+    case '"': {
+      ValueLength const base = _builderPtr->_pos;
       parseString();
+      _builderPtr->checkStringDeduplication(base);
       break;
+    }
     default: {
       // everything else must be a number or is invalid...
       // this includes '-' and '0' to '9'. scanNumber() will
@@ -0,0 +1,562 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Query.h"
+#include "velocypack/Compare.h"
+#include "velocypack/Exception.h"
+#include "velocypack/Iterator.h"
+#include "velocypack/Parser.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// recursive descent parser for query expressions
+class QueryParser {
+ public:
+  explicit QueryParser(std::string_view expression)
+      : _p(expression.data()), _end(expression.data() + expression.size()) {}
+
+  std::vector<Query::Step> parse() {
+    std::vector<Query::Step> steps;
+    skipWhitespace();
+    if (!consume('$')) {
+      fail("Query must start with '$'");
+    }
+    while (true) {
+      skipWhitespace();
+      if (atEnd()) {
+        break;
+      }
+      if (consume('.')) {
+        if (peek() == '.') {
+          fail("Recursive descent is not supported");
+        }
+        if (consume('*')) {
+          steps.emplace_back(makeStep(Query::StepType::Wildcard));
+        } else {
+          Query::Step step = makeStep(Query::StepType::Names);
+          step.names.emplace_back(parseIdentifier());
+          steps.emplace_back(std::move(step));
+        }
+      } else if (consume('[')) {
+        steps.emplace_back(parseBracket());
+      } else {
+        fail("Expecting '.' or '['");
+      }
+    }
+    return steps;
+  }
+
+ private:
+  [[noreturn]] static void fail(char const* message) {
+    throw Exception(Exception::InvalidQuery, message);
+  }
+
+  static Query::Step makeStep(Query::StepType type) {
+    Query::Step step;
+    step.type = type;
+    step.start = 0;
+    step.end = 0;
+    step.step = 1;
+    step.hasStart = false;
+    step.hasEnd = false;
+    return step;
+  }
+
+  bool atEnd() const noexcept { return _p == _end; }
+
+  char peek() const noexcept { return atEnd() ? '\0' : *_p; }
+
+  bool consume(char c) noexcept {
+    if (peek() == c && !atEnd()) {
+      ++_p;
+      return true;
+    }
+    return false;
+  }
+
+  bool consume(std::string_view token) noexcept {
+    if (static_cast<std::size_t>(_end - _p) >= token.size() &&
+        std::string_view(_p, token.size()) == token) {
+      _p += token.size();
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c, char const* message) {
+    skipWhitespace();
+    if (!consume(c)) {
+      fail(message);
+    }
+  }
+
+  void skipWhitespace() noexcept {
+    while (!atEnd() && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) {
+      ++_p;
+    }
+  }
+
+  static bool isIdentifierChar(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '$' || c == '-' ||
+           (static_cast<uint8_t>(c) & 0x80) != 0;
+  }
+
+  std::string parseIdentifier() {
+    char const* start = _p;
+    while (!atEnd() && isIdentifierChar(*_p)) {
+      ++_p;
+    }
+    if (start == _p) {
+      fail("Expecting attribute name");
+    }
+    return std::string(start, _p - start);
+  }
+
+  std::string parseQuoted() {
+    char const quote = *_p++;
+    std::string result;
+    while (true) {
+      if (atEnd()) {
+        fail("Unterminated string");
+      }
+      char c = *_p++;
+      if (c == quote) {
+        break;
+      }
+      if (c == '\\') {
+        if (atEnd()) {
+          fail("Unterminated string");
+        }
+        c = *_p++;
+      }
+      result.push_back(c);
+    }
+    return result;
+  }
+
+  bool atQuote() const noexcept { return peek() == '\'' || peek() == '"'; }
+
+  bool atInteger() const noexcept {
+    char c = peek();
+    return (c >= '0' && c <= '9') || c == '-';
+  }
+
+  int64_t parseInteger() {
+    bool negative = consume('-');
+    if (!(peek() >= '0' && peek() <= '9')) {
+      fail("Expecting integer");
+    }
+    uint64_t value = 0;
+    while (peek() >= '0' && peek() <= '9') {
+      uint64_t const digit = static_cast<uint64_t>(*_p++ - '0');
+      // check before multiplying, so that value cannot wrap around
+      if (value > (static_cast<uint64_t>(INT64_MAX) - digit) / 10) {
+        fail("Integer out of range");
+      }
+      value = value * 10 + digit;
+    }
+    return negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+  }
+
+  // parses the part after '['
+  Query::Step parseBracket() {
+    skipWhitespace();
+    if (consume('*')) {
+      expect(']', "Expecting ']'");
+      return makeStep(Query::StepType::Wildcard);
+    }
+    if (consume('?')) {
+      Query::Step step = makeStep(Query::StepType::Filter);
+      expect('(', "Expecting '(' after '?'");
+      step.filter = parseFilter();
+      expect(')', "Expecting ')'");
+      expect(']', "Expecting ']'");
+      return step;
+    }
+    if (atQuote()) {
+      Query::Step step = makeStep(Query::StepType::Names);
+      while (true) {
+        step.names.emplace_back(parseQuoted());
+        skipWhitespace();
+        if (consume(']')) {
+          return step;
+        }
+        expect(',', "Expecting ',' or ']'");
+        skipWhitespace();
+        if (!atQuote()) {
+          fail("Expecting attribute name in quotes");
+        }
+      }
+    }
+
+    // positions or a range
+    Query::Step step = makeStep(Query::StepType::Indexes);
+    if (atInteger()) {
+      step.start = parseInteger();
+      step.hasStart = true;
+      skipWhitespace();
+    }
+    if (consume(':')) {
+      step.type = Query::StepType::Range;
+      skipWhitespace();
+      if (atInteger()) {
+        step.end = parseInteger();
+        step.hasEnd = true;
+        skipWhitespace();
+      }
+      if (consume(':')) {
+        skipWhitespace();
+        if (atInteger()) {
+          step.step = parseInteger();
+          if (step.step <= 0) {
+            fail("Range step must be positive");
+          }
+        }
+      }
+      expect(']', "Expecting ']'");
+      return step;
+    }
+    if (!step.hasStart) {
+      fail("Expecting attribute name, position, range, '*' or '?'");
+    }
+    step.indexes.push_back(step.start);
+    while (!consume(']')) {
+      expect(',', "Expecting ',' or ']'");
+      skipWhitespace();
+      step.indexes.push_back(parseInteger());
+      skipWhitespace();
+    }
+    return step;
+  }
+
+  Query::Filter parseFilter() {
+    Query::Filter filter;
+    filter.emplace_back(parseConjunction());
+    skipWhitespace();
+    while (consume("||")) {
+      filter.emplace_back(parseConjunction());
+      skipWhitespace();
+    }
+    return filter;
+  }
+
+  std::vector<Query::Condition> parseConjunction() {
+    std::vector<Query::Condition> conditions;
+    conditions.emplace_back(parseCondition());
+    skipWhitespace();
+    while (consume("&&")) {
+      conditions.emplace_back(parseCondition());
+      skipWhitespace();
+    }
+    return conditions;
+  }
+
+  Query::Condition parseCondition() {
+    Query::Condition condition;
+    skipWhitespace();
+    if (!consume('@')) {
+      fail("Expecting '@'");
+    }
+    while (true) {
+      if (consume('.')) {
+        condition.path.push_back(Query::PathElement{parseIdentifier(), 0, false});
+      } else if (consume('[')) {
+        skipWhitespace();
+        if (atQuote()) {
+          condition.path.push_back(Query::PathElement{parseQuoted(), 0, false});
+        } else {
+          condition.path.push_back(Query::PathElement{std::string(), parseInteger(), true});
+        }
+        expect(']', "Expecting ']'");
+      } else {
+        break;
+      }
+    }
+
+    skipWhitespace();
+    if (consume("==")) {
+      condition.op = Query::Operator::Equal;
+    } else if (consume("!=")) {
+      condition.op = Query::Operator::NotEqual;
+    } else if (consume("<=")) {
+      condition.op = Query::Operator::LessEqual;
+    } else if (consume(">=")) {
+      condition.op = Query::Operator::GreaterEqual;
+    } else if (consume('<')) {
+      condition.op = Query::Operator::Less;
+    } else if (consume('>')) {
+      condition.op = Query::Operator::Greater;
+    } else {
+      condition.op = Query::Operator::Exists;
+      return condition;
+    }
+
+    skipWhitespace();
+    parseLiteral(condition.literal);
+    return condition;
+  }
+
+  void parseLiteral(Builder& literal) {
+    if (atQuote()) {
+      literal.add(Value(parseQuoted()));
+    } else if (consume("true")) {
+      literal.add(Value(true));
+    } else if (consume("false")) {
+      literal.add(Value(false));
+    } else if (consume("null")) {
+      literal.add(Value(ValueType::Null));
+    } else {
+      char const* start = _p;
+      while (!atEnd() && ((*_p >= '0' && *_p <= '9') || *_p == '-' ||
+                          *_p == '+' || *_p == '.' || *_p == 'e' || *_p == 'E')) {
+        ++_p;
+      }
+      if (start == _p) {
+        fail("Expecting literal");
+      }
+      Parser parser;
+      try {
+        parser.parse(start, _p - start);
+      } catch (Exception const&) {
+        fail("Invalid number");
+      }
+      literal.add(parser.steal()->slice());
+    }
+  }
+
+  char const* _p;
+  char const* _end;
+};
+
+// looks up a filter path relative to value. returns a None Slice if the
+// path does not exist
+Slice lookup(Slice value, std::vector<Query::PathElement> const& path) {
+  for (auto const& element : path) {
+    if (element.isIndex) {
+      if (!value.isArray()) {
+        return Slice();
+      }
+      ValueLength const n = value.length();
+      int64_t index = element.index;
+      if (index < 0) {
+        index += static_cast<int64_t>(n);
+      }
+      if (index < 0 || static_cast<ValueLength>(index) >= n) {
+        return Slice();
+      }
+      value = value.at(static_cast<ValueLength>(index));
+    } else {
+      if (!value.isObject()) {
+        return Slice();
+      }
+      value = value.get(element.name);
+      if (value.isNone()) {
+        return value;
+      }
+    }
+  }
+  return value;
+}
+
+bool evaluate(Query::Condition const& condition, Slice value) {
+  Slice lhs = ::lookup(value, condition.path);
+  if (condition.op == Query::Operator::Exists) {
+    return !lhs.isNone();
+  }
+
+  Slice rhs = condition.literal.slice();
+  if (condition.op == Query::Operator::Equal ||
+      condition.op == Query::Operator::NotEqual) {
+    bool equal = !lhs.isNone() && NormalizedCompare::equals(lhs, rhs);
+    return equal == (condition.op == Query::Operator::Equal);
+  }
+
+  if (!((lhs.isNumber() && rhs.isNumber()) ||
+        (lhs.isString() && rhs.isString()))) {
+    return false;
+  }
+  int c = NormalizedCompare::compare(lhs, rhs);
+  switch (condition.op) {
+    case Query::Operator::Less:
+      return c < 0;
+    case Query::Operator::LessEqual:
+      return c <= 0;
+    case Query::Operator::Greater:
+      return c > 0;
+    case Query::Operator::GreaterEqual:
+      return c >= 0;
+    default:
+      return false;
+  }
+}
+
+bool evaluate(Query::Filter const& filter, Slice value) {
+  for (auto const& conjunction : filter) {
+    bool match = true;
+    for (auto const& condition : conjunction) {
+      if (!::evaluate(condition, value)) {
+        match = false;
+        break;
+      }
+    }
+    if (match) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+Query::Query(std::string_view expression)
+    : _expression(expression), _steps(QueryParser(expression).parse()) {}
+
+void Query::forEach(Slice value, Callback const& callback) const {
+  run(value, 0, callback);
+}
+
+void Query::execute(Slice value, Builder& result) const {
+  result.openArray();
+  run(value, 0, [&result](Slice selected) {
+    result.add(selected);
+    return true;
+  });
+  result.close();
+}
+
+Builder Query::execute(Slice value) const {
+  Builder result;
+  execute(value, result);
+  return result;
+}
+
+Slice Query::first(Slice value) const {
+  Slice result;
+  run(value, 0, [&result](Slice selected) {
+    result = selected;
+    return false;
+  });
+  return result;
+}
+
+// returns false if the execution was stopped by the callback
+bool Query::run(Slice value, std::size_t step, Callback const& callback) const {
+  if (step == _steps.size()) {
+    return callback(value);
+  }
+
+  Step const& s = _steps[step];
+  switch (s.type) {
+    case StepType::Names: {
+      if (value.isObject()) {
+        for (auto const& name : s.names) {
+          Slice v = value.get(name);
+          if (!v.isNone() && !run(v, step + 1, callback)) {
+            return false;
+          }
+        }
+      }
+      break;
+    }
+
+    case StepType::Indexes: {
+      if (value.isArray()) {
+        int64_t const n = static_cast<int64_t>(value.length());
+        for (int64_t index : s.indexes) {
+          if (index < 0) {
+            index += n;
+          }
+          if (index >= 0 && index < n &&
+              !run(value.at(static_cast<ValueLength>(index)), step + 1, callback)) {
+            return false;
+          }
+        }
+      }
+      break;
+    }
+
+    case StepType::Range: {
+      if (value.isArray()) {
+        int64_t const n = static_cast<int64_t>(value.length());
+        auto normalize = [n](int64_t i) {
+          if (i < 0) {
+            i += n;
+          }
+          return i < 0 ? 0 : (i > n ? n : i);
+        };
+        int64_t const start = s.hasStart ? normalize(s.start) : 0;
+        int64_t const end = s.hasEnd ? normalize(s.end) : n;
+        if (start < end) {
+          ArrayIterator it(value);
+          it.forward(static_cast<ValueLength>(start));
+          int64_t i = start;
+          while (true) {
+            if (!run(it.value(), step + 1, callback)) {
+              return false;
+            }
+            if (end - i <= s.step) {
+              break;
+            }
+            i += s.step;
+            it.forward(static_cast<ValueLength>(s.step));
+          }
+        }
+      }
+      break;
+    }
+
+    case StepType::Wildcard:
+    case StepType::Filter: {
+      bool const filter = (s.type == StepType::Filter);
+      if (value.isArray()) {
+        for (Slice v : ArrayIterator(value)) {
+          if ((!filter || ::evaluate(s.filter, v)) && !run(v, step + 1, callback)) {
+            return false;
+          }
+        }
+      } else if (value.isObject()) {
+        ObjectIterator it(value, true);
+        while (it.valid()) {
+          Slice v = it.value();
+          if ((!filter || ::evaluate(s.filter, v)) && !run(v, step + 1, callback)) {
+            return false;
+          }
+          it.next();
+        }
+      }
+      break;
+    }
+  }
+  return true;
+}
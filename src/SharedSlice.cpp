@@ -22,6 +22,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <velocypack/SharedSlice.h>
+#include <velocypack/AllocationObserver.h>
 
 using namespace arangodb;
 using namespace arangodb::velocypack;
@@ -40,19 +41,52 @@ void SharedSlice::nullToNone() noexcept {
 std::shared_ptr<uint8_t const> SharedSlice::copyBuffer(Buffer<uint8_t> const& buffer) {
   // template<class T> shared_ptr<T> make_shared( std::size_t N );
   // with T is U[] is only available since C++20 :(
-  auto newBuffer = std::shared_ptr<uint8_t>(new uint8_t[buffer.byteSize()],
-                                            [](uint8_t* ptr) { delete[] ptr; });
-  memcpy(newBuffer.get(), buffer.data(), checkOverflow(buffer.byteSize()));
+  std::size_t const size = checkOverflow(buffer.byteSize());
+  auto newBuffer = std::shared_ptr<uint8_t>(new uint8_t[size], [size](uint8_t* ptr) {
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::freed(ptr, size);
+    }
+    delete[] ptr;
+  });
+  if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+    AllocationTracing::allocated(newBuffer.get(), size,
+                                 AllocationCategory::SharedSliceCopy);
+  }
+  memcpy(newBuffer.get(), buffer.data(), size);
   return newBuffer;
 }
 
 std::shared_ptr<uint8_t const> SharedSlice::stealBuffer(Buffer<uint8_t>&& buffer) {
   // If the buffer doesn't use memory on the heap, we have to copy it.
-  if (buffer.usesLocalMemory()) {
+  if (buffer.usesLocalMemory() || buffer.usesExternalMemory()) {
     return copyBuffer(buffer);
   }
+  // the Buffer reports the stolen memory as freed, so report it again as
+  // owned by the SharedSlice now
+  ValueLength capacity = buffer.capacity();
+  if (buffer.usesMappedMemory()) {
+    uint8_t* data = buffer.stealMapping(capacity);
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::allocated(data, checkOverflow(capacity),
+                                   AllocationCategory::Buffer);
+    }
+    return std::shared_ptr<uint8_t const>(data, [capacity](auto ptr) {
+      if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+        AllocationTracing::freed(ptr, checkOverflow(Slice(ptr).byteSize()));
+      }
+      MappedMemory::unmap(const_cast<uint8_t*>(ptr), capacity);
+    });
+  }
   // Buffer uses velocypack_malloc/velocypack_free for memory management
-  return std::shared_ptr<uint8_t const>(buffer.steal(), [](auto ptr) {
+  uint8_t* data = buffer.steal();
+  if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+    AllocationTracing::allocated(data, checkOverflow(capacity),
+                                 AllocationCategory::Buffer);
+  }
+  return std::shared_ptr<uint8_t const>(data, [](auto ptr) {
+    if (VELOCYPACK_UNLIKELY(AllocationTracing::active())) {
+      AllocationTracing::freed(ptr, checkOverflow(Slice(ptr).byteSize()));
+    }
     return velocypack_free(ptr);
   });
 }
@@ -33,6 +33,7 @@
 #include "velocypack/Parser.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/ValueType.h"
 
 using namespace arangodb::velocypack;
@@ -240,6 +241,10 @@ uint32_t Slice::normalizedHash32(uint32_t seed) const {
 // look for the specified attribute inside an Object
 // returns a Slice(ValueType::None) if not found
 Slice Slice::get(std::string_view attribute) const {
+  return getUnresolved(attribute).resolveStringReference();
+}
+
+Slice Slice::getUnresolved(std::string_view attribute) const {
   if (VELOCYPACK_UNLIKELY(!isObject())) {
     throw Exception(Exception::InvalidValueType, "Expecting Object");
   }
@@ -252,6 +257,7 @@ Slice Slice::get(std::string_view attribute) const {
 
   if (h == 0x14) {
     // compact Object
+    VELOCYPACK_STATISTICS_ADD(LookupsCompact, 1);
     return getFromCompactObject(attribute);
   }
 
@@ -298,6 +304,7 @@ Slice Slice::get(std::string_view attribute) const {
   constexpr ValueLength SortedSearchEntriesThreshold = 4;
 
   if (n >= SortedSearchEntriesThreshold && (h >= 0x0b && h <= 0x0e)) {
+    VELOCYPACK_STATISTICS_ADD(LookupsBinary, 1);
     switch (offsetSize) {
       case 1:
         return searchObjectKeyBinary<1>(attribute, ieBase, n);
@@ -311,6 +318,7 @@ Slice Slice::get(std::string_view attribute) const {
     }
   }
 
+  VELOCYPACK_STATISTICS_ADD(LookupsLinear, 1);
   return searchObjectKeyLinear(attribute, ieBase, offsetSize, n);
 }
 
@@ -547,7 +555,7 @@ ValueLength Slice::getNthOffset(ValueLength index) const {
 Slice Slice::getNth(ValueLength index) const {
   VELOCYPACK_ASSERT(isArray());
 
-  return Slice(start() + getNthOffset(index));
+  return Slice(start() + getNthOffset(index)).resolveStringReference();
 }
 
 // extract the nth member from an Object
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+/// DISCLAIMER
+///
+/// Copyright 2014-2020 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "velocypack/velocypack-common.h"
+#include "velocypack/Builder.h"
+#include "velocypack/Statistics.h"
+#include "velocypack/Value.h"
+
+using namespace arangodb::velocypack;
+
+namespace {
+
+// all threads that currently have counters, plus the totals of the
+// threads that have already exited
+struct StatisticsRegistry {
+  std::mutex mutex;
+  std::vector<Statistics::ThreadCounters const*> threads;
+  Statistics::Values exited{};
+};
+
+StatisticsRegistry& registry() {
+  // intentionally never destroyed, as thread-local counters may still
+  // unregister after static destruction has started
+  static StatisticsRegistry* instance = new StatisticsRegistry();
+  return *instance;
+}
+
+}  // namespace
+
+#ifndef VELOCYPACK_NO_THREADLOCALS
+thread_local Statistics::ThreadCounters Statistics::local;
+#else
+Statistics::ThreadCounters Statistics::local;
+#endif
+
+Statistics::ThreadCounters::ThreadCounters() {
+  reset();
+  StatisticsRegistry& r = ::registry();
+  std::lock_guard<std::mutex> guard(r.mutex);
+  r.threads.push_back(this);
+}
+
+Statistics::ThreadCounters::~ThreadCounters() {
+  Values const v = values();
+  StatisticsRegistry& r = ::registry();
+  std::lock_guard<std::mutex> guard(r.mutex);
+  for (std::size_t i = 0; i < NumCounters; ++i) {
+    r.exited[i] += v[i];
+  }
+  r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), this),
+                  r.threads.end());
+}
+
+Statistics::Values Statistics::ThreadCounters::values() const noexcept {
+  Values result;
+  for (std::size_t i = 0; i < NumCounters; ++i) {
+    result[i] = _values[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+void Statistics::ThreadCounters::reset() noexcept {
+  for (auto& it : _values) {
+    it.store(0, std::memory_order_relaxed);
+  }
+}
+
+Statistics::Values Statistics::total() {
+  StatisticsRegistry& r = ::registry();
+  std::lock_guard<std::mutex> guard(r.mutex);
+  Values result = r.exited;
+  for (ThreadCounters const* counters : r.threads) {
+    Values const v = counters->values();
+    for (std::size_t i = 0; i < NumCounters; ++i) {
+      result[i] += v[i];
+    }
+  }
+  return result;
+}
+
+char const* Statistics::name(Counter counter) noexcept {
+  switch (counter) {
+    case ParseCalls:
+      return "parseCalls";
+    case ParsedBytes:
+      return "parsedBytes";
+    case ParseNanos:
+      return "parseNanos";
+    case DumpCalls:
+      return "dumpCalls";
+    case DumpedBytes:
+      return "dumpedBytes";
+    case DumpNanos:
+      return "dumpNanos";
+    case BufferReallocations:
+      return "bufferReallocations";
+    case BufferGrowthBytes:
+      return "bufferGrowthBytes";
+    case IndexSorts:
+      return "indexSorts";
+    case IndexSortsSkipped:
+      return "indexSortsSkipped";
+    case IndexSortNanos:
+      return "indexSortNanos";
+    case LookupsBinary:
+      return "lookupsBinary";
+    case LookupsLinear:
+      return "lookupsLinear";
+    case LookupsCompact:
+      return "lookupsCompact";
+    case ValidatorCalls:
+      return "validatorCalls";
+    case ValidatedBytes:
+      return "validatedBytes";
+    case NumCounters:
+      break;
+  }
+  return "unknown";
+}
+
+void Statistics::toVelocyPack(Values const& values, Builder& builder) {
+  builder.openObject();
+  builder.add("enabled", Value(enabled()));
+  for (std::size_t i = 0; i < NumCounters; ++i) {
+    builder.add(name(static_cast<Counter>(i)), Value(values[i]));
+  }
+  builder.close();
+}
@@ -29,12 +29,25 @@
 #include "velocypack/Validator.h"
 #include "velocypack/Exception.h"
 #include "velocypack/Slice.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/ValueType.h"
 
 #include "asm-functions.h"
 
 using namespace arangodb::velocypack;
 
+namespace {
+
+// increases the nesting level while validating a compound value. the level
+// is restored when validation throws, so a Validator can be reused
+struct LevelGuard {
+  explicit LevelGuard(int& level) noexcept : level(level) { ++level; }
+  ~LevelGuard() { --level; }
+  int& level;
+};
+
+}  // namespace
+
 template<bool reverse>
 static ValueLength ReadVariableLengthValue(uint8_t const*& p, uint8_t const* end) {
   ValueLength value = 0;
@@ -59,7 +72,7 @@ static ValueLength ReadVariableLengthValue(uint8_t const*& p, uint8_t const* end
 }
   
 Validator::Validator(Options const* options)
-      : options(options), _level(0) {
+      : options(options), _level(0), _start(nullptr) {
   if (options == nullptr) {
     throw Exception(Exception::InternalError, "Options cannot be a nullptr");
   }
@@ -72,6 +85,15 @@ bool Validator::validate(uint8_t const* ptr, std::size_t length, bool isSubPart)
 
   uint8_t const head = *ptr;
 
+  if (_level == 0) {
+    VELOCYPACK_STATISTICS_ADD(ValidatorCalls, 1);
+    VELOCYPACK_STATISTICS_ADD(ValidatedBytes, length);
+
+    // string references must not point before the start of the
+    // innermost compound value
+    _start = ptr;
+  }
+
   // type() only reads the first byte, which is safe
   ValueType const type = Slice(ptr).type();
 
@@ -121,16 +143,20 @@ bool Validator::validate(uint8_t const* ptr, std::size_t length, bool isSubPart)
     }
 
     case ValueType::Array: {
-      ++_level;
+      LevelGuard guard(_level);
+      uint8_t const* const start = _start;
+      _start = ptr;
       validateArray(ptr, length);
-      --_level;
+      _start = start;
       break;
     }
 
     case ValueType::Object: {
-      ++_level;
+      LevelGuard guard(_level);
+      uint8_t const* const start = _start;
+      _start = ptr;
       validateObject(ptr, length);
-      --_level;
+      _start = start;
       break;
     }
 
@@ -150,6 +176,10 @@ bool Validator::validate(uint8_t const* ptr, std::size_t length, bool isSubPart)
         // the actual Slice (without tag) must be at least one byte long
         validateBufferLength(1 + 1 + 1, length, true);
         VELOCYPACK_ASSERT(length > 2);
+        if (ptr[1] == Slice::stringReferenceTag &&
+            Options::Defaults.resolveStringReferences) {
+          validateStringReference(ptr, length);
+        }
         ptr += 2;
         length -= 2;
       } else if (head == 0xef) {
@@ -223,6 +253,29 @@ bool Validator::validate(uint8_t const* ptr, std::size_t length, bool isSubPart)
   return true;
 }
 
+void Validator::validateStringReference(uint8_t const* ptr, std::size_t length) {
+  // the referenced value is a UInt with the distance to the String
+  uint8_t const head = ptr[2];
+  if (head < 0x28U || head > 0x2fU) {
+    throw Exception(Exception::ValidatorInvalidType, "String reference must contain a UInt");
+  }
+  ValueLength const n = head - 0x27U;
+  validateBufferLength(1 + 1 + 1 + n, length, true);
+  ValueLength const distance = readIntegerNonEmpty<ValueLength>(ptr + 3, n);
+  if (distance == 0 || distance > static_cast<ValueLength>(ptr - _start)) {
+    throw Exception(Exception::ValidatorInvalidLength, "String reference is out of bounds");
+  }
+
+  // the referenced String must end before the reference
+  Slice target(ptr - distance);
+  if (!target.isString()) {
+    throw Exception(Exception::ValidatorInvalidType, "String reference must point to a String");
+  }
+  if ((target.head() == 0xbfU && distance < 1 + 8) || target.byteSize() > distance) {
+    throw Exception(Exception::ValidatorInvalidLength, "String reference is out of bounds");
+  }
+}
+
 void Validator::validateArray(uint8_t const* ptr, std::size_t length) {
   uint8_t head = *ptr;
 
@@ -482,7 +535,7 @@ void Validator::validateCompactObject(uint8_t const* ptr, std::size_t length) {
 void Validator::validateIndexedObject(uint8_t const* ptr, std::size_t length) {
   // Object with index table, with 1-8 bytes lengths
   uint8_t head = *ptr;
-  ValueLength const byteSizeLength = 1ULL << (static_cast<ValueLength>(head) - 0x0bU);
+  ValueLength const byteSizeLength = SliceStaticData::WidthMap[head];
   validateBufferLength(1 + byteSizeLength + byteSizeLength + 1, length, true);
   ValueLength const byteSize = readIntegerNonEmpty<ValueLength>(ptr + 1, byteSizeLength);
 
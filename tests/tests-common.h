@@ -1,22 +1,34 @@
 
 #include "velocypack/velocypack-common.h"
+#include "velocypack/AllocationObserver.h"
+#include "velocypack/AllocationRecorder.h"
+#include "velocypack/AttributeDictionary.h"
 #include "velocypack/AttributeTranslator.h"
 #include "velocypack/Basics.h"
 #include "velocypack/Buffer.h"
 #include "velocypack/Builder.h"
 #include "velocypack/Collection.h"
 #include "velocypack/Compare.h"
+#include "velocypack/Compression.h"
+#include "velocypack/Container.h"
 #include "velocypack/Dumper.h"
 #include "velocypack/Exception.h"
+#include "velocypack/ExternalSorter.h"
+#include "velocypack/FixedBuilder.h"
 #include "velocypack/HashedStringRef.h"
 #include "velocypack/HexDump.h"
 #include "velocypack/Iterator.h"
+#include "velocypack/MmapSliceSource.h"
 #include "velocypack/Options.h"
 #include "velocypack/Parser.h"
+#include "velocypack/Query.h"
+#include "velocypack/RefCountedSlice.h"
 #include "velocypack/Sink.h"
 #include "velocypack/Slice.h"
 #include "velocypack/SliceContainer.h"
+#include "velocypack/Statistics.h"
 #include "velocypack/StringRef.h"
+#include "velocypack/Struct.h"
 #include "velocypack/Validator.h"
 #include "velocypack/Value.h"
 #include "velocypack/ValueType.h"
@@ -37,6 +49,17 @@ using namespace arangodb::velocypack;
     ASSERT_FALSE(true);                              \
   }
 
+// enables string references in the default options while in scope
+struct StringReferencesScope {
+  StringReferencesScope() : old(Options::Defaults.resolveStringReferences) {
+    Options::Defaults.resolveStringReferences = true;
+  }
+  ~StringReferencesScope() {
+    Options::Defaults.resolveStringReferences = old;
+  }
+  bool const old;
+};
+
 // don't complain if this function is not called
 static void dumpDouble(double, uint8_t*) VELOCYPACK_UNUSED;
 
@@ -0,0 +1,338 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace {
+
+// installs an observer for the lifetime of the guard
+struct ObserverGuard {
+  explicit ObserverGuard(AllocationObserver* observer, uint32_t sampleInterval = 1) {
+    AllocationTracing::install(observer, sampleInterval);
+  }
+  ~ObserverGuard() { AllocationTracing::install(nullptr); }
+};
+
+struct CountingObserver final : public AllocationObserver {
+  void allocated(void const*, std::size_t size, AllocationCategory) noexcept override {
+    ++allocations;
+    bytes += size;
+  }
+  void reallocated(void const*, void const*, std::size_t, std::size_t) noexcept override {
+    ++reallocations;
+  }
+  void freed(void const*, std::size_t) noexcept override { ++frees; }
+
+  std::size_t allocations = 0;
+  std::size_t reallocations = 0;
+  std::size_t frees = 0;
+  std::size_t bytes = 0;
+};
+
+AllocationRecorder::CategoryStatistics const& get(AllocationRecorder::Statistics const& s,
+                                                  AllocationCategory category) {
+  return s[static_cast<std::size_t>(category)];
+}
+
+std::string largeJson() {
+  std::string json("[");
+  for (int i = 0; i < 1000; ++i) {
+    if (i > 0) {
+      json.push_back(',');
+    }
+    json.append("{\"name\":\"test\",\"value\":" + std::to_string(i) + "}");
+  }
+  json.push_back(']');
+  return json;
+}
+
+}  // namespace
+
+TEST(AllocationTest, CategoryNames) {
+  ASSERT_STREQ("buffer", allocationCategoryName(AllocationCategory::Buffer));
+  ASSERT_STREQ("sharedSliceCopy", allocationCategoryName(AllocationCategory::SharedSliceCopy));
+  ASSERT_STREQ("builderIndex", allocationCategoryName(AllocationCategory::BuilderIndex));
+  ASSERT_STREQ("parser", allocationCategoryName(AllocationCategory::Parser));
+  ASSERT_STREQ("unknown", allocationCategoryName(AllocationCategory::NumCategories));
+}
+
+TEST(AllocationTest, NotInstalled) {
+  ASSERT_EQ(nullptr, AllocationTracing::observer());
+  ASSERT_FALSE(AllocationTracing::active());
+}
+
+TEST(AllocationTest, InstallAndUninstall) {
+  CountingObserver observer;
+  {
+    ObserverGuard guard(&observer);
+    ASSERT_TRUE(AllocationTracing::active());
+    ASSERT_EQ(&observer, AllocationTracing::observer());
+
+    Buffer<uint8_t> buffer;
+    buffer.reserve(1000);
+  }
+  ASSERT_FALSE(AllocationTracing::active());
+  ASSERT_EQ(1UL, observer.allocations);
+  ASSERT_EQ(1UL, observer.frees);
+  ASSERT_LE(1000UL, observer.bytes);
+
+  Buffer<uint8_t> buffer;
+  buffer.reserve(1000);
+  ASSERT_EQ(1UL, observer.allocations);
+}
+
+TEST(AllocationTest, BufferGrowth) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+
+    Buffer<uint8_t> buffer;
+    for (int i = 0; i < 10000; ++i) {
+      buffer.push_back('x');
+    }
+    auto s = recorder.statistics();
+    auto const& b = get(s, AllocationCategory::Buffer);
+    ASSERT_EQ(1UL, b.allocations);
+    ASSERT_LT(0UL, b.reallocations);
+    ASSERT_EQ(0UL, b.frees);
+    ASSERT_EQ(1UL, b.liveBlocks);
+    ASSERT_EQ(buffer.capacity(), b.liveBytes);
+    ASSERT_EQ(buffer.capacity(), b.peakLiveBytes);
+  }
+
+  auto s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(1UL, b.frees);
+  ASSERT_EQ(0UL, b.liveBlocks);
+  ASSERT_EQ(0UL, b.liveBytes);
+  ASSERT_EQ(10000UL, b.freedUsed);
+  ASSERT_LE(b.freedUsed, b.freedCapacity);
+  ASSERT_LE(b.totalLifetimeNanos, b.maxLifetimeNanos);
+  ASSERT_EQ(1UL, std::accumulate(b.sizes.begin(), b.sizes.end(), uint64_t(0)));
+  ASSERT_EQ(1UL, std::accumulate(b.lifetimes.begin(), b.lifetimes.end(), uint64_t(0)));
+}
+
+TEST(AllocationTest, BufferCopyAndMove) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+
+    Buffer<uint8_t> buffer;
+    buffer.reserve(1000);
+    Buffer<uint8_t> copy(buffer);
+    Buffer<uint8_t> moved(std::move(buffer));
+    buffer = copy;
+    copy.clear();
+  }
+
+  auto const s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(0UL, b.liveBlocks);
+  ASSERT_EQ(b.allocations, b.frees);
+}
+
+TEST(AllocationTest, Parser) {
+  std::string const json = largeJson();
+
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+    Parser::fromJson(json);
+  }
+
+  auto s = recorder.statistics();
+  ASSERT_LT(0UL, get(s, AllocationCategory::Parser).allocations);
+  ASSERT_EQ(0UL, get(s, AllocationCategory::Parser).liveBlocks);
+  ASSERT_EQ(0UL, get(s, AllocationCategory::Buffer).allocations);
+  // the index vector of the Builder is not attributed to the parser
+  ASSERT_LT(0UL, get(s, AllocationCategory::BuilderIndex).allocations);
+}
+
+TEST(AllocationTest, BuilderIndex) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+
+    Builder b;
+    b.openArray();
+    for (int i = 0; i < 1000; ++i) {
+      b.add(Value(i));
+    }
+    b.close();
+
+    Builder copy(b);
+  }
+
+  auto const s = recorder.statistics();
+  auto const& i = get(s, AllocationCategory::BuilderIndex);
+  ASSERT_LT(0UL, i.allocations);
+  ASSERT_EQ(i.allocations, i.frees);
+  ASSERT_EQ(0UL, i.liveBytes);
+  ASSERT_LE(1000 * sizeof(ValueLength), i.peakLiveBytes);
+}
+
+TEST(AllocationTest, SharedSliceCopy) {
+  Builder b;
+  b.add(Value(std::string(100, 'x')));
+
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+
+    SharedSlice shared(b.bufferRef());
+    RefCountedSlice counted(b.slice());
+    RefCountedSlice other(counted);
+  }
+
+  auto const s = recorder.statistics();
+  auto const& c = get(s, AllocationCategory::SharedSliceCopy);
+  ASSERT_EQ(2UL, c.allocations);
+  ASSERT_EQ(2UL, c.frees);
+  ASSERT_EQ(0UL, c.liveBlocks);
+  ASSERT_EQ(c.freedCapacity, c.freedUsed);
+}
+
+TEST(AllocationTest, StolenBuffer) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+
+    Builder b;
+    b.add(Value(std::string(1000, 'x')));
+    SharedSlice shared(std::move(*b.steal()));
+    auto s = recorder.statistics();
+    ASSERT_EQ(1UL, get(s, AllocationCategory::Buffer).liveBlocks);
+  }
+
+  // the hand-off to the SharedSlice and the SharedSlice's release
+  auto const s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(0UL, b.liveBlocks);
+  ASSERT_EQ(2UL, b.frees);
+}
+
+TEST(AllocationTest, StolenBufferMemory) {
+  AllocationRecorder recorder;
+  uint8_t* p;
+  {
+    ObserverGuard guard(&recorder);
+
+    Buffer<uint8_t> buffer;
+    buffer.reserve(1000);
+    p = buffer.steal();
+  }
+
+  // the Buffer reports the memory it hands out as freed
+  auto const s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(1UL, b.allocations);
+  ASSERT_EQ(1UL, b.frees);
+  ASSERT_EQ(0UL, b.liveBlocks);
+  velocypack_free(p);
+}
+
+TEST(AllocationTest, Sampling) {
+  CountingObserver observer;
+  {
+    ObserverGuard guard(&observer, 4);
+    for (int i = 0; i < 100; ++i) {
+      Buffer<uint8_t> buffer;
+      buffer.reserve(1000);
+    }
+  }
+  ASSERT_EQ(25UL, observer.allocations);
+  // frees are reported for all blocks
+  ASSERT_EQ(100UL, observer.frees);
+}
+
+TEST(AllocationTest, SampledRecorder) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder, 10);
+    std::vector<Buffer<uint8_t>> buffers(100);
+    for (auto& it : buffers) {
+      it.reserve(1000);
+    }
+    auto const s = recorder.statistics();
+    auto const& b = get(s, AllocationCategory::Buffer);
+    ASSERT_EQ(10UL, b.liveBlocks);
+  }
+
+  auto const s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(10UL, b.allocations);
+  ASSERT_EQ(10UL, b.frees);
+  ASSERT_EQ(0UL, b.liveBlocks);
+}
+
+TEST(AllocationTest, Reset) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+    Buffer<uint8_t> buffer;
+    buffer.reserve(1000);
+    recorder.reset();
+  }
+  auto const s = recorder.statistics();
+  auto const& b = get(s, AllocationCategory::Buffer);
+  ASSERT_EQ(0UL, b.allocations);
+  ASSERT_EQ(0UL, b.frees);
+}
+
+TEST(AllocationTest, ToVelocyPack) {
+  AllocationRecorder recorder;
+  {
+    ObserverGuard guard(&recorder);
+    Buffer<uint8_t> buffer;
+    buffer.reserve(1000);
+  }
+
+  Builder b;
+  recorder.toVelocyPack(b, 8);
+  Slice s = b.slice();
+  ASSERT_TRUE(s.isObject());
+  ASSERT_EQ(8UL, s.get("sampleInterval").getUInt());
+  for (std::size_t i = 0; i < static_cast<std::size_t>(AllocationCategory::NumCategories); ++i) {
+    ASSERT_TRUE(s.get(allocationCategoryName(static_cast<AllocationCategory>(i))).isObject());
+  }
+  Slice buffer = s.get("buffer");
+  ASSERT_EQ(1UL, buffer.get("allocations").getUInt());
+  ASSERT_EQ(1UL, buffer.get("frees").getUInt());
+  ASSERT_TRUE(buffer.get("sizes").isArray());
+  ASSERT_EQ(1UL, buffer.get("sizes").at(buffer.get("sizes").length() - 1).getUInt());
+  ASSERT_TRUE(buffer.get("lifetimes").isArray());
+  ASSERT_EQ(0UL, s.get("parser").get("sizes").length());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
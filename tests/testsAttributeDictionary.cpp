@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tests-common.h"
+
+TEST(AttributeDictionaryTest, Empty) {
+  AttributeDictionary dictionary;
+
+  ASSERT_EQ(0U, dictionary.version());
+  ASSERT_EQ(0U, dictionary.count());
+  ASSERT_NE(nullptr, dictionary.translator());
+  ASSERT_EQ(dictionary.translator(), dictionary.translator(0));
+  ASSERT_EQ(nullptr, dictionary.translator(1));
+  ASSERT_EQ(nullptr, dictionary.translator()->translate("foo"));
+}
+
+TEST(AttributeDictionaryTest, AddVersions) {
+  AttributeDictionary dictionary;
+
+  ASSERT_EQ(1U, dictionary.add({"foo", "bar", "foo"}));
+  ASSERT_EQ(2U, dictionary.count());
+  // nothing new
+  ASSERT_EQ(1U, dictionary.add({"bar"}));
+  ASSERT_EQ(1U, dictionary.add({}));
+  ASSERT_EQ(2U, dictionary.add({"baz", "foo"}));
+  ASSERT_EQ(3U, dictionary.count());
+
+  AttributeTranslator* v1 = dictionary.translator(1);
+  AttributeTranslator* v2 = dictionary.translator(2);
+  ASSERT_NE(nullptr, v1);
+  ASSERT_EQ(v2, dictionary.translator());
+
+  // ids are never reassigned
+  ASSERT_EQ(1U, Slice(v1->translate("foo")).getUInt());
+  ASSERT_EQ(2U, Slice(v1->translate("bar")).getUInt());
+  ASSERT_EQ(nullptr, v1->translate("baz"));
+  ASSERT_EQ(1U, Slice(v2->translate("foo")).getUInt());
+  ASSERT_EQ(2U, Slice(v2->translate("bar")).getUInt());
+  ASSERT_EQ(3U, Slice(v2->translate("baz")).getUInt());
+
+  auto snapshot = dictionary.snapshot();
+  ASSERT_EQ(2U, snapshot.version);
+  ASSERT_EQ(v2, snapshot.translator);
+}
+
+TEST(AttributeDictionaryTest, DecodeWithLaterVersion) {
+  AttributeDictionary dictionary;
+  dictionary.add({"foo", "bar"});
+  auto snapshot = dictionary.snapshot();
+
+  Options options;
+  options.attributeTranslator = snapshot.translator;
+  Builder b(&options);
+  {
+    // the Builder needs the translator to sort the Object keys
+    AttributeTranslatorScope scope(snapshot.translator);
+    b.openObject();
+    b.add("foo", Value(1));
+    b.add("bar", Value(2));
+    b.add("qux", Value(3));
+    b.close();
+  }
+
+  dictionary.add({"qux"});
+  ASSERT_EQ(2U, dictionary.version());
+
+  AttributeTranslatorScope scope(dictionary.translator());
+  Slice s = b.slice();
+  ASSERT_EQ(1U, s.get("foo").getUInt());
+  ASSERT_EQ(2U, s.get("bar").getUInt());
+  ASSERT_EQ(3U, s.get("qux").getUInt());
+  // keys are sorted by their translated names
+  ASSERT_TRUE(s.keyAt(0, false).isSmallInt());
+  ASSERT_EQ("bar", s.keyAt(0).copyString());
+}
+
+TEST(AttributeDictionaryTest, Persist) {
+  AttributeDictionary dictionary;
+  dictionary.add({"foo", "bar"});
+  dictionary.add({"baz"});
+
+  Builder b;
+  dictionary.toVelocyPack(b);
+  ASSERT_EQ("{\"versions\":[[\"foo\",\"bar\"],[\"baz\"]]}", b.slice().toJson());
+
+  AttributeDictionary loaded;
+  loaded.fromVelocyPack(b.slice());
+  ASSERT_EQ(2U, loaded.version());
+  ASSERT_EQ(3U, loaded.count());
+  ASSERT_EQ(nullptr, loaded.translator(1)->translate("baz"));
+  for (std::string key : {"foo", "bar", "baz"}) {
+    ASSERT_EQ(Slice(dictionary.translator()->translate(key)).getUInt(),
+              Slice(loaded.translator()->translate(key)).getUInt());
+  }
+
+  Builder empty;
+  AttributeDictionary().toVelocyPack(empty);
+  ASSERT_EQ("{\"versions\":[]}", empty.slice().toJson());
+}
+
+TEST(AttributeDictionaryTest, LoadInvalid) {
+  auto check = [](std::string const& json, Exception::ExceptionType type) {
+    AttributeDictionary dictionary;
+    auto b = Parser::fromJson(json);
+    ASSERT_VELOCYPACK_EXCEPTION(dictionary.fromVelocyPack(b->slice()), type);
+    ASSERT_EQ(0U, dictionary.version());
+  };
+
+  check("[]", Exception::InvalidValueType);
+  check("{}", Exception::InvalidValueType);
+  check("{\"versions\":[[]]}", Exception::InvalidValueType);
+  check("{\"versions\":[[1]]}", Exception::InvalidValueType);
+  check("{\"versions\":[[\"a\"],\"b\"]}", Exception::InvalidValueType);
+  check("{\"versions\":[[\"a\"],[\"a\"]]}", Exception::DuplicateAttributeName);
+
+  AttributeDictionary dictionary;
+  dictionary.add({"a"});
+  auto b = Parser::fromJson("{\"versions\":[[\"b\"]]}");
+  ASSERT_VELOCYPACK_EXCEPTION(dictionary.fromVelocyPack(b->slice()),
+                              Exception::InternalError);
+}
+
+TEST(AttributeDictionaryTest, ConcurrentReaders) {
+  AttributeDictionary dictionary;
+  std::atomic<bool> done(false);
+  std::atomic<bool> failed(false);
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        auto snapshot = dictionary.snapshot();
+        // all keys of a version must be translatable in both directions
+        for (uint64_t id = 1; id <= snapshot.translator->count(); ++id) {
+          uint8_t const* key = snapshot.translator->translate(id);
+          if (key == nullptr ||
+              snapshot.translator->translate(Slice(key).stringView()) == nullptr) {
+            failed.store(true);
+          }
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    std::string key = "key" + std::to_string(i);
+    dictionary.add({key});
+  }
+  done.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  ASSERT_FALSE(failed.load());
+  ASSERT_EQ(200U, dictionary.version());
+  ASSERT_EQ(200U, dictionary.count());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+
+#include "tests-common.h"
+
+TEST(AttributeTranslatorTest, Unsealed) {
+  AttributeTranslator translator;
+  translator.add("foo", 1);
+
+  ASSERT_EQ(nullptr, translator.translate("foo"));
+  ASSERT_EQ(nullptr, translator.translate(1));
+}
+
+TEST(AttributeTranslatorTest, Empty) {
+  AttributeTranslator translator;
+  translator.seal();
+
+  ASSERT_EQ(0U, translator.count());
+  ASSERT_EQ(nullptr, translator.translate("foo"));
+  ASSERT_EQ(nullptr, translator.translate(0));
+  ASSERT_EQ(0U, translator.statistics().keys);
+}
+
+TEST(AttributeTranslatorTest, TranslateMany) {
+  std::size_t const n = 5000;
+  AttributeTranslator translator;
+  for (std::size_t i = 1; i <= n; ++i) {
+    translator.add("key" + std::to_string(i), i);
+  }
+  translator.seal();
+
+  for (std::size_t i = 1; i <= n; ++i) {
+    std::string const key = "key" + std::to_string(i);
+    uint8_t const* id = translator.translate(key);
+    ASSERT_NE(nullptr, id);
+    ASSERT_EQ(i, Slice(id).getUInt());
+
+    uint8_t const* name = translator.translate(static_cast<uint64_t>(i));
+    ASSERT_NE(nullptr, name);
+    ASSERT_EQ(key, Slice(name).copyString());
+  }
+
+  ASSERT_EQ(nullptr, translator.translate("key0"));
+  ASSERT_EQ(nullptr, translator.translate(""));
+  ASSERT_EQ(nullptr, translator.translate("key50000"));
+  ASSERT_EQ(nullptr, translator.translate(static_cast<uint64_t>(0)));
+  ASSERT_EQ(nullptr, translator.translate(static_cast<uint64_t>(n + 1)));
+
+  auto const& stats = translator.statistics();
+  ASSERT_EQ(n, stats.keys);
+  ASSERT_EQ(n, stats.denseIds);
+  ASSERT_EQ(0U, stats.sparseIds);
+  ASSERT_LT(0U, stats.buckets);
+  ASSERT_LE(stats.buckets, n);
+}
+
+TEST(AttributeTranslatorTest, SparseIds) {
+  AttributeTranslator translator;
+  translator.add("a", 1);
+  translator.add("b", 1000000);
+  translator.add("c", UINT64_MAX);
+  translator.seal();
+
+  ASSERT_EQ("a", Slice(translator.translate(1)).copyString());
+  ASSERT_EQ("b", Slice(translator.translate(1000000)).copyString());
+  ASSERT_EQ("c", Slice(translator.translate(UINT64_MAX)).copyString());
+  ASSERT_EQ(nullptr, translator.translate(999999));
+  ASSERT_EQ(1000000U, Slice(translator.translate("b")).getUInt());
+
+  ASSERT_EQ(1U, translator.statistics().denseIds);
+  ASSERT_EQ(2U, translator.statistics().sparseIds);
+}
+
+TEST(AttributeTranslatorTest, DuplicateKeys) {
+  AttributeTranslator translator;
+  translator.add("a", 1);
+  translator.add("a", 2);
+  translator.add("b", 3);
+  translator.seal();
+
+  ASSERT_EQ(2U, translator.statistics().keys);
+  uint64_t id = Slice(translator.translate("a")).getUInt();
+  ASSERT_TRUE(id == 1 || id == 2);
+  ASSERT_EQ(3U, Slice(translator.translate("b")).getUInt());
+  ASSERT_EQ("a", Slice(translator.translate(1)).copyString());
+  ASSERT_EQ("a", Slice(translator.translate(2)).copyString());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
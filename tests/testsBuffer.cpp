@@ -28,6 +28,10 @@
 #include <string>
 #include <iostream>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
 #include "tests-common.h"
 
 TEST(BufferTest, CreateEmpty) {
@@ -536,6 +540,392 @@ TEST(BufferTest, BufferNonDeleterTest) {
   ASSERT_EQ(2308, buffer.size());
 }
 
+TEST(BufferTest, ExternalMemory) {
+  uint8_t memory[16];
+  Buffer<uint8_t> buffer(&memory[0], sizeof(memory));
+
+  ASSERT_TRUE(buffer.usesExternalMemory());
+  ASSERT_FALSE(buffer.usesLocalMemory());
+  ASSERT_EQ(&memory[0], buffer.data());
+  ASSERT_EQ(sizeof(memory), buffer.capacity());
+  ASSERT_EQ(0UL, buffer.size());
+
+  buffer.append("0123456789abcdef");
+  ASSERT_EQ(16UL, buffer.size());
+  ASSERT_EQ(&memory[0], buffer.data());
+  ASSERT_EQ(0, memcmp(memory, "0123456789abcdef", 16));
+
+  ASSERT_VELOCYPACK_EXCEPTION(buffer.push_back('x'),
+                              Exception::BufferCapacityExceeded);
+  ASSERT_EQ(16UL, buffer.size());
+
+  buffer.clear();
+  ASSERT_TRUE(buffer.usesExternalMemory());
+  ASSERT_EQ(&memory[0], buffer.data());
+  ASSERT_EQ(0UL, buffer.size());
+}
+
+TEST(BufferTest, ExternalMemoryInvalid) {
+  uint8_t memory[16];
+  ASSERT_VELOCYPACK_EXCEPTION(Buffer<uint8_t>(nullptr, 16),
+                              Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(Buffer<uint8_t>(&memory[0], 0),
+                              Exception::InternalError);
+}
+
+TEST(BufferTest, ExternalMemoryCopyAndMove) {
+  uint8_t memory[8];
+  Buffer<uint8_t> buffer(&memory[0], sizeof(memory));
+  buffer.append("test");
+
+  // copies own their memory
+  Buffer<uint8_t> copy(buffer);
+  ASSERT_FALSE(copy.usesExternalMemory());
+  ASSERT_EQ("test", copy.toString());
+  copy.append("a longer string that would not fit");
+
+  // moves take over the external memory
+  Buffer<uint8_t> moved(std::move(buffer));
+  ASSERT_TRUE(moved.usesExternalMemory());
+  ASSERT_EQ(&memory[0], moved.data());
+  ASSERT_EQ("test", moved.toString());
+  ASSERT_FALSE(buffer.usesExternalMemory());
+  ASSERT_EQ(0UL, buffer.size());
+
+  Buffer<uint8_t> assigned;
+  assigned = std::move(moved);
+  ASSERT_TRUE(assigned.usesExternalMemory());
+  ASSERT_EQ(&memory[0], assigned.data());
+  ASSERT_FALSE(moved.usesExternalMemory());
+
+  // copying into external memory works as long as the data fits
+  Buffer<uint8_t> small;
+  small.append("1234");
+  assigned = small;
+  ASSERT_EQ(&memory[0], assigned.data());
+  ASSERT_EQ("1234", assigned.toString());
+
+  ASSERT_VELOCYPACK_EXCEPTION(assigned = copy,
+                              Exception::BufferCapacityExceeded);
+  ASSERT_EQ(&memory[0], assigned.data());
+}
+
+TEST(BufferTest, ExternalMemorySharedSlice) {
+  uint8_t memory[32];
+  Buffer<uint8_t> buffer(&memory[0], sizeof(memory));
+  Builder b(buffer);
+  b.add(Value("foobar"));
+
+  // the SharedSlice must not take over the external memory
+  SharedSlice s(std::move(buffer));
+  ASSERT_NE(&memory[0], s.slice().start());
+  ASSERT_EQ("foobar", s.slice().copyString());
+}
+
+TEST(BufferTest, GrowthPolicyDefaults) {
+  BufferGrowthPolicy const& policy = BufferGrowthPolicy::Defaults;
+  ASSERT_EQ(1.5, policy.factor);
+  ASSERT_EQ(300UL, policy.nextCapacity(200, 201));
+  ASSERT_EQ(1000UL, policy.nextCapacity(200, 1000));
+
+  Buffer<uint8_t> buffer;
+  ASSERT_EQ(&BufferGrowthPolicy::Defaults, buffer.growthPolicy());
+  ASSERT_VELOCYPACK_EXCEPTION(buffer.setGrowthPolicy(nullptr),
+                              Exception::InternalError);
+}
+
+TEST(BufferTest, GrowthPolicy) {
+  BufferGrowthPolicy policy;
+  policy.factor = 2.0;
+  policy.maxStep = 1000;
+  policy.pageThreshold = 10000;
+  policy.pageSize = 4096;
+
+  ASSERT_EQ(400UL, policy.nextCapacity(200, 201));
+  // the step added by the factor is bounded
+  ASSERT_EQ(6000UL, policy.nextCapacity(5000, 5001));
+  // but never below what is required
+  ASSERT_EQ(7000UL, policy.nextCapacity(5000, 7000));
+  // big capacities are rounded to pages
+  ASSERT_EQ(12288UL, policy.nextCapacity(9500, 9501));
+  ASSERT_EQ(12288UL, policy.nextCapacity(11288, 11289));
+  ASSERT_EQ(16384UL, policy.nextCapacity(12000, 12001));
+
+  policy.factor = 0.5;
+  ASSERT_EQ(201UL, policy.nextCapacity(200, 201));
+
+  policy.factor = 2.0;
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  for (std::size_t i = 0; i < 20000; ++i) {
+    buffer.push_back('x');
+    ASSERT_TRUE(buffer.capacity() < 10000 || buffer.capacity() % 4096 == 0);
+  }
+
+  // copies take over the policy, assignments keep their own
+  Buffer<uint8_t> copy(buffer);
+  ASSERT_EQ(&policy, copy.growthPolicy());
+  Buffer<uint8_t> moved(std::move(copy));
+  ASSERT_EQ(&policy, moved.growthPolicy());
+  Buffer<uint8_t> assigned;
+  assigned = buffer;
+  ASSERT_EQ(&BufferGrowthPolicy::Defaults, assigned.growthPolicy());
+}
+
+TEST(BufferTest, ShrinkToFit) {
+  Buffer<uint8_t> buffer;
+  buffer.reserve(100000);
+  buffer.append("foobar");
+  ASSERT_LE(100000UL, buffer.capacity());
+
+  buffer.shrinkToFit(1000);
+  ASSERT_EQ(1000UL, buffer.capacity());
+  ASSERT_EQ("foobar", buffer.toString());
+
+  buffer.shrinkToFit();
+  // small contents go back into the local memory
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ("foobar", buffer.toString());
+
+  std::string const value(1000, 'x');
+  buffer.append(value);
+  buffer.reserve(100000);
+  buffer.shrinkToFit();
+  ASSERT_EQ(1006UL, buffer.capacity());
+  ASSERT_EQ(1006UL, buffer.size());
+  buffer.push_back('y');
+  ASSERT_EQ(1007UL, buffer.size());
+  ASSERT_EQ("foobar" + value + "y", buffer.toString());
+
+  buffer.reset();
+  buffer.shrinkToFit();
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ(0UL, buffer.size());
+  ASSERT_EQ(0x00, buffer.data()[0]);
+}
+
+TEST(BufferTest, ShrinkToFitExternalMemory) {
+  uint8_t memory[1024];
+  Buffer<uint8_t> buffer(&memory[0], sizeof(memory));
+  buffer.append("foobar");
+  buffer.shrinkToFit();
+  ASSERT_EQ(&memory[0], buffer.data());
+  ASSERT_EQ(sizeof(memory), buffer.capacity());
+}
+
+TEST(BufferTest, SizeHint) {
+  SizeHint hint;
+  ASSERT_EQ(0UL, hint.estimate());
+  hint.update(1000);
+  ASSERT_EQ(1000UL, hint.estimate());
+  hint.update(5000);
+  ASSERT_EQ(5000UL, hint.estimate());
+  hint.update(1000);
+  ASSERT_EQ(4000UL, hint.estimate());
+  for (int i = 0; i < 100; ++i) {
+    hint.update(1000);
+  }
+  ASSERT_GT(1010UL, hint.estimate());
+  ASSERT_LE(1000UL, hint.estimate());
+}
+
+TEST(BufferTest, ResetWithSizeHint) {
+  SizeHint hint;
+  Buffer<uint8_t> buffer;
+
+  buffer.append(std::string(100000, 'x'));
+  buffer.reset(hint);
+  ASSERT_EQ(0UL, buffer.size());
+  ASSERT_EQ(100000UL, hint.estimate());
+  // enough room for the next value of the same size
+  uint8_t const* data = buffer.data();
+  buffer.append(std::string(100000, 'x'));
+  ASSERT_EQ(data, buffer.data());
+
+  // after many small values, the memory is released
+  for (int i = 0; i < 50; ++i) {
+    buffer.reset(hint);
+    buffer.append(std::string(1000, 'x'));
+  }
+  ASSERT_GT(10000UL, buffer.capacity());
+  ASSERT_EQ(std::string(1000, 'x'), buffer.toString());
+}
+
+TEST(BufferTest, MappedMemory) {
+  BufferGrowthPolicy policy;
+  policy.mapThreshold = 1024 * 1024;
+
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  std::string expected;
+  for (std::size_t i = 0; i < 100000; ++i) {
+    std::string const value = std::to_string(i);
+    buffer.append(value);
+    expected.append(value);
+    ASSERT_EQ(buffer.size() >= policy.mapThreshold && MappedMemory::supported(),
+              buffer.usesMappedMemory());
+  }
+  // grow through several remaps, which keep the huge page alignment
+  for (std::size_t i = 0; i < 5; ++i) {
+    buffer.append(expected);
+    if (buffer.usesMappedMemory()) {
+      ASSERT_EQ(0UL, reinterpret_cast<uintptr_t>(buffer.data()) % (2 * 1024 * 1024));
+    }
+  }
+  ASSERT_EQ(MappedMemory::supported(), buffer.usesMappedMemory());
+  if (buffer.usesMappedMemory()) {
+    ASSERT_EQ(0UL, buffer.capacity() % (2 * 1024 * 1024));
+  }
+  std::string const all = buffer.toString();
+  ASSERT_EQ(6 * expected.size(), all.size());
+  for (std::size_t i = 0; i < 6; ++i) {
+    ASSERT_EQ(expected, all.substr(i * expected.size(), expected.size()));
+  }
+
+  // copies do not map memory, moves take the mapping over
+  Buffer<uint8_t> copy(buffer);
+  ASSERT_FALSE(copy.usesMappedMemory());
+  ASSERT_EQ(all, copy.toString());
+  Buffer<uint8_t> moved(std::move(buffer));
+  ASSERT_EQ(MappedMemory::supported(), moved.usesMappedMemory());
+  ASSERT_FALSE(buffer.usesMappedMemory());
+  ASSERT_EQ(all, moved.toString());
+  buffer = std::move(moved);
+  ASSERT_EQ(MappedMemory::supported(), buffer.usesMappedMemory());
+  ASSERT_EQ(all, buffer.toString());
+
+  buffer.clear();
+  ASSERT_FALSE(buffer.usesMappedMemory());
+  ASSERT_TRUE(buffer.usesLocalMemory());
+}
+
+TEST(BufferTest, MappedMemoryShrinkToFit) {
+  BufferGrowthPolicy policy;
+  policy.mapThreshold = 1024 * 1024;
+
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  buffer.reserve(8 * 1024 * 1024);
+  std::string const value(3 * 1024 * 1024, 'x');
+  buffer.append(value);
+  if (!buffer.usesMappedMemory()) {
+    return;
+  }
+  ASSERT_EQ(8UL * 1024 * 1024, buffer.capacity());
+
+  buffer.shrinkToFit();
+  ASSERT_TRUE(buffer.usesMappedMemory());
+  ASSERT_EQ(4UL * 1024 * 1024, buffer.capacity());
+  ASSERT_EQ(value, buffer.toString());
+
+  buffer.reset();
+  buffer.append("foo");
+  buffer.shrinkToFit();
+  ASSERT_FALSE(buffer.usesMappedMemory());
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ("foo", buffer.toString());
+}
+
+TEST(BufferTest, MappedMemoryWithoutHugePages) {
+  BufferGrowthPolicy policy;
+  policy.mapThreshold = 100000;
+  policy.hugePages = false;
+  policy.numaNode = 0;
+
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  std::string const value(150000, 'x');
+  buffer.append(value);
+  ASSERT_EQ(MappedMemory::supported(), buffer.usesMappedMemory());
+  if (buffer.usesMappedMemory()) {
+    ASSERT_EQ(0UL, buffer.capacity() % 4096);
+    ASSERT_GT(2UL * 1024 * 1024, buffer.capacity());
+  }
+  ASSERT_EQ(value, buffer.toString());
+}
+
+#if defined(__linux__) && defined(MAP_FIXED_NOREPLACE)
+TEST(BufferTest, MappedMemoryRemapAligned) {
+  BufferGrowthPolicy policy;
+  ValueLength const size = 2 * 1024 * 1024;
+  uint8_t* p = static_cast<uint8_t*>(MappedMemory::map(size, policy));
+  ASSERT_NE(nullptr, p);
+  memset(p, 'x', size);
+
+  // a mapping right behind the first one prevents growing in place
+  void* blocker = mmap(p + size, 4096, PROT_READ,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if (blocker != p + size) {
+    if (blocker != MAP_FAILED) {
+      munmap(blocker, 4096);
+    }
+    MappedMemory::unmap(p, size);
+    return;
+  }
+
+  uint8_t* q = static_cast<uint8_t*>(MappedMemory::remap(p, size, 3 * size, policy));
+  ASSERT_NE(nullptr, q);
+  ASSERT_NE(p, q);
+  ASSERT_EQ(0UL, reinterpret_cast<uintptr_t>(q) % size);
+  for (ValueLength i = 0; i < size; ++i) {
+    ASSERT_EQ('x', q[i]);
+  }
+  memset(q + size, 'y', 2 * size);
+  MappedMemory::unmap(q, 3 * size);
+  munmap(blocker, 4096);
+}
+#endif
+
+TEST(BufferTest, MappedMemorySteal) {
+  BufferGrowthPolicy policy;
+  policy.mapThreshold = 1024 * 1024;
+  std::string const value(2 * 1024 * 1024, 'x');
+
+  // steal() always hands out memory for velocypack_free()
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  buffer.append(value);
+  ASSERT_EQ(MappedMemory::supported(), buffer.usesMappedMemory());
+  uint8_t* p = buffer.steal();
+  ASSERT_FALSE(buffer.usesMappedMemory());
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ(value, std::string(reinterpret_cast<char const*>(p), value.size()));
+  velocypack_free(p);
+
+  // stealMapping() hands out the mapping itself
+  buffer.append(value);
+  if (!buffer.usesMappedMemory()) {
+    return;
+  }
+  uint8_t const* data = buffer.data();
+  ValueLength const expectedCapacity = buffer.capacity();
+  ValueLength capacity = 0;
+  p = buffer.stealMapping(capacity);
+  ASSERT_EQ(data, p);
+  ASSERT_EQ(expectedCapacity, capacity);
+  ASSERT_FALSE(buffer.usesMappedMemory());
+  ASSERT_TRUE(buffer.usesLocalMemory());
+  ASSERT_EQ(value, std::string(reinterpret_cast<char const*>(p), value.size()));
+  MappedMemory::unmap(p, capacity);
+}
+
+TEST(BufferTest, MappedMemorySharedSlice) {
+  BufferGrowthPolicy policy;
+  policy.mapThreshold = 1024 * 1024;
+
+  Buffer<uint8_t> buffer;
+  buffer.setGrowthPolicy(&policy);
+  Builder b(buffer);
+  b.add(Value(std::string(2 * 1024 * 1024, 'x')));
+  ASSERT_EQ(MappedMemory::supported(), buffer.usesMappedMemory());
+  uint8_t const* data = buffer.data();
+
+  // the SharedSlice takes over the mapping
+  SharedSlice s(std::move(buffer));
+  ASSERT_EQ(data, s.slice().start());
+  ASSERT_EQ(2UL * 1024 * 1024, s.slice().getStringLength());
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
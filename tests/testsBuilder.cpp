@@ -26,9 +26,11 @@
 
 #include <array>
 #include <iostream>
+#include <limits>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "tests-common.h"
 
@@ -3720,6 +3722,698 @@ TEST(BuilderTest, syntacticSugar) {
   ASSERT_EQ("Gustav", b.slice().get("name").copyString());
 }
 
+static void buildLogDocuments(Builder& b, int count) {
+  std::string const tenant("tenant-0123456789abcdef");
+  b.openArray();
+  for (int i = 0; i < count; ++i) {
+    b.openObject();
+    b.add("tenant", Value(tenant));
+    b.add("status", Value(i % 3 == 0 ? "200 - everything is fine" : "404 - the page was not found"));
+    b.add("url", ValuePair("https://example.com/some/long/path", 34, ValueType::String));
+    b.add("short", Value("abc"));
+    b.add("n", Value(i));
+    b.add("owner", Value(tenant));
+    b.add("referrer", Value("https://example.com/some/long/path"));
+    b.add("tags", Value(ValueType::Array, i % 2 == 0));
+    b.add(Value("https://example.com/some/long/path"));
+    b.add(Value(tenant));
+    b.add(Value(std::string(i, 'x')));
+    b.add(Value(tenant));
+    b.close();
+    b.close();
+  }
+  b.close();
+}
+
+TEST(BuilderTest, StringDeduplicationDisabledByDefault) {
+  StringReferencesScope scope;
+  Builder b;
+  buildLogDocuments(b, 10);
+
+  Slice s = b.slice();
+  ASSERT_TRUE(s.at(5).get("tenant").isString());
+  for (std::size_t i = 0; i + 3 < b.size(); ++i) {
+    ASSERT_FALSE(Slice(b.data() + i).isStringReference());
+  }
+}
+
+TEST(BuilderTest, StringDeduplication) {
+  StringReferencesScope scope;
+  Builder plain;
+  buildLogDocuments(plain, 200);
+
+  Options options;
+  options.deduplicateStrings = true;
+  Builder b(&options);
+  buildLogDocuments(b, 200);
+
+  ASSERT_LT(b.size(), plain.size() * 9 / 10);
+  ASSERT_EQ(plain.slice().toJson(), b.slice().toJson());
+  ASSERT_TRUE(NormalizedCompare::equals(plain.slice(), b.slice()));
+  ASSERT_EQ(plain.slice().normalizedHash(), b.slice().normalizedHash());
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(b.data(), b.size()));
+
+  Slice s = b.slice();
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    Slice doc = s.at(i);
+    ASSERT_TRUE(doc.get("tenant").isString());
+    ASSERT_EQ("tenant-0123456789abcdef", doc.get("tenant").stringView());
+    ASSERT_EQ("https://example.com/some/long/path", doc.get("url").stringView());
+    ASSERT_EQ("abc", doc.get("short").stringView());
+    ASSERT_EQ("tenant-0123456789abcdef", doc.get("owner").stringView());
+    ASSERT_EQ("https://example.com/some/long/path", doc.get("referrer").stringView());
+    ASSERT_EQ("https://example.com/some/long/path", doc.get("tags").at(0).stringView());
+    ASSERT_EQ("tenant-0123456789abcdef", doc.get("tags")[1].stringView());
+    ASSERT_EQ("tenant-0123456789abcdef", doc.get("tags")[3].stringView());
+    for (auto it : ArrayIterator(doc.get("tags"))) {
+      ASSERT_TRUE(it.isString());
+    }
+    for (auto it : ObjectIterator(doc)) {
+      ASSERT_FALSE(it.value.isTagged());
+    }
+    for (auto it : ObjectIterator(doc, true)) {
+      ASSERT_FALSE(it.value.isTagged());
+    }
+    for (ValueLength j = 0; j < doc.length(); ++j) {
+      ASSERT_FALSE(doc.valueAt(j).isTagged());
+    }
+  }
+
+  // references only point to Strings of the same Array or Object
+  Slice second = s.at(1);
+  ASSERT_FALSE(second.getUnresolved("tenant").isStringReference());
+  ASSERT_FALSE(second.getUnresolved("url").isStringReference());
+  ASSERT_FALSE(second.getUnresolved("short").isStringReference());
+  ASSERT_TRUE(second.getUnresolved("owner").isStringReference());
+  ASSERT_TRUE(second.getUnresolved("referrer").isStringReference());
+  ASSERT_EQ(second.get("tenant").start(), second.get("owner").start());
+  Slice tags = second.get("tags");
+  ASSERT_FALSE(Slice(tags.begin() + tags.getNthOffset(0)).isStringReference());
+  ASSERT_FALSE(Slice(tags.begin() + tags.getNthOffset(1)).isStringReference());
+  ASSERT_TRUE(Slice(tags.begin() + tags.getNthOffset(3)).isStringReference());
+  ASSERT_EQ(tags.at(1).start(), tags.at(3).start());
+}
+
+TEST(BuilderTest, StringDeduplicationCopySubValue) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+
+  std::string const value("a string that is long enough");
+  Builder b(&options);
+  b.openObject();
+  b.add("x", Value(value));
+  b.add("sub", Value(ValueType::Object));
+  b.add("y", Value(value));
+  b.add("z", Value(value));
+  b.close();
+  b.add("list", Value(ValueType::Array));
+  b.add(Value(value));
+  b.openArray();
+  b.add(Value(value));
+  b.close();
+  b.close();
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_TRUE(s.get("sub").getUnresolved("z").isStringReference());
+  ASSERT_FALSE(s.get("sub").getUnresolved("y").isStringReference());
+
+  for (Slice sub : {s.get("sub"), s.get("list"), s.get("list").at(1)}) {
+    Builder copy;
+    copy.add(sub);
+    Validator validator;
+    ASSERT_TRUE(validator.validate(copy.data(), copy.size()));
+    ASSERT_TRUE(copy.slice().binaryEquals(sub));
+    ASSERT_EQ(sub.toJson(), copy.slice().toJson());
+  }
+
+  Builder copy;
+  copy.add(s.get("sub"));
+  ASSERT_TRUE(copy.slice().get("y").isString());
+  ASSERT_EQ(value, copy.slice().get("z").stringView());
+}
+
+TEST(BuilderTest, StringDeduplicationResolvingDisabled) {
+  Options options;
+  options.deduplicateStrings = true;
+
+  // nothing is deduplicated if references would not be resolved
+  Builder b(&options);
+  buildLogDocuments(b, 10);
+  Builder plain;
+  buildLogDocuments(plain, 10);
+  ASSERT_TRUE(b.slice().binaryEquals(plain.slice()));
+
+  // tag 255 is a regular tag then
+  std::string const value("\x02\x0a\x43" "abc" "\xee\xff\x28\x04", 10);
+  Slice s(reinterpret_cast<uint8_t const*>(value.data()));
+  ASSERT_FALSE(s.at(1).isStringReference());
+  ASSERT_TRUE(s.at(1).isTagged());
+  ASSERT_EQ(255UL, s.at(1).getFirstTag());
+  ASSERT_EQ(4UL, s.at(1).value().getUInt());
+
+  {
+    StringReferencesScope scope;
+    ASSERT_TRUE(s.at(1).isString());
+
+    // only tagged UInt values are references
+    std::string const other("\x02\x0a\x43" "abc" "\xee\xff\x34\x04", 10);
+    Slice o(reinterpret_cast<uint8_t const*>(other.data()));
+    ASSERT_FALSE(o.at(1).isStringReference());
+    ASSERT_TRUE(o.at(1).isTagged());
+    ASSERT_EQ(4, o.at(1).value().getSmallInt());
+  }
+}
+
+TEST(BuilderTest, StringDeduplicationOptions) {
+  StringReferencesScope scope;
+  // all combinations of options that move data when closing compounds
+  for (auto padding : {Options::NoPadding, Options::Flexible}) {
+    for (int unindexed = 0; unindexed < 4; ++unindexed) {
+      Options plainOptions;
+      plainOptions.paddingBehavior = padding;
+      plainOptions.buildUnindexedArrays = (unindexed & 1) != 0;
+      plainOptions.buildUnindexedObjects = (unindexed & 2) != 0;
+      Options options = plainOptions;
+      options.deduplicateStrings = true;
+
+      for (int count : {1, 2, 5, 50, 300}) {
+        Builder plain(&plainOptions);
+        buildLogDocuments(plain, count);
+        Builder b(&options);
+        buildLogDocuments(b, count);
+
+        Validator validator;
+        ASSERT_TRUE(validator.validate(b.data(), b.size()));
+        ASSERT_EQ(plain.slice().toJson(), b.slice().toJson());
+      }
+    }
+  }
+}
+
+TEST(BuilderTest, StringDeduplicationMinLength) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+  options.deduplicateStringsMinLength = 4;
+
+  Builder b(&options);
+  b.openArray();
+  b.add(Value("abc"));
+  b.add(Value("abc"));
+  b.add(Value("abcd"));
+  b.add(Value("abcd"));
+  b.close();
+
+  Builder plain;
+  plain.openArray();
+  plain.add(Value("abc"));
+  plain.add(Value("abc"));
+  plain.add(Value("abcd"));
+  plain.add(Value("abcd"));
+  plain.close();
+
+  // only the second "abcd" is replaced by a 4 byte reference
+  Slice s = b.slice();
+  ASSERT_EQ(4UL, s.length());
+  ASSERT_EQ(plain.size() - 1, b.size());
+  ASSERT_TRUE(Slice(s.start() + 3 + 4 + 4 + 5).isStringReference());
+  ASSERT_EQ("[\"abc\",\"abc\",\"abcd\",\"abcd\"]", s.toJson());
+}
+
+TEST(BuilderTest, StringDeduplicationKeysAndTags) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+  options.deduplicateStringsMinLength = 1;
+
+  Builder b(&options);
+  b.openObject();
+  b.add("some-long-attribute", Value("some-long-attribute"));
+  b.add("other", Value("some-long-attribute"));
+  b.addTagged("tagged", 42, Value("some-long-attribute"));
+  b.add("nested", Value(ValueType::Object));
+  b.add("some-long-attribute", Value("some-long-attribute"));
+  b.close();
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ("some-long-attribute", s.keyAt(2).stringView());
+  ASSERT_TRUE(s.getUnresolved("other").isStringReference());
+  ASSERT_TRUE(s.get("tagged").isTagged());
+  ASSERT_EQ(42, s.get("tagged").getFirstTag());
+  ASSERT_EQ("some-long-attribute", s.get("tagged").value().stringView());
+  // no references into the enclosing Object
+  ASSERT_FALSE(s.get("nested").getUnresolved("some-long-attribute").isStringReference());
+  ASSERT_EQ("some-long-attribute", s.get("nested").get("some-long-attribute").stringView());
+  ASSERT_EQ("some-long-attribute", s.get(std::vector<std::string>{"nested", "some-long-attribute"}).stringView());
+}
+
+TEST(BuilderTest, StringDeduplicationTopLevelValues) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+
+  Buffer<uint8_t> buffer;
+  Builder b(buffer, &options);
+  for (int i = 0; i < 2; ++i) {
+    b.openArray();
+    b.add(Value("this is a long string value"));
+    b.add(Value("this is a long string value"));
+    b.close();
+  }
+
+  // the second top-level value does not reference the first one
+  Slice first(buffer.data());
+  Slice second(buffer.data() + first.byteSize());
+  ASSERT_EQ(first.byteSize(), second.byteSize());
+  ASSERT_TRUE(second.at(0).start() > first.start() + first.byteSize());
+  Validator validator;
+  ASSERT_TRUE(validator.validate(second.start(), second.byteSize()));
+  ASSERT_EQ("[\"this is a long string value\",\"this is a long string value\"]", second.toJson());
+
+  // a cleared Builder does not reference old values
+  b.clear();
+  b.openArray();
+  b.add(Value("this is a long string value"));
+  b.close();
+  ASSERT_TRUE(b.slice().at(0).isString());
+  ASSERT_EQ(b.slice().at(0).start(), b.slice().start() + 2);
+}
+
+TEST(BuilderTest, StringDeduplicationParser) {
+  StringReferencesScope scope;
+  std::string const json(R"([{"level":"information","message":"connection established","tenant":"tenant-0123456789"},{"level":"information","message":"connection established","tenant":"tenant-0123456789","translated":"connection established","user":"tenant-0123456789"},"connection established","connection established"])");
+
+  Options options;
+  options.deduplicateStrings = true;
+  Parser parser(&options);
+  parser.parse(json);
+  std::shared_ptr<Builder> b = parser.steal();
+
+  Parser plain;
+  plain.parse(json);
+  ASSERT_LT(b->size(), plain.steal()->size());
+
+  Slice s = b->slice();
+  ASSERT_FALSE(s.at(1).getUnresolved("message").isStringReference());
+  ASSERT_FALSE(s.at(1).getUnresolved("tenant").isStringReference());
+  ASSERT_TRUE(s.at(1).getUnresolved("translated").isStringReference());
+  ASSERT_TRUE(s.at(1).getUnresolved("user").isStringReference());
+  // Strings nested in the same Array can be referenced
+  ASSERT_TRUE(Slice(s.begin() + s.getNthOffset(2)).isStringReference());
+  ASSERT_TRUE(Slice(s.begin() + s.getNthOffset(3)).isStringReference());
+  // shorter than deduplicateStringsMinLength
+  ASSERT_FALSE(s.at(1).getUnresolved("level").isStringReference());
+  ASSERT_EQ(json, s.toJson());
+  Validator validator;
+  ASSERT_TRUE(validator.validate(b->data(), b->size()));
+}
+
+TEST(BuilderTest, SavepointTopLevel) {
+  Builder b;
+  b.add(Value(1));
+  auto sp = b.savepoint();
+  b.add(Value("foo"));
+  b.openArray();
+  b.add(Value(2));
+  b.close();
+
+  b.rollback(sp);
+  ASSERT_TRUE(b.isClosed());
+  ASSERT_EQ(1UL, b.size());
+  ASSERT_EQ(1UL, b.slice().getUInt());
+
+  // rolling back is also possible from inside open values
+  b.openObject();
+  b.add("foo", Value(ValueType::Array));
+  b.add(Value(1));
+  b.rollback(sp);
+  ASSERT_TRUE(b.isClosed());
+  ASSERT_EQ(1UL, b.size());
+
+  b.add(Value(2));
+  ASSERT_EQ(2UL, b.size());
+}
+
+TEST(BuilderTest, SavepointInsideObject) {
+  Builder expected;
+  expected.openObject();
+  expected.add("a", Value(1));
+  expected.add("c", Value(ValueType::Array));
+  expected.add(Value(3));
+  expected.close();
+  expected.close();
+
+  Builder b;
+  b.openObject();
+  b.add("a", Value(1));
+  auto sp = b.savepoint();
+  b.add("b", Value(ValueType::Object));
+  b.add("x", Value("a string value"));
+  b.add("y", Value(ValueType::Array));
+  b.add(Value(1));
+  b.add(Value(2));
+  b.close();
+  b.close();
+  b.add("z", Value(2));
+  b.rollback(sp);
+  ASSERT_TRUE(b.isOpenObject());
+  b.add("c", Value(ValueType::Array));
+  b.add(Value(3));
+  b.close();
+  b.close();
+
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+}
+
+TEST(BuilderTest, SavepointAfterKey) {
+  Builder b;
+  b.openObject();
+  b.add(Value("key"));
+  auto sp = b.savepoint();
+  b.add(Value(ValueType::Array));
+  b.add(Value(1));
+  b.rollback(sp);
+  b.add(Value("value"));
+  b.close();
+
+  ASSERT_EQ(1UL, b.slice().length());
+  ASSERT_EQ("value", b.slice().get("key").copyString());
+}
+
+TEST(BuilderTest, SavepointSpeculativeBatch) {
+  Builder expected;
+  expected.openArray();
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    auto sp = b.savepoint();
+    b.openObject();
+    b.add("_key", Value(std::to_string(i)));
+    b.add("value", Value(i));
+    if (i % 3 == 0) {
+      // skip this document after having written parts of it
+      b.rollback(sp);
+      continue;
+    }
+    b.close();
+
+    expected.openObject();
+    expected.add("_key", Value(std::to_string(i)));
+    expected.add("value", Value(i));
+    expected.close();
+  }
+  b.close();
+  expected.close();
+
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+  ASSERT_EQ(66UL, b.slice().length());
+}
+
+TEST(BuilderTest, SavepointInvalid) {
+  Builder b;
+  b.openArray();
+  auto sp = b.savepoint();
+  b.add(Value(1));
+  b.close();
+
+  // the Array that was open when taking the savepoint is closed now
+  ASSERT_VELOCYPACK_EXCEPTION(b.rollback(sp),
+                              Exception::BuilderInvalidSavepoint);
+
+  b.openArray();
+  b.add(Value(1));
+  ASSERT_VELOCYPACK_EXCEPTION(b.rollback(sp),
+                              Exception::BuilderInvalidSavepoint);
+  b.close();
+
+  b.clear();
+  ASSERT_VELOCYPACK_EXCEPTION(b.rollback(sp),
+                              Exception::BuilderInvalidSavepoint);
+}
+
+TEST(BuilderTest, SavepointStringDeduplication) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+
+  std::string const value("a string that is long enough");
+  Builder b(&options);
+  b.openArray();
+  b.add(Value(value));
+  auto sp = b.savepoint();
+  b.openArray();
+  b.add(Value("another long enough string value"));
+  b.close();
+  b.rollback(sp);
+  b.add(Value("another long enough string value"));
+  b.add(Value(value));
+  b.close();
+
+  Validator validator(&options);
+  ASSERT_TRUE(validator.validate(b.slice().start(), b.size()));
+  ASSERT_EQ(3UL, b.slice().length());
+  ASSERT_EQ(value, b.slice().at(0).copyString());
+  ASSERT_EQ("another long enough string value", b.slice().at(1).copyString());
+  ASSERT_EQ(value, b.slice().at(2).copyString());
+
+  // the String in the discarded Array must not be referenced
+  Slice s = b.slice();
+  ASSERT_FALSE(Slice(s.begin() + s.getNthOffset(1)).isStringReference());
+  ASSERT_TRUE(Slice(s.begin() + s.getNthOffset(2)).isStringReference());
+}
+
+namespace {
+
+template <typename T>
+void checkAddArray(std::vector<T> const& values, Options const* options,
+                   bool unindexed = false) {
+  Builder expected(options);
+  expected.openArray(unindexed);
+  for (auto const& v : values) {
+    expected.add(Value(v));
+  }
+  expected.close();
+
+  Builder b(options);
+  uint8_t* p = b.addArray(values, unindexed);
+  ASSERT_EQ(b.data(), p);
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()))
+      << HexDump(b.slice()) << " != " << HexDump(expected.slice());
+
+  Validator validator(options);
+  ASSERT_TRUE(validator.validate(b.slice().start(), b.size()));
+}
+
+template <typename T>
+void checkAddArrayOptions(std::vector<T> const& values) {
+  for (auto padding : {Options::PaddingBehavior::Flexible,
+                       Options::PaddingBehavior::NoPadding,
+                       Options::PaddingBehavior::UsePadding}) {
+    Options options;
+    options.paddingBehavior = padding;
+    checkAddArray(values, &options);
+    checkAddArray(values, &options, true);
+    options.buildUnindexedArrays = true;
+    checkAddArray(values, &options);
+  }
+}
+
+template <typename T>
+std::vector<T> mixedNumbers(std::size_t n) {
+  std::vector<T> values;
+  for (std::size_t i = 0; i < n; ++i) {
+    T v = static_cast<T>(i * i * 37 + i);
+    if (std::is_signed_v<T> && i % 3 == 0) {
+      v = static_cast<T>(0 - v);
+    }
+    values.push_back(v);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(BuilderTest, AddArrayIntegral) {
+  for (std::size_t n : {0, 1, 2, 5, 40, 1000, 30000}) {
+    checkAddArrayOptions(mixedNumbers<int64_t>(n));
+    checkAddArrayOptions(mixedNumbers<uint64_t>(n));
+    checkAddArrayOptions(mixedNumbers<int32_t>(n));
+    checkAddArrayOptions(mixedNumbers<uint32_t>(n));
+    checkAddArrayOptions(mixedNumbers<int16_t>(n));
+    checkAddArrayOptions(mixedNumbers<uint16_t>(n));
+    checkAddArrayOptions(mixedNumbers<int8_t>(n));
+    checkAddArrayOptions(mixedNumbers<uint8_t>(n));
+  }
+  checkAddArrayOptions(std::vector<int64_t>{
+      0, 9, 10, -6, -7, 127, 128, -128, -129, 32767, 32768,
+      std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()});
+  checkAddArrayOptions(std::vector<uint64_t>{
+      0, 9, 10, 255, 256, std::numeric_limits<uint64_t>::max()});
+  // all members have the same size, so there is no index table
+  checkAddArrayOptions(std::vector<int64_t>(100, 3));
+  checkAddArrayOptions(std::vector<int64_t>(100000, 12345));
+}
+
+TEST(BuilderTest, AddArrayFloatingPoint) {
+  for (std::size_t n : {0, 1, 2, 5, 40, 1000, 30000}) {
+    std::vector<double> values;
+    std::vector<float> floats;
+    for (std::size_t i = 0; i < n; ++i) {
+      values.push_back(i * 1.5 - 100.25);
+      floats.push_back(static_cast<float>(i) * 0.5f);
+    }
+    checkAddArrayOptions(values);
+    checkAddArrayOptions(floats);
+  }
+}
+
+TEST(BuilderTest, AddArrayStrings) {
+  for (std::size_t n : {0, 1, 2, 5, 40, 1000, 3000}) {
+    std::vector<std::string> values;
+    for (std::size_t i = 0; i < n; ++i) {
+      values.push_back(std::string(i % 200, 'a' + i % 26));
+    }
+    std::vector<std::string_view> views(values.begin(), values.end());
+    checkAddArrayOptions(values);
+    checkAddArrayOptions(views);
+  }
+  checkAddArrayOptions(std::vector<std::string>(10, "same length"));
+}
+
+TEST(BuilderTest, AddArrayStringDeduplication) {
+  StringReferencesScope scope;
+  Options options;
+  options.deduplicateStrings = true;
+  std::vector<std::string> values(10, "a string that is long enough");
+  checkAddArray(values, &options);
+
+  Builder b(&options);
+  b.addArray(values);
+  ASSERT_TRUE(Slice(b.slice().begin() + b.slice().getNthOffset(1))
+                  .isStringReference());
+}
+
+TEST(BuilderTest, AddArrayNested) {
+  std::vector<int> values{1, 2, 300, -4};
+
+  Builder expected;
+  expected.openObject();
+  expected.add("a", Value(ValueType::Array));
+  for (int v : values) {
+    expected.add(Value(v));
+  }
+  expected.close();
+  expected.add("b", Value(ValueType::Array));
+  expected.openArray();
+  for (int v : values) {
+    expected.add(Value(v));
+  }
+  expected.close();
+  expected.openArray();
+  expected.close();
+  expected.close();
+  expected.add(Value("c"));
+  expected.openArray(true);
+  for (int v : values) {
+    expected.add(Value(v));
+  }
+  expected.close();
+  expected.close();
+
+  Builder b;
+  b.openObject();
+  b.addArray("a", values);
+  b.add("b", Value(ValueType::Array));
+  b.addArray(values.data(), values.size());
+  b.addArray(values.data(), 0);
+  b.close();
+  b.add(Value("c"));
+  b.addArray(values, true);
+  b.close();
+
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+  ASSERT_EQ(3UL, b.slice().length());
+  ASSERT_EQ(300, b.slice().get("a").at(2).getInt());
+}
+
+TEST(BuilderTest, AddArrayInvalid) {
+  std::vector<int> values{1, 2, 3};
+
+  Builder b;
+  b.openObject();
+  ASSERT_VELOCYPACK_EXCEPTION(b.addArray(values),
+                              Exception::BuilderKeyMustBeString);
+  b.close();
+  ASSERT_EQ(1UL, b.size());
+
+  b.clear();
+  b.openArray();
+  ASSERT_VELOCYPACK_EXCEPTION(b.addArray("foo", values),
+                              Exception::BuilderNeedOpenObject);
+  b.close();
+  ASSERT_EQ(0UL, b.slice().length());
+}
+
+TEST(BuilderTest, ShrinkToFit) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 1000; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  std::string const expected = b.slice().toJson();
+
+  b.shrinkToFit();
+  ASSERT_EQ(b.size(), b.bufferRef().capacity());
+  ASSERT_EQ(expected, b.slice().toJson());
+
+  // the Builder must remain usable after shrinking
+  b.add(Value("foo"));
+  ASSERT_EQ("\"foo\"", Slice(b.start() + b.slice().byteSize()).toJson());
+
+  b.clear();
+  b.shrinkToFit();
+  ASSERT_TRUE(b.bufferRef().usesLocalMemory());
+  b.add(Value(1));
+  ASSERT_EQ(1, b.slice().getInt());
+}
+
+TEST(BuilderTest, ClearWithSizeHint) {
+  SizeHint hint;
+  Builder b;
+  for (int round = 0; round < 3; ++round) {
+    b.openArray();
+    for (int i = 0; i < 10000; ++i) {
+      b.add(Value(i));
+    }
+    b.close();
+    ValueLength const size = b.size();
+    uint8_t const* data = b.data();
+    b.clear(hint);
+    ASSERT_EQ(size, hint.estimate());
+    ASSERT_LT(size, b.bufferRef().capacity());
+    if (round > 0) {
+      // the memory is kept and large enough for the next value
+      ASSERT_EQ(data, b.data());
+    }
+  }
+
+  for (int round = 0; round < 50; ++round) {
+    b.add(Value("small"));
+    b.clear(hint);
+  }
+  ASSERT_GT(1000UL, b.bufferRef().capacity());
+  b.add(Value("small"));
+  ASSERT_EQ("small", b.slice().copyString());
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
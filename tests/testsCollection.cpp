@@ -24,6 +24,7 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <array>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -2114,6 +2115,299 @@ TEST(CollectionTest, SortNonArray) {
   ASSERT_VELOCYPACK_EXCEPTION(Collection::sort(b.slice(), &lt), Exception::InvalidValueType);
 }
 
+TEST(CollectionTest, SortDefaultOrder) {
+  auto b = Parser::fromJson("[\"b\",3,null,[1],true,1.5,\"a\",{\"a\":1},-4]");
+  Builder sorted = Collection::sort(b->slice());
+  ASSERT_EQ("[null,true,-4,1.5,3,\"a\",\"b\",[1],{\"a\":1}]", sorted.slice().toJson());
+}
+
+TEST(CollectionTest, SortParallel) {
+  int64_t const n = 100003;
+  Builder b;
+  b.openArray();
+  for (int64_t i = 0; i < n; ++i) {
+    b.add(Value((i * 7919) % n));
+  }
+  b.close();
+
+  for (std::size_t threads : { 1, 2, 3, 4, 7 }) {
+    Builder sorted = Collection::sortParallel(b.slice(), &lt, threads);
+    Slice const s(sorted.slice());
+    ASSERT_TRUE(s.isArray());
+    ASSERT_EQ(static_cast<uint64_t>(n), s.length());
+    int64_t expected = 0;
+    for (auto it : ArrayIterator(s)) {
+      ASSERT_EQ(expected, it.getInt());
+      ++expected;
+    }
+  }
+}
+
+TEST(CollectionTest, SortParallelComparatorThrows) {
+  int64_t const n = 100003;
+  Builder b;
+  b.openArray();
+  for (int64_t i = 0; i < n; ++i) {
+    b.add(Value((i * 7919) % n));
+  }
+  b.close();
+
+  // the exception thrown on a sorting thread reaches the caller
+  auto throwing = [](Slice const& lhs, Slice const& rhs) -> bool {
+    if (lhs.getInt() == 4711 || rhs.getInt() == 4711) {
+      throw Exception(Exception::InternalError);
+    }
+    return lhs.getInt() < rhs.getInt();
+  };
+  for (std::size_t threads : { 1, 2, 4 }) {
+    ASSERT_VELOCYPACK_EXCEPTION(Collection::sortParallel(b.slice(), throwing, threads),
+                                Exception::InternalError);
+  }
+}
+
+TEST(CollectionTest, SortParallelSmall) {
+  auto b = Parser::fromJson("[3,1,2]");
+  Builder sorted = Collection::sortParallel(b->slice(), &lt);
+  ASSERT_EQ("[1,2,3]", sorted.slice().toJson());
+
+  Builder c;
+  c.add(Value("foo"));
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::sortParallel(c.slice(), &lt), Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, DistinctEmpty) {
+  auto b = Parser::fromJson("[]");
+  Builder result = Collection::distinct(b->slice());
+  ASSERT_EQ("[]", result.slice().toJson());
+}
+
+TEST(CollectionTest, Distinct) {
+  auto b = Parser::fromJson("[1,\"a\",1.0,null,[1,2],\"b\",{\"x\":1,\"y\":2},\"a\",[1,2],{\"y\":2,\"x\":1.0},null,2]");
+  Builder result = Collection::distinct(b->slice());
+  ASSERT_EQ("[1,\"a\",null,[1,2],\"b\",{\"x\":1,\"y\":2},2]", result.slice().toJson());
+}
+
+TEST(CollectionTest, DistinctMany) {
+  int64_t const n = 10000;
+  Builder b;
+  b.openArray();
+  for (int64_t i = 0; i < n; ++i) {
+    b.add(Value(i % 100));
+  }
+  b.close();
+
+  Builder result;
+  Collection::distinct(result, b.slice());
+  Slice s = result.slice();
+  ASSERT_EQ(100UL, s.length());
+  for (int64_t i = 0; i < 100; ++i) {
+    ASSERT_EQ(i, s.at(i).getInt());
+  }
+}
+
+TEST(CollectionTest, DistinctNonArray) {
+  auto b = Parser::fromJson("{}");
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::distinct(b->slice()), Exception::InvalidValueType);
+}
+
+TEST(CollectionTest, GroupBy) {
+  auto b = Parser::fromJson("[{\"k\":\"a\",\"v\":1},{\"k\":\"b\",\"v\":2},{\"k\":\"a\",\"v\":3},{\"v\":4},{\"k\":\"b\",\"v\":5},7]");
+  Builder result = Collection::groupBy(b->slice(), "k");
+  ASSERT_EQ("[[\"a\",[{\"k\":\"a\",\"v\":1},{\"k\":\"a\",\"v\":3}]],[\"b\",[{\"k\":\"b\",\"v\":2},{\"k\":\"b\",\"v\":5}]],[null,[{\"v\":4},7]]]", result.slice().toJson());
+}
+
+TEST(CollectionTest, GroupByFunction) {
+  auto b = Parser::fromJson("[1,2,3,4,5,6,7]");
+  Builder keys;
+  keys.openArray();
+  keys.add(Value("odd"));
+  keys.add(Value("even"));
+  keys.close();
+
+  Builder result = Collection::groupBy(b->slice(), [&keys](Slice const& s) {
+    return keys.slice().at(s.getInt() % 2 == 0 ? 1 : 0);
+  });
+  ASSERT_EQ("[[\"odd\",[1,3,5,7]],[\"even\",[2,4,6]]]", result.slice().toJson());
+}
+
+TEST(CollectionTest, GroupByEmpty) {
+  auto b = Parser::fromJson("[]");
+  Builder result = Collection::groupBy(b->slice(), "k");
+  ASSERT_EQ("[]", result.slice().toJson());
+}
+
+static void checkPatch(std::string const& expected, Builder const& result) {
+  auto e = Parser::fromJson(expected);
+  ASSERT_TRUE(NormalizedCompare::equals(e->slice(), result.slice()))
+      << result.slice().toJson();
+}
+
+TEST(CollectionTest, MergePatch) {
+  auto target = Parser::fromJson(
+      "{\"a\":\"b\",\"c\":{\"d\":\"e\",\"f\":\"g\"},\"h\":[1,2]}");
+  auto patch = Parser::fromJson(
+      "{\"a\":\"z\",\"c\":{\"f\":null,\"x\":{\"y\":null,\"z\":1}},\"h\":[3]}");
+  checkPatch("{\"a\":\"z\",\"c\":{\"d\":\"e\",\"x\":{\"z\":1}},\"h\":[3]}",
+             Collection::mergePatch(target->slice(), patch->slice()));
+}
+
+TEST(CollectionTest, MergePatchRFCExamples) {
+  // test cases from RFC 7386, appendix A
+  std::vector<std::array<char const*, 3>> const cases = {
+      {"{\"a\":\"b\"}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"},
+      {"{\"a\":\"b\"}", "{\"b\":\"c\"}", "{\"a\":\"b\",\"b\":\"c\"}"},
+      {"{\"a\":\"b\"}", "{\"a\":null}", "{}"},
+      {"{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}", "{\"b\":\"c\"}"},
+      {"{\"a\":[\"b\"]}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"},
+      {"{\"a\":\"c\"}", "{\"a\":[\"b\"]}", "{\"a\":[\"b\"]}"},
+      {"{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}",
+       "{\"a\":{\"b\":\"d\"}}"},
+      {"{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}", "{\"a\":[1]}"},
+      {"[\"a\",\"b\"]", "[\"c\",\"d\"]", "[\"c\",\"d\"]"},
+      {"{\"a\":\"b\"}", "[\"c\"]", "[\"c\"]"},
+      {"{\"a\":\"foo\"}", "null", "null"},
+      {"{\"a\":\"foo\"}", "\"bar\"", "\"bar\""},
+      {"{\"e\":null}", "{\"a\":1}", "{\"e\":null,\"a\":1}"},
+      {"[1,2]", "{\"a\":\"b\",\"c\":null}", "{\"a\":\"b\"}"},
+      {"{}", "{\"a\":{\"bb\":{\"ccc\":null}}}", "{\"a\":{\"bb\":{}}}"}};
+
+  for (auto const& c : cases) {
+    auto target = Parser::fromJson(c[0]);
+    auto patch = Parser::fromJson(c[1]);
+    checkPatch(c[2], Collection::mergePatch(target->slice(), patch->slice()));
+  }
+}
+
+TEST(CollectionTest, ApplyPatch) {
+  auto target = Parser::fromJson(
+      "{\"foo\":{\"bar\":\"baz\",\"waldo\":\"fred\"},\"qux\":{\"corge\":"
+      "\"grault\"},\"list\":[1,2,3],\"a/b\":1,\"m~n\":2}");
+  auto ops = Parser::fromJson(
+      "[{\"op\":\"test\",\"path\":\"/foo/bar\",\"value\":\"baz\"},"
+      "{\"op\":\"add\",\"path\":\"/foo/new\",\"value\":[true]},"
+      "{\"op\":\"remove\",\"path\":\"/foo/waldo\"},"
+      "{\"op\":\"replace\",\"path\":\"/qux/corge\",\"value\":42},"
+      "{\"op\":\"add\",\"path\":\"/list/1\",\"value\":\"x\"},"
+      "{\"op\":\"add\",\"path\":\"/list/-\",\"value\":4},"
+      "{\"op\":\"remove\",\"path\":\"/list/0\"},"
+      "{\"op\":\"move\",\"path\":\"/moved\",\"from\":\"/a~1b\"},"
+      "{\"op\":\"copy\",\"path\":\"/qux/copied\",\"from\":\"/m~0n\"},"
+      "{\"op\":\"test\",\"path\":\"/list\",\"value\":[\"x\",2,3,4]}]");
+
+  checkPatch(
+      "{\"foo\":{\"bar\":\"baz\",\"new\":[true]},\"qux\":{\"corge\":42,"
+      "\"copied\":2},\"list\":[\"x\",2,3,4],\"m~n\":2,\"moved\":1}",
+      Collection::applyPatch(target->slice(), ops->slice()));
+}
+
+TEST(CollectionTest, ApplyPatchWholeDocument) {
+  auto target = Parser::fromJson("{\"a\":1}");
+  auto ops = Parser::fromJson(
+      "[{\"op\":\"replace\",\"path\":\"\",\"value\":[1,2]}]");
+  checkPatch("[1,2]", Collection::applyPatch(target->slice(), ops->slice()));
+
+  ops = Parser::fromJson("[{\"op\":\"test\",\"path\":\"/a\",\"value\":1.0}]");
+  checkPatch("{\"a\":1}",
+             Collection::applyPatch(target->slice(), ops->slice()));
+}
+
+TEST(CollectionTest, ApplyPatchErrors) {
+  auto target = Parser::fromJson("{\"a\":{\"b\":[1,2]},\"c\":3}");
+
+  auto check = [&](std::string const& ops, Exception::ExceptionType type) {
+    auto b = Parser::fromJson(ops);
+    ASSERT_VELOCYPACK_EXCEPTION(
+        Collection::applyPatch(target->slice(), b->slice()), type);
+  };
+
+  check("{}", Exception::InvalidValueType);
+  check("[{\"op\":\"foo\",\"path\":\"/a\"}]", Exception::InvalidValueType);
+  check("[{\"path\":\"/a\"}]", Exception::InvalidValueType);
+  check("[{\"op\":\"add\",\"path\":\"/a\"}]", Exception::InvalidValueType);
+  check("[{\"op\":\"remove\",\"path\":\"a\"}]", Exception::InvalidAttributePath);
+  check("[{\"op\":\"remove\",\"path\":\"/x\"}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"replace\",\"path\":\"/x\",\"value\":1}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"add\",\"path\":\"/x/y\",\"value\":1}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"add\",\"path\":\"/c/y\",\"value\":1}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"add\",\"path\":\"/a/b/3\",\"value\":1}]",
+        Exception::IndexOutOfBounds);
+  check("[{\"op\":\"remove\",\"path\":\"/a/b/2\"}]",
+        Exception::IndexOutOfBounds);
+  check("[{\"op\":\"remove\",\"path\":\"/a/b/01\"}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"move\",\"path\":\"/a/b/x\",\"from\":\"/a\"}]",
+        Exception::InvalidAttributePath);
+  check("[{\"op\":\"test\",\"path\":\"/c\",\"value\":4}]",
+        Exception::PatchTestFailed);
+}
+
+TEST(CollectionTest, ReplaceInPlace) {
+  auto target = Parser::fromJson(
+      "{\"a\":{\"b\":[1,2,\"abc\"]},\"c\":\"def\",\"d\":1}");
+  Builder& b = *target;
+
+  Builder v;
+  v.add(Value("xyz"));
+  ASSERT_TRUE(Collection::replaceInPlace(b, "/a/b/2", v.slice()));
+  ASSERT_TRUE(Collection::replaceInPlace(b, "/c", v.slice()));
+  // different byte size
+  ASSERT_FALSE(Collection::replaceInPlace(b, "/d", v.slice()));
+  checkPatch("{\"a\":{\"b\":[1,2,\"xyz\"]},\"c\":\"xyz\",\"d\":1}", b);
+
+  ASSERT_VELOCYPACK_EXCEPTION(Collection::replaceInPlace(b, "/x", v.slice()),
+                              Exception::InvalidAttributePath);
+}
+
+static void checkDiff(std::string const& from, std::string const& to) {
+  auto oldValue = Parser::fromJson(from);
+  auto newValue = Parser::fromJson(to);
+  Builder ops = Collection::diff(oldValue->slice(), newValue->slice());
+  checkPatch(to, Collection::applyPatch(oldValue->slice(), ops.slice()));
+}
+
+TEST(CollectionTest, DiffIdentical) {
+  auto value = Parser::fromJson("{\"a\":[1,2,{\"b\":\"c\"}],\"d\":null}");
+  ASSERT_EQ("[]", Collection::diff(value->slice(), value->slice()).slice().toJson());
+
+  // equal numbers with different representations
+  auto oldValue = Parser::fromJson("[1,2.0]");
+  auto newValue = Parser::fromJson("[1.0,2]");
+  ASSERT_EQ("[]",
+            Collection::diff(oldValue->slice(), newValue->slice()).slice().toJson());
+}
+
+TEST(CollectionTest, DiffOperations) {
+  auto oldValue = Parser::fromJson(
+      "{\"a\":1,\"b\":{\"c\":[1,2,3,4],\"d\":\"x\"},\"e/f\":true}");
+  auto newValue = Parser::fromJson(
+      "{\"a\":1,\"b\":{\"c\":[1,2,9,3,4],\"d\":\"y\"},\"g\":[]}");
+  Builder ops = Collection::diff(oldValue->slice(), newValue->slice());
+  ASSERT_EQ(
+      "[{\"op\":\"add\",\"path\":\"/b/c/2\",\"value\":9},"
+      "{\"op\":\"replace\",\"path\":\"/b/d\",\"value\":\"y\"},"
+      "{\"op\":\"remove\",\"path\":\"/e~1f\"},"
+      "{\"op\":\"add\",\"path\":\"/g\",\"value\":[]}]",
+      ops.slice().toJson());
+}
+
+TEST(CollectionTest, DiffApply) {
+  checkDiff("null", "{\"a\":1}");
+  checkDiff("{\"a\":1}", "[1]");
+  checkDiff("[]", "[1,2,3]");
+  checkDiff("[1,2,3]", "[]");
+  checkDiff("[1,2,3,4,5]", "[1,5]");
+  checkDiff("[1,2,3,4,5]", "[0,1,2,3,4,5,6]");
+  checkDiff("[1,2,3]", "[3,2,1]");
+  checkDiff("[[1,2],[3,4]]", "[[1,2,3],[4]]");
+  checkDiff("{\"a\":{\"b\":{\"c\":1}}}", "{\"a\":{\"b\":{\"c\":2,\"d\":3}}}");
+  checkDiff("{\"a~b\":1,\"c\":[{\"d\":1}]}", "{\"a~b\":2,\"c\":[{\"e\":1}]}");
+  checkDiff("{\"a\":\"x\",\"b\":\"y\"}", "{}");
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
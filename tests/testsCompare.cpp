@@ -26,6 +26,7 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "tests-common.h"
 
@@ -411,6 +412,133 @@ TEST(NormalizedCompareTest, Custom) {
   ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::equals(b.slice(), b.slice()), Exception::NotImplemented);
 }
 
+TEST(NormalizedCompareTest, CompareTypeOrder) {
+  // values in ascending order, each from a different type group
+  std::vector<std::string> const values = {
+    "null", "false", "true", "-1000", "-1.5", "0", "0.5", "1", "100000",
+    "\"\"", "\"a\"", "\"ab\"", "\"b\"", "[]", "[null]", "[1]", "[1,2]", "[2]",
+    "{}", "{\"a\":1}", "{\"a\":2}", "{\"a\":2,\"b\":1}", "{\"b\":0}"
+  };
+
+  std::vector<std::shared_ptr<Builder>> builders;
+  builders.emplace_back(std::make_shared<Builder>(Slice::minKeySlice()));
+  builders.emplace_back(std::make_shared<Builder>(Slice::noneSlice()));
+  builders.emplace_back(std::make_shared<Builder>(Slice::illegalSlice()));
+  for (auto const& value : values) {
+    builders.emplace_back(Parser::fromJson(value));
+  }
+  builders.emplace_back(std::make_shared<Builder>(Slice::maxKeySlice()));
+
+  for (std::size_t i = 0; i < builders.size(); ++i) {
+    for (std::size_t j = 0; j < builders.size(); ++j) {
+      Slice lhs = builders[i]->slice();
+      Slice rhs = builders[j]->slice();
+      int expected = (i < j) ? -1 : ((i > j) ? 1 : 0);
+      int actual = NormalizedCompare::compare(lhs, rhs);
+      ASSERT_EQ(expected, (actual > 0) - (actual < 0)) << lhs.toJson() << " vs " << rhs.toJson();
+
+      int keyOrder = NormalizedCompare::sortKey(lhs).compare(NormalizedCompare::sortKey(rhs));
+      ASSERT_EQ(expected, (keyOrder > 0) - (keyOrder < 0)) << lhs.toJson() << " vs " << rhs.toJson();
+    }
+  }
+}
+
+TEST(NormalizedCompareTest, CompareNumbers) {
+  Builder b;
+  b.openArray();
+  b.add(Value(int64_t(-9007199254740993LL)));
+  b.add(Value(double(-9007199254740992.0)));
+  b.add(Value(int64_t(-1)));
+  b.add(Value(double(-0.0)));
+  b.add(Value(uint64_t(0)));
+  b.add(Value(int64_t(1)));
+  b.add(Value(double(9007199254740992.0)));
+  b.add(Value(int64_t(9007199254740993LL)));
+  b.add(Value(uint64_t(9007199254740994ULL)));
+  b.add(Value(int64_t(INT64_MAX)));
+  b.add(Value(uint64_t(UINT64_MAX)));
+  b.close();
+
+  Slice s = b.slice();
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    for (ValueLength j = 0; j < s.length(); ++j) {
+      int expected = (i < j) ? -1 : ((i > j) ? 1 : 0);
+      if ((i == 3 && j == 4) || (i == 4 && j == 3)) {
+        // -0.0 and 0 are equal
+        expected = 0;
+      }
+      int actual = NormalizedCompare::compare(s.at(i), s.at(j));
+      ASSERT_EQ(expected, (actual > 0) - (actual < 0)) << i << " vs " << j;
+
+      int keyOrder = NormalizedCompare::sortKey(s.at(i)).compare(NormalizedCompare::sortKey(s.at(j)));
+      ASSERT_EQ(expected, (keyOrder > 0) - (keyOrder < 0)) << i << " vs " << j;
+    }
+  }
+}
+
+TEST(NormalizedCompareTest, CompareEqualRepresentations) {
+  Builder b1;
+  b1.add(Value(int64_t(7)));
+  Builder b2;
+  b2.add(Value(7.0));
+  Builder b3;
+  b3.add(Value(uint64_t(7)));
+
+  ASSERT_EQ(0, NormalizedCompare::compare(b1.slice(), b2.slice()));
+  ASSERT_EQ(0, NormalizedCompare::compare(b2.slice(), b3.slice()));
+  ASSERT_EQ(NormalizedCompare::sortKey(b1.slice()), NormalizedCompare::sortKey(b2.slice()));
+  ASSERT_EQ(NormalizedCompare::sortKey(b1.slice()), NormalizedCompare::sortKey(b3.slice()));
+
+  Options options;
+  options.buildUnindexedObjects = true;
+  auto compact = Parser::fromJson("{\"c\":[1,2],\"a\":\"x\",\"b\":null}", &options);
+  auto indexed = Parser::fromJson("{\"b\":null,\"a\":\"x\",\"c\":[1.0,2]}");
+  ASSERT_EQ(0x14, compact->slice().head());
+  ASSERT_EQ(0, NormalizedCompare::compare(compact->slice(), indexed->slice()));
+  ASSERT_EQ(NormalizedCompare::sortKey(compact->slice()), NormalizedCompare::sortKey(indexed->slice()));
+}
+
+TEST(NormalizedCompareTest, CompareStringsWithNullBytes) {
+  Builder b;
+  b.openArray();
+  b.add(Value(std::string("a", 1)));
+  b.add(Value(std::string("a\0", 2)));
+  b.add(Value(std::string("a\0\0", 3)));
+  b.add(Value(std::string("a\x01", 2)));
+  b.add(Value(std::string("a\xff", 2)));
+  b.close();
+
+  Slice s = b.slice();
+  for (ValueLength i = 0; i < s.length(); ++i) {
+    for (ValueLength j = 0; j < s.length(); ++j) {
+      int expected = (i < j) ? -1 : ((i > j) ? 1 : 0);
+      int actual = NormalizedCompare::compare(s.at(i), s.at(j));
+      ASSERT_EQ(expected, (actual > 0) - (actual < 0));
+
+      int keyOrder = NormalizedCompare::sortKey(s.at(i)).compare(NormalizedCompare::sortKey(s.at(j)));
+      ASSERT_EQ(expected, (keyOrder > 0) - (keyOrder < 0));
+    }
+  }
+}
+
+TEST(NormalizedCompareTest, CompareNested) {
+  auto lhs = Parser::fromJson("[{},5]");
+  auto rhs = Parser::fromJson("[{\"\":1}]");
+
+  ASSERT_TRUE(NormalizedCompare::compare(lhs->slice(), rhs->slice()) < 0);
+  ASSERT_TRUE(NormalizedCompare::sortKey(lhs->slice()) < NormalizedCompare::sortKey(rhs->slice()));
+}
+
+TEST(NormalizedCompareTest, CompareCustom) {
+  Builder b;
+  uint8_t* p = b.add(ValuePair(2ULL, ValueType::Custom));
+  *p++ = 0xf0;
+  *p++ = 0xaa;
+
+  ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::compare(b.slice(), b.slice()), Exception::NotImplemented);
+  ASSERT_VELOCYPACK_EXCEPTION(NormalizedCompare::sortKey(b.slice()), Exception::NotImplemented);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <random>
+#include <string>
+
+#include "tests-common.h"
+
+namespace {
+
+void checkRoundtrip(uint8_t const* data, std::size_t size) {
+  Buffer<uint8_t> compressed;
+  std::size_t length = BlockCodec::compress(data, size, compressed);
+  ASSERT_EQ(compressed.size(), length);
+  ASSERT_LE(length, BlockCodec::maxCompressedSize(size));
+
+  Buffer<uint8_t> decompressed;
+  BlockCodec::decompress(compressed.data(), compressed.size(), decompressed, size);
+  ASSERT_EQ(size, decompressed.size());
+  if (size > 0) {
+    ASSERT_EQ(0, memcmp(data, decompressed.data(), size));
+  }
+}
+
+void checkRoundtrip(std::string const& value) {
+  checkRoundtrip(reinterpret_cast<uint8_t const*>(value.data()), value.size());
+}
+
+void decompress(std::vector<uint8_t> const& data, std::size_t size) {
+  std::vector<uint8_t> out(size + 1);
+  BlockCodec::decompress(data.data(), data.size(), out.data(), size);
+}
+
+}  // namespace
+
+TEST(CompressionTest, Empty) {
+  Buffer<uint8_t> compressed;
+  ASSERT_EQ(1UL, BlockCodec::compress(nullptr, 0, compressed));
+  ASSERT_EQ(0U, compressed[0]);
+
+  checkRoundtrip(nullptr, 0);
+}
+
+TEST(CompressionTest, ShortInputs) {
+  std::string value;
+  for (int i = 0; i < 40; ++i) {
+    checkRoundtrip(value);
+    value.push_back(static_cast<char>('a' + (i % 3)));
+  }
+}
+
+TEST(CompressionTest, Repetitive) {
+  std::string value(100000, 'x');
+  Buffer<uint8_t> compressed;
+  BlockCodec::compress(reinterpret_cast<uint8_t const*>(value.data()),
+                       value.size(), compressed);
+  ASSERT_GT(value.size() / 100, compressed.size());
+  checkRoundtrip(value);
+
+  value.clear();
+  for (int i = 0; i < 10000; ++i) {
+    value.append("abcdefg");
+    value.append(std::to_string(i % 17));
+  }
+  checkRoundtrip(value);
+}
+
+TEST(CompressionTest, Random) {
+  std::mt19937 gen(42);
+  std::string value;
+  for (int i = 0; i < 200000; ++i) {
+    value.push_back(static_cast<char>(gen() & 0xff));
+  }
+  checkRoundtrip(value);
+
+  // runs of random length, either repeated or with few distinct bytes
+  value.clear();
+  while (value.size() < 500000) {
+    std::size_t length = gen() % 300;
+    if (gen() % 2 == 0) {
+      value.append(length, static_cast<char>(gen() & 0x0f));
+    } else {
+      for (std::size_t i = 0; i < length; ++i) {
+        value.push_back(static_cast<char>(gen() & 0x07));
+      }
+    }
+  }
+  checkRoundtrip(value);
+}
+
+TEST(CompressionTest, VelocyPack) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 1000; ++i) {
+    b.openObject();
+    b.add("_key", Value("key" + std::to_string(i)));
+    b.add("name", Value("some repeated name"));
+    b.add("value", Value(i));
+    b.add("active", Value(i % 2 == 0));
+    b.close();
+  }
+  b.close();
+
+  Buffer<uint8_t> compressed;
+  BlockCodec::compress(b.start(), b.size(), compressed);
+  ASSERT_GT(b.size() / 3, compressed.size());
+
+  // appends to existing content
+  Buffer<uint8_t> decompressed;
+  decompressed.push_back('x');
+  BlockCodec::decompress(compressed.data(), compressed.size(), decompressed, b.size());
+  ASSERT_EQ(b.size() + 1, decompressed.size());
+  Slice s(decompressed.data() + 1);
+  ASSERT_TRUE(s.binaryEquals(b.slice()));
+  ASSERT_EQ(999, s.at(999).get("value").getInt());
+}
+
+TEST(CompressionTest, Corrupted) {
+  std::string value;
+  for (int i = 0; i < 1000; ++i) {
+    value.append("value" + std::to_string(i % 10));
+  }
+  Buffer<uint8_t> compressed;
+  BlockCodec::compress(reinterpret_cast<uint8_t const*>(value.data()),
+                       value.size(), compressed);
+  std::vector<uint8_t> data(compressed.data(), compressed.data() + compressed.size());
+  decompress(data, value.size());
+
+  // wrong original size
+  ASSERT_VELOCYPACK_EXCEPTION(decompress(data, value.size() - 1),
+                              Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(decompress(data, value.size() + 1),
+                              Exception::ValidatorInvalidLength);
+
+  // truncated input
+  ASSERT_VELOCYPACK_EXCEPTION(decompress({}, 0), Exception::ValidatorInvalidLength);
+  data.pop_back();
+  ASSERT_VELOCYPACK_EXCEPTION(decompress(data, value.size()),
+                              Exception::ValidatorInvalidLength);
+
+  // one literal followed by a match with offset 2 or 0
+  ASSERT_VELOCYPACK_EXCEPTION(decompress({0x10, 'a', 0x02, 0x00, 0x00}, 5),
+                              Exception::ValidatorInvalidLength);
+  ASSERT_VELOCYPACK_EXCEPTION(decompress({0x10, 'a', 0x00, 0x00, 0x00}, 5),
+                              Exception::ValidatorInvalidLength);
+  // same with offset 1, repeating the literal
+  decompress({0x10, 'a', 0x01, 0x00, 0x00}, 5);
+  // literal length beyond the input
+  ASSERT_VELOCYPACK_EXCEPTION(decompress({0x50, 'a', 'b'}, 5),
+                              Exception::ValidatorInvalidLength);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace {
+
+Builder makeDocument(int64_t key, std::string const& name) {
+  Builder b;
+  b.openObject();
+  b.add("key", Value(key));
+  b.add("name", Value(name));
+  b.close();
+  return b;
+}
+
+// writes count documents with keys 0..count-1 into a container
+Buffer<uint8_t> makeContainer(int64_t count, std::string attribute,
+                              std::size_t blockSize, bool compress = false) {
+  Buffer<uint8_t> buffer;
+  ByteBufferSinkImpl<uint8_t> sink(&buffer);
+  ContainerWriter writer(&sink, std::move(attribute), blockSize, compress);
+  for (int64_t i = 0; i < count; ++i) {
+    writer.add(makeDocument(i, "name" + std::to_string(i)).slice());
+  }
+  EXPECT_EQ(static_cast<std::size_t>(count), writer.count());
+  writer.finish();
+  return buffer;
+}
+
+}  // namespace
+
+TEST(ContainerTest, Empty) {
+  Buffer<uint8_t> buffer = makeContainer(0, "key", 1024);
+  ASSERT_EQ(ContainerFormat::magicSize + ContainerFormat::trailerSize,
+            buffer.size() - Slice(buffer.data() + ContainerFormat::magicSize).byteSize());
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(0UL, reader.count());
+  ASSERT_EQ(0UL, reader.numBlocks());
+  ASSERT_EQ("key", reader.attribute());
+  ASSERT_VELOCYPACK_EXCEPTION(reader.at(0), Exception::IndexOutOfBounds);
+}
+
+TEST(ContainerTest, ScalarValues) {
+  Buffer<uint8_t> buffer;
+  ByteBufferSinkImpl<uint8_t> sink(&buffer);
+  ContainerWriter writer(&sink);
+  writer.add(Slice::nullSlice());
+  writer.add(Slice::trueSlice());
+  writer.add(Slice::emptyArraySlice());
+  writer.finish();
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(3UL, reader.count());
+  ASSERT_EQ(1UL, reader.numBlocks());
+  ASSERT_TRUE(reader.attribute().empty());
+  ASSERT_TRUE(reader.at(0).isNull());
+  ASSERT_TRUE(reader.at(1).isTrue());
+  ASSERT_TRUE(reader.at(2).isArray());
+  ASSERT_TRUE(reader.mayContain(0, Slice::nullSlice()));
+  ASSERT_TRUE(reader.block(0).min.isNone());
+  ASSERT_TRUE(reader.block(0).bloom.isNone());
+  ASSERT_VELOCYPACK_EXCEPTION(reader.find(Slice::nullSlice(), [](Slice) { return true; }),
+                              Exception::InternalError);
+}
+
+TEST(ContainerTest, RandomAccess) {
+  int64_t const n = 1000;
+  Buffer<uint8_t> buffer = makeContainer(n, "key", 256);
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(static_cast<std::size_t>(n), reader.count());
+  ASSERT_LT(10UL, reader.numBlocks());
+
+  std::size_t first = 0;
+  for (std::size_t i = 0; i < reader.numBlocks(); ++i) {
+    auto const& block = reader.block(i);
+    ASSERT_EQ(first, block.first);
+    ASSERT_LT(0UL, block.count);
+    ASSERT_EQ(static_cast<int64_t>(block.first), block.min.getInt());
+    ASSERT_EQ(static_cast<int64_t>(block.first + block.count - 1), block.max.getInt());
+    ASSERT_TRUE(block.bloom.isBinary());
+    first += block.count;
+  }
+  ASSERT_EQ(reader.count(), first);
+
+  for (int64_t i = n - 1; i >= 0; --i) {
+    Slice s = reader.at(static_cast<std::size_t>(i));
+    ASSERT_EQ(i, s.get("key").getInt());
+    ASSERT_EQ("name" + std::to_string(i), s.get("name").copyString());
+    auto const& block = reader.block(reader.blockOf(static_cast<std::size_t>(i)));
+    ASSERT_LE(block.first, static_cast<std::size_t>(i));
+    ASSERT_LT(static_cast<std::size_t>(i), block.first + block.count);
+  }
+  ASSERT_VELOCYPACK_EXCEPTION(reader.at(n), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(reader.blockOf(n), Exception::IndexOutOfBounds);
+}
+
+TEST(ContainerTest, ForEach) {
+  Buffer<uint8_t> buffer = makeContainer(500, "key", 128);
+  ContainerReader reader(buffer);
+
+  std::size_t visited = 0;
+  reader.forEach([](ContainerReader::Block const&) { return true; },
+                 [&visited](Slice s) {
+                   EXPECT_EQ(static_cast<int64_t>(visited), s.get("key").getInt());
+                   ++visited;
+                   return true;
+                 });
+  ASSERT_EQ(500UL, visited);
+
+  // only blocks that may contain keys >= 400
+  Builder limit;
+  limit.add(Value(400));
+  std::size_t expected = 0;
+  visited = 0;
+  reader.forEach(
+      [&](ContainerReader::Block const& block) {
+        if (NormalizedCompare::compare(block.max, limit.slice()) < 0) {
+          return false;
+        }
+        expected += block.count;
+        return true;
+      },
+      [&visited](Slice) {
+        ++visited;
+        return true;
+      });
+  ASSERT_EQ(expected, visited);
+  ASSERT_LT(100UL, visited);
+  ASSERT_GT(500UL, visited);
+
+  // stop early
+  visited = 0;
+  reader.forEach([](ContainerReader::Block const&) { return true; },
+                 [&visited](Slice) { return ++visited < 3; });
+  ASSERT_EQ(3UL, visited);
+}
+
+TEST(ContainerTest, Find) {
+  Buffer<uint8_t> buffer = makeContainer(1000, "key", 256);
+  ContainerReader reader(buffer);
+
+  Builder value;
+  value.add(Value(777));
+
+  std::size_t candidates = 0;
+  for (std::size_t i = 0; i < reader.numBlocks(); ++i) {
+    if (reader.mayContain(i, value.slice())) {
+      ++candidates;
+    }
+  }
+  ASSERT_EQ(1UL, candidates);
+  ASSERT_TRUE(reader.mayContain(reader.blockOf(777), value.slice()));
+
+  std::vector<std::string> found;
+  reader.find(value.slice(), [&found](Slice s) {
+    found.push_back(s.get("name").copyString());
+    return true;
+  });
+  ASSERT_EQ(std::vector<std::string>{"name777"}, found);
+
+  // numerically equal values of a different type are found as well
+  Builder dbl;
+  dbl.add(Value(777.0));
+  found.clear();
+  reader.find(dbl.slice(), [&found](Slice s) {
+    found.push_back(s.get("name").copyString());
+    return true;
+  });
+  ASSERT_EQ(std::vector<std::string>{"name777"}, found);
+
+  Builder missing;
+  missing.add(Value(5000));
+  for (std::size_t i = 0; i < reader.numBlocks(); ++i) {
+    ASSERT_FALSE(reader.mayContain(i, missing.slice()));
+  }
+  found.clear();
+  reader.find(missing.slice(), [&found](Slice s) {
+    found.push_back(s.get("name").copyString());
+    return true;
+  });
+  ASSERT_TRUE(found.empty());
+}
+
+TEST(ContainerTest, Compressed) {
+  int64_t const n = 2000;
+  Buffer<uint8_t> plain = makeContainer(n, "key", 4096);
+  Buffer<uint8_t> buffer = makeContainer(n, "key", 4096, true);
+  ASSERT_GT(plain.size() / 2, buffer.size());
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(static_cast<std::size_t>(n), reader.count());
+  for (std::size_t i = 0; i < reader.numBlocks(); ++i) {
+    auto const& block = reader.block(i);
+    ASSERT_TRUE(block.compressed);
+    ASSERT_LT(block.size, block.rawSize);
+  }
+
+  for (int64_t i = 0; i < n; i += 7) {
+    Slice s = reader.at(static_cast<std::size_t>(i));
+    ASSERT_EQ(i, s.get("key").getInt());
+    ASSERT_EQ("name" + std::to_string(i), s.get("name").copyString());
+  }
+  // values of decompressed blocks stay at the same address
+  ASSERT_EQ(reader.at(5).start(), reader.at(5).start());
+
+  std::size_t visited = 0;
+  reader.forEach([](ContainerReader::Block const&) { return true; },
+                 [&visited](Slice s) {
+                   EXPECT_EQ(static_cast<int64_t>(visited), s.get("key").getInt());
+                   ++visited;
+                   return true;
+                 });
+  ASSERT_EQ(static_cast<std::size_t>(n), visited);
+
+  Builder value;
+  value.add(Value(1234));
+  std::vector<std::string> found;
+  reader.find(value.slice(), [&found](Slice s) {
+    found.push_back(s.get("name").copyString());
+    return true;
+  });
+  ASSERT_EQ(std::vector<std::string>{"name1234"}, found);
+}
+
+TEST(ContainerTest, CompressedIncompressible) {
+  // a block that does not get smaller is stored uncompressed
+  Buffer<uint8_t> buffer;
+  ByteBufferSinkImpl<uint8_t> sink(&buffer);
+  ContainerWriter writer(&sink, "", 1024, true);
+  writer.add(Slice::trueSlice());
+  writer.finish();
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(1UL, reader.numBlocks());
+  ASSERT_FALSE(reader.block(0).compressed);
+  ASSERT_EQ(reader.block(0).size, reader.block(0).rawSize);
+  ASSERT_TRUE(reader.at(0).isTrue());
+}
+
+TEST(ContainerTest, MissingAttribute) {
+  Buffer<uint8_t> buffer;
+  ByteBufferSinkImpl<uint8_t> sink(&buffer);
+  ContainerWriter writer(&sink, "other", 64);
+  for (int64_t i = 0; i < 100; ++i) {
+    writer.add(makeDocument(i, "foo").slice());
+  }
+  writer.finish();
+
+  ContainerReader reader(buffer);
+  ASSERT_EQ(100UL, reader.count());
+  ASSERT_EQ("other", reader.attribute());
+  for (std::size_t i = 0; i < reader.numBlocks(); ++i) {
+    ASSERT_TRUE(reader.block(i).min.isNone());
+    ASSERT_FALSE(reader.mayContain(i, Slice::nullSlice()));
+  }
+  std::size_t found = 0;
+  reader.find(Slice::nullSlice(), [&found](Slice) {
+    ++found;
+    return true;
+  });
+  ASSERT_EQ(0UL, found);
+}
+
+TEST(ContainerTest, FinishTwice) {
+  Buffer<uint8_t> buffer;
+  ByteBufferSinkImpl<uint8_t> sink(&buffer);
+  ContainerWriter writer(&sink);
+  writer.add(Slice::nullSlice());
+  writer.finish();
+  ASSERT_VELOCYPACK_EXCEPTION(writer.finish(), Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(writer.add(Slice::nullSlice()), Exception::InternalError);
+}
+
+TEST(ContainerTest, Corrupted) {
+  Buffer<uint8_t> buffer = makeContainer(100, "key", 256);
+
+  ASSERT_VELOCYPACK_EXCEPTION(ContainerReader(buffer.data(), 10),
+                              Exception::ValidatorInvalidType);
+
+  {
+    Buffer<uint8_t> copy(buffer);
+    copy.data()[0] = 'X';
+    ASSERT_VELOCYPACK_EXCEPTION(ContainerReader{copy}, Exception::ValidatorInvalidType);
+  }
+  {
+    Buffer<uint8_t> copy(buffer);
+    copy.data()[copy.size() - 1] = 'X';
+    ASSERT_VELOCYPACK_EXCEPTION(ContainerReader{copy}, Exception::ValidatorInvalidType);
+  }
+  {
+    // footer offset beyond the footer
+    Buffer<uint8_t> copy(buffer);
+    storeUInt64(copy.data() + copy.size() - ContainerFormat::trailerSize, copy.size());
+    ASSERT_VELOCYPACK_EXCEPTION(ContainerReader{copy}, Exception::ValidatorInvalidLength);
+  }
+  {
+    // footer offset pointing into the values
+    Buffer<uint8_t> copy(buffer);
+    storeUInt64(copy.data() + copy.size() - ContainerFormat::trailerSize,
+                ContainerFormat::magicSize);
+    ASSERT_THROW(ContainerReader{copy}, Exception);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
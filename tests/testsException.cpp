@@ -76,12 +76,20 @@ TEST(ExceptionTest, TestMessages) {
                Exception::message(Exception::BuilderTagsDisallowed));
   ASSERT_STREQ("BCD types are not allowed in this configuration",
                Exception::message(Exception::BuilderBCDDisallowed));
+  ASSERT_STREQ("Savepoint is not valid for the current Builder state",
+               Exception::message(Exception::BuilderInvalidSavepoint));
   ASSERT_STREQ("Invalid type found in binary data",
                Exception::message(Exception::ValidatorInvalidType));
   ASSERT_STREQ("Invalid length found in binary data",
                Exception::message(Exception::ValidatorInvalidLength));
   ASSERT_STREQ("Array size does not match tuple size",
                Exception::message(Exception::BadTupleSize));
+  ASSERT_STREQ("Patch test operation failed",
+               Exception::message(Exception::PatchTestFailed));
+  ASSERT_STREQ("Buffer capacity exceeded",
+               Exception::message(Exception::BufferCapacityExceeded));
+  ASSERT_STREQ("Invalid query expression",
+               Exception::message(Exception::InvalidQuery));
 
   ASSERT_STREQ("Unknown error", Exception::message(Exception::UnknownError));
   ASSERT_STREQ("Unknown error",
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+// unique directory for the run files of one test, removed with all its
+// contents at the end of the test
+class TempDirectory {
+ public:
+  TempDirectory() {
+    std::random_device rd;
+    std::filesystem::path const base = std::filesystem::temp_directory_path();
+    do {
+      _path = base / ("vpack-external-sorter-" + std::to_string(rd()));
+    } while (!std::filesystem::create_directory(_path));
+  }
+
+  ~TempDirectory() {
+    std::error_code ec;
+    std::filesystem::remove_all(_path, ec);
+  }
+
+  TempDirectory(TempDirectory const&) = delete;
+  TempDirectory& operator=(TempDirectory const&) = delete;
+
+  std::string path() const { return _path.string(); }
+
+ private:
+  std::filesystem::path _path;
+};
+
+static Builder buildShuffled(int64_t n) {
+  Builder b;
+  b.openArray();
+  for (int64_t i = 0; i < n; ++i) {
+    // a permutation of 0 .. n - 1 for prime multipliers
+    b.add(Value((i * 7919) % n));
+  }
+  b.close();
+  return b;
+}
+
+static void checkAscending(Slice s, int64_t n) {
+  ASSERT_TRUE(s.isArray());
+  ASSERT_EQ(static_cast<ValueLength>(n), s.length());
+  int64_t expected = 0;
+  for (auto it : ArrayIterator(s)) {
+    ASSERT_EQ(expected, it.getInt());
+    ++expected;
+  }
+}
+
+TEST(ExternalSorterTest, Empty) {
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path());
+
+  Builder b;
+  b.openArray();
+  sorter.finish(b);
+  b.close();
+
+  ASSERT_EQ(0UL, sorter.count());
+  ASSERT_EQ(0UL, sorter.numRuns());
+  ASSERT_EQ("[]", b.slice().toJson());
+}
+
+TEST(ExternalSorterTest, InMemory) {
+  int64_t const n = 1000;
+  Builder input = buildShuffled(n);
+
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path());
+  sorter.addArray(input.slice());
+
+  Builder b;
+  b.openArray();
+  sorter.finish(b);
+  b.close();
+
+  ASSERT_EQ(static_cast<ValueLength>(n), sorter.count());
+  ASSERT_EQ(0UL, sorter.numRuns());
+  checkAscending(b.slice(), n);
+}
+
+TEST(ExternalSorterTest, SpillToRuns) {
+  int64_t const n = 10007;
+  Builder input = buildShuffled(n);
+
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path(), 4096);
+  sorter.addArray(input.slice());
+
+  Builder b;
+  b.openArray();
+  sorter.finish(b);
+  b.close();
+
+  ASSERT_TRUE(sorter.numRuns() > 1);
+  checkAscending(b.slice(), n);
+}
+
+TEST(ExternalSorterTest, SpillMixedValues) {
+  auto input = Parser::fromJson("[\"b\",{\"a\":[1,2,3]},3,null,[1],true,1.5,\"a\",{\"a\":1},-4]");
+
+  // tiny memory limit, so each value goes into its own run
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path(), 1);
+  sorter.addArray(input->slice());
+
+  std::vector<std::string> values;
+  sorter.finish([&values](Slice s) { values.push_back(s.toJson()); });
+
+  ASSERT_EQ(10UL, sorter.numRuns());
+  std::vector<std::string> expected = {
+    "null", "true", "-4", "1.5", "3", "\"a\"", "\"b\"", "[1]", "{\"a\":1}", "{\"a\":[1,2,3]}"
+  };
+  ASSERT_EQ(expected, values);
+}
+
+TEST(ExternalSorterTest, CustomComparator) {
+  int64_t const n = 5000;
+  Builder input = buildShuffled(n);
+
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path(), 1024, [](Slice const& a, Slice const& b) {
+    return a.getInt() > b.getInt();
+  });
+  sorter.addArray(input.slice());
+
+  int64_t expected = n - 1;
+  sorter.finish([&expected](Slice s) {
+    ASSERT_EQ(expected, s.getInt());
+    --expected;
+  });
+  ASSERT_EQ(-1, expected);
+}
+
+TEST(ExternalSorterTest, FinishTwice) {
+  TempDirectory dir;
+  ExternalSorter sorter(dir.path());
+  sorter.add(Slice::nullSlice());
+  sorter.finish([](Slice) {});
+
+  ASSERT_VELOCYPACK_EXCEPTION(sorter.finish([](Slice) {}), Exception::InternalError);
+  ASSERT_VELOCYPACK_EXCEPTION(sorter.add(Slice::nullSlice()), Exception::InternalError);
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
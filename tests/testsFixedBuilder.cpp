@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <string>
+
+#include "tests-common.h"
+
+namespace {
+
+void buildDocument(Builder& b, int i) {
+  b.openObject();
+  b.add("_key", Value(std::to_string(i)));
+  b.add("value", Value(i));
+  b.add("tags", Value(ValueType::Array));
+  b.add(Value("a"));
+  b.add(Value("b"));
+  b.close();
+  b.close();
+}
+
+bool buildDocument(FixedBuilder& b, int i) {
+  return b.openObject() &&
+         b.add("_key", Value(std::to_string(i))) &&
+         b.add("value", Value(i)) &&
+         b.add("tags", Value(ValueType::Array)) &&
+         b.add(Value("a")) &&
+         b.add(Value("b")) &&
+         b.close() &&
+         b.close();
+}
+
+}  // namespace
+
+TEST(FixedBuilderTest, Empty) {
+  std::array<uint8_t, 64> memory;
+  FixedBuilder b(memory.data(), memory.size());
+
+  ASSERT_FALSE(b.overflowed());
+  ASSERT_EQ(memory.size(), b.capacity());
+  ASSERT_EQ(0UL, b.size());
+  ASSERT_EQ(memory.data(), b.data());
+  ASSERT_TRUE(b.slice().isNone());
+}
+
+TEST(FixedBuilderTest, SameAsBuilder) {
+  std::array<uint8_t, 256> memory;
+  FixedBuilder b(memory.data(), memory.size());
+  ASSERT_TRUE(buildDocument(b, 42));
+  ASSERT_FALSE(b.overflowed());
+
+  Builder expected;
+  buildDocument(expected, 42);
+
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_EQ(0, memcmp(expected.data(), memory.data(), b.size()));
+  ASSERT_EQ(memory.data(), b.slice().start());
+  ASSERT_EQ(42, b.slice().get("value").getInt());
+}
+
+TEST(FixedBuilderTest, ExactFit) {
+  Builder expected;
+  expected.add(Value("some string value"));
+  expected.add(Value(12345));
+
+  std::string memory(expected.size(), '\0');
+  FixedBuilder b(reinterpret_cast<uint8_t*>(memory.data()), memory.size());
+  ASSERT_TRUE(b.add(Value("some string value")));
+  ASSERT_TRUE(b.add(Value(12345)));
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_EQ(0, memcmp(expected.data(), memory.data(), b.size()));
+
+  ASSERT_FALSE(b.add(Value(1)));
+}
+
+TEST(FixedBuilderTest, CompoundHeadroom) {
+  Builder expected;
+  buildDocument(expected, 1);
+
+  // open Arrays and Objects need space for a preliminary header
+  std::string memory(expected.size(), '\0');
+  {
+    FixedBuilder b(reinterpret_cast<uint8_t*>(memory.data()), memory.size());
+    ASSERT_FALSE(buildDocument(b, 1));
+  }
+
+  memory.resize(expected.size() + 2 * 9);
+  FixedBuilder b(reinterpret_cast<uint8_t*>(memory.data()), memory.size());
+  ASSERT_TRUE(buildDocument(b, 1));
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+}
+
+TEST(FixedBuilderTest, Overflow) {
+  std::array<uint8_t, 200> memory;
+  FixedBuilder b(memory.data(), memory.size());
+
+  Builder expected;
+  int i = 0;
+  while (buildDocument(b, i)) {
+    buildDocument(expected, i);
+    ASSERT_EQ(expected.size(), b.size());
+    ++i;
+  }
+  ASSERT_GT(i, 0);
+  ASSERT_TRUE(b.overflowed());
+  ASSERT_LE(b.size(), memory.size());
+
+  // no further modifications until rollback
+  ASSERT_FALSE(b.add(Value(1)));
+  ASSERT_FALSE(b.openArray());
+  ASSERT_FALSE(b.close());
+
+  b.rollback();
+  ASSERT_FALSE(b.overflowed());
+  ASSERT_TRUE(b.builder().isClosed());
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_EQ(0, memcmp(expected.data(), memory.data(), b.size()));
+
+  // the complete values are still valid
+  Validator validator;
+  ValueLength offset = 0;
+  for (int j = 0; j < i; ++j) {
+    Slice s(memory.data() + offset);
+    ASSERT_TRUE(validator.validate(s.start(), b.size() - offset, true));
+    ASSERT_EQ(j, s.get("value").getInt());
+    offset += s.byteSize();
+  }
+  ASSERT_EQ(b.size(), offset);
+
+  // small values still fit after the rollback
+  ASSERT_TRUE(b.add(Value(1)));
+  ASSERT_EQ(expected.size() + 1, b.size());
+}
+
+TEST(FixedBuilderTest, OverflowInsideCompound) {
+  std::array<uint8_t, 32> memory;
+  FixedBuilder b(memory.data(), memory.size());
+
+  ASSERT_TRUE(b.add(Value("first")));
+  ASSERT_EQ(6UL, b.size());
+
+  ASSERT_TRUE(b.openObject());
+  ASSERT_TRUE(b.add("a", Value(1)));
+  ASSERT_EQ(6UL, b.size());
+  ASSERT_FALSE(b.add("b", Value(std::string(64, 'x'))));
+  ASSERT_TRUE(b.overflowed());
+
+  b.rollback();
+  ASSERT_TRUE(b.builder().isClosed());
+  ASSERT_EQ(6UL, b.size());
+  ASSERT_EQ("first", b.slice().copyString());
+
+  ASSERT_TRUE(b.openObject());
+  ASSERT_TRUE(b.add("a", Value(1)));
+  ASSERT_TRUE(b.close());
+  ASSERT_EQ(6UL + Slice(memory.data() + 6).byteSize(), b.size());
+  ASSERT_EQ(1, Slice(memory.data() + 6).get("a").getInt());
+}
+
+TEST(FixedBuilderTest, OverflowInClose) {
+  // the index table of an Object is written by close()
+  Builder expected;
+  expected.openObject();
+  for (int i = 0; i < 10; ++i) {
+    expected.add(std::string(1, 'a' + i), Value(i));
+  }
+  expected.close();
+
+  std::string memory(expected.size() - 1, '\0');
+  FixedBuilder b(reinterpret_cast<uint8_t*>(memory.data()), memory.size());
+  ASSERT_TRUE(b.openObject());
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(b.add(std::string(1, 'a' + i), Value(i)));
+  }
+  ASSERT_FALSE(b.close());
+  ASSERT_TRUE(b.overflowed());
+
+  b.rollback();
+  ASSERT_EQ(0UL, b.size());
+  ASSERT_TRUE(b.slice().isNone());
+}
+
+TEST(FixedBuilderTest, RollbackToSavepoint) {
+  Builder expected;
+  expected.openObject();
+  expected.add("a", Value(1));
+  expected.add("c", Value(3));
+  expected.close();
+
+  std::array<uint8_t, 40> memory;
+  FixedBuilder b(memory.data(), memory.size());
+  ASSERT_TRUE(b.openObject());
+  ASSERT_TRUE(b.add("a", Value(1)));
+  auto sp = b.savepoint();
+  ASSERT_FALSE(b.add("b", Value(std::string(40, 'x'))));
+  ASSERT_TRUE(b.overflowed());
+
+  // skip the member that did not fit
+  b.rollback(sp);
+  ASSERT_FALSE(b.overflowed());
+  ASSERT_TRUE(b.add("c", Value(3)));
+  ASSERT_TRUE(b.close());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+  ASSERT_EQ(expected.size(), b.size());
+}
+
+TEST(FixedBuilderTest, FailedCloseLeavesValueUntouched) {
+  Builder expected;
+  expected.openObject();
+  for (int i = 0; i < 9; ++i) {
+    expected.add(std::string(1, 'a' + i), Value(i));
+  }
+  expected.close();
+
+  std::array<uint8_t, 40> memory;
+  FixedBuilder b(memory.data(), memory.size());
+  ASSERT_TRUE(b.openObject());
+  Builder::Savepoint sp;
+  for (int i = 0; i < 10; ++i) {
+    if (i == 9) {
+      sp = b.savepoint();
+    }
+    ASSERT_TRUE(b.add(std::string(1, 'a' + i), Value(i)));
+  }
+  // the index table does not fit
+  ASSERT_FALSE(b.close());
+
+  // drop the last member, then the index table fits
+  b.rollback(sp);
+  ASSERT_TRUE(b.close());
+  ASSERT_TRUE(b.slice().binaryEquals(expected.slice()));
+}
+
+TEST(FixedBuilderTest, Clear) {
+  std::array<uint8_t, 16> memory;
+  FixedBuilder b(memory.data(), memory.size());
+
+  ASSERT_FALSE(b.add(Value(std::string(32, 'x'))));
+  ASSERT_TRUE(b.overflowed());
+
+  b.clear();
+  ASSERT_FALSE(b.overflowed());
+  ASSERT_EQ(0UL, b.size());
+  ASSERT_TRUE(b.add(Value("abc")));
+  ASSERT_EQ("abc", b.slice().copyString());
+}
+
+TEST(FixedBuilderTest, InvalidUsageStillThrows) {
+  std::array<uint8_t, 64> memory;
+  FixedBuilder b(memory.data(), memory.size());
+
+  ASSERT_TRUE(b.openArray());
+  ASSERT_VELOCYPACK_EXCEPTION(b.add("foo", Value(1)),
+                              Exception::BuilderNeedOpenObject);
+  ASSERT_FALSE(b.overflowed());
+  ASSERT_TRUE(b.close());
+  ASSERT_VELOCYPACK_EXCEPTION(b.close(), Exception::BuilderNeedOpenCompound);
+}
+
+TEST(FixedBuilderTest, Options) {
+  Options options;
+  options.buildUnindexedArrays = true;
+
+  std::array<uint8_t, 64> memory;
+  FixedBuilder b(memory.data(), memory.size(), &options);
+  ASSERT_TRUE(b.openArray());
+  ASSERT_TRUE(b.add(Value(1)));
+  ASSERT_TRUE(b.add(Value(2)));
+  ASSERT_TRUE(b.close());
+  ASSERT_EQ(0x13, memory[0]);
+  ASSERT_EQ(2UL, b.slice().length());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -24,7 +24,10 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "tests-common.h"
 
@@ -1236,6 +1239,381 @@ TEST(IteratorTest, ArrayIteratorUnpackTuple) {
   ASSERT_TRUE(iter.value().isEqualString("extracted as slice"));
 }
 
+TEST(IteratorTest, PrefetchingIteration) {
+  Options options;
+  Builder b(&options);
+
+  auto build = [&b]() {
+    b.clear();
+    b.openArray();
+    for (int i = 0; i < 100; ++i) {
+      b.openObject();
+      b.add("id", Value(i));
+      b.add("name", Value("name" + std::to_string(i)));
+      b.add("list", Value(ValueType::Array));
+      b.add(Value(i));
+      b.close();
+      b.close();
+    }
+    b.close();
+  };
+
+  for (bool compact : {false, true}) {
+    options.buildUnindexedArrays = compact;
+    options.buildUnindexedObjects = compact;
+    build();
+    Slice s = b.slice();
+    ASSERT_EQ(compact ? 0x13 : 0x07, s.head());
+
+    for (ValueLength distance : {0, 1, 2, 8, 1000}) {
+      ArrayIterator it(s, distance);
+      ArrayIterator plain(s);
+      ASSERT_EQ(plain.size(), it.size());
+      int i = 0;
+      while (it.valid()) {
+        ASSERT_EQ(plain.value().start(), it.value().start());
+        ASSERT_EQ(i, it.value().get("id").getInt());
+
+        ObjectIterator members(it.value(), false, distance);
+        ObjectIterator plainMembers(it.value());
+        while (members.valid()) {
+          ASSERT_EQ(plainMembers.key().start(), members.key().start());
+          ASSERT_EQ(plainMembers.value().start(), members.value().start());
+          members.next();
+          plainMembers.next();
+        }
+        ASSERT_FALSE(plainMembers.valid());
+
+        it.next();
+        plain.next();
+        ++i;
+      }
+      ASSERT_EQ(100, i);
+    }
+  }
+}
+
+static void checkRandomAccessArray(Slice s, uint8_t expectedHead) {
+  ASSERT_EQ(expectedHead, s.head());
+
+  RandomAccessArray array(s);
+  ASSERT_EQ(s.length(), array.size());
+
+  // same members as with sequential iteration
+  ValueLength i = 0;
+  for (Slice member : ArrayIterator(s)) {
+    ASSERT_EQ(member.start(), array[i].start());
+    ASSERT_EQ(member.start(), array.at(i).start());
+    ++i;
+  }
+  ASSERT_EQ(array.size(), i);
+  ASSERT_VELOCYPACK_EXCEPTION(array.at(array.size()), Exception::IndexOutOfBounds);
+
+  // backwards, via the iterators
+  auto it = array.end();
+  while (it != array.begin()) {
+    --it;
+    ASSERT_EQ(s.at(it.index()).start(), (*it).start());
+  }
+  ASSERT_EQ(static_cast<std::ptrdiff_t>(array.size()), array.end() - array.begin());
+}
+
+static void checkRandomAccessObject(Slice s, uint8_t expectedHead) {
+  ASSERT_EQ(expectedHead, s.head());
+
+  RandomAccessObject object(s);
+  ASSERT_EQ(s.length(), object.size());
+
+  ValueLength i = 0;
+  for (auto const& pair : ObjectIterator(s)) {
+    ASSERT_EQ(pair.key.start(), object[i].key.start());
+    ASSERT_EQ(pair.value.start(), object[i].value.start());
+    ASSERT_EQ(pair.key.start(), object.key(i).start());
+    ASSERT_EQ(pair.value.start(), object.value(i).start());
+    ++i;
+  }
+  ASSERT_EQ(object.size(), i);
+  ASSERT_VELOCYPACK_EXCEPTION(object.key(object.size()), Exception::IndexOutOfBounds);
+  ASSERT_VELOCYPACK_EXCEPTION(object.value(object.size()), Exception::IndexOutOfBounds);
+}
+
+TEST(IteratorTest, RandomAccessArrayLayouts) {
+  Options options;
+  Builder b(&options);
+
+  b.add(Value(ValueType::Array));
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x01);
+
+  // equal member sizes, no index table
+  b.clear();
+  b.openArray();
+  for (int i = 0; i < 10; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x02);
+
+  b.clear();
+  b.openArray();
+  for (int i = 0; i < 300; ++i) {
+    b.add(Value("abcdefghij"));
+  }
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x03);
+
+  // index tables with 1, 2 and 4 byte offsets
+  b.clear();
+  b.openArray();
+  b.add(Value(1));
+  b.add(Value("foo"));
+  b.add(Value(ValueType::Null));
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x06);
+
+  b.clear();
+  b.openArray();
+  for (int i = 0; i < 1000; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x07);
+
+  std::string const large(70000, 'x');
+  b.clear();
+  b.openArray();
+  b.add(Value(large));
+  b.add(Value(1));
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x08);
+
+  // compact
+  options.buildUnindexedArrays = true;
+  b.clear();
+  b.openArray();
+  for (int i = 0; i < 1000; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+  checkRandomAccessArray(b.slice(), 0x13);
+}
+
+TEST(IteratorTest, RandomAccessObjectLayouts) {
+  Options options;
+  Builder b(&options);
+
+  b.add(Value(ValueType::Object));
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x0a);
+
+  b.clear();
+  b.openObject();
+  b.add("a", Value(1));
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x14);
+
+  b.clear();
+  b.openObject();
+  for (int i = 0; i < 20; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x0b);
+
+  b.clear();
+  b.openObject();
+  for (int i = 0; i < 1000; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x0c);
+
+  std::string const large(70000, 'x');
+  b.clear();
+  b.openObject();
+  b.add("z", Value(large));
+  b.add("a", Value(1));
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x0d);
+
+  options.buildUnindexedObjects = true;
+  b.clear();
+  b.openObject();
+  for (int i = 0; i < 1000; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  checkRandomAccessObject(b.slice(), 0x14);
+}
+
+TEST(IteratorTest, RandomAccessUnsortedObjectLayouts) {
+  // the unsorted indexed Object heads use the same index table layouts as
+  // the sorted ones, 4 less
+  auto checkUnsorted = [](Builder const& b, uint8_t head) {
+    std::string data(reinterpret_cast<char const*>(b.slice().start()),
+                     b.slice().byteSize());
+    data[0] = static_cast<char>(head);
+    Slice s(reinterpret_cast<uint8_t const*>(data.data()));
+    Validator validator;
+    ASSERT_TRUE(validator.validate(data.data(), data.size()));
+    checkRandomAccessObject(s, head);
+  };
+
+  Builder b;
+  b.openObject();
+  b.add("c", Value(1));
+  b.add("a", Value("foo"));
+  b.add("b", Value(ValueType::Null));
+  b.close();
+  ASSERT_EQ(0x0b, b.slice().head());
+  checkUnsorted(b, 0x0f);
+
+  b.clear();
+  b.openObject();
+  for (int i = 0; i < 1000; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  ASSERT_EQ(0x0c, b.slice().head());
+  checkUnsorted(b, 0x10);
+
+  std::string const large(70000, 'x');
+  b.clear();
+  b.openObject();
+  b.add("z", Value(large));
+  b.add("a", Value(1));
+  b.close();
+  ASSERT_EQ(0x0d, b.slice().head());
+  checkUnsorted(b, 0x11);
+
+  // 8 byte offsets, followed by the number of members
+  uint8_t const data[] = {
+    0x12, 0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x41, 'b', 0x31,
+    0x41, 'a', 0x32,
+    0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+  };
+  Slice s(data);
+  ASSERT_EQ(sizeof(data), s.byteSize());
+  checkRandomAccessObject(s, 0x12);
+  RandomAccessObject object(s);
+  ASSERT_EQ("b", object.key(0).stringView());
+  ASSERT_EQ(2, object.value(1).getSmallInt());
+}
+
+TEST(IteratorTest, RandomAccessInvalid) {
+  Builder b;
+  b.add(Value(1));
+  ASSERT_VELOCYPACK_EXCEPTION(RandomAccessArray(b.slice()), Exception::InvalidValueType);
+  ASSERT_VELOCYPACK_EXCEPTION(RandomAccessObject(b.slice()), Exception::InvalidValueType);
+
+  b.clear();
+  b.openArray();
+  b.close();
+  ASSERT_VELOCYPACK_EXCEPTION(RandomAccessObject(b.slice()), Exception::InvalidValueType);
+}
+
+TEST(IteratorTest, RandomAccessAlgorithms) {
+  Builder b;
+  b.openArray();
+  for (int i = 0; i < 100; ++i) {
+    b.add(Value(i * 2));
+  }
+  b.close();
+
+  RandomAccessArray array(b.slice());
+  auto it = std::lower_bound(array.begin(), array.end(), 51,
+                             [](Slice s, int v) { return s.getInt() < v; });
+  ASSERT_EQ(26U, it.index());
+  ASSERT_EQ(52, (*it).getInt());
+  ASSERT_EQ(54, it[1].getInt());
+  ASSERT_EQ(50, (*(it - 1)).getInt());
+  ASSERT_EQ(60, (*(2 + it + 2)).getInt());
+  ASSERT_TRUE(array.begin() < it);
+  ASSERT_TRUE(array.end() >= it);
+  ASSERT_EQ(100, std::distance(array.begin(), array.end()));
+}
+
+TEST(IteratorTest, RandomAccessSplit) {
+  Options options;
+  options.buildUnindexedArrays = true;
+  Builder b(&options);
+  b.openArray();
+  for (int i = 0; i < 1001; ++i) {
+    b.add(Value(i));
+  }
+  b.close();
+
+  RandomAccessArray array(b.slice());
+  auto ranges = array.split(4);
+  ASSERT_EQ(4UL, ranges.size());
+  ASSERT_EQ(251U, ranges[0].size());
+  ASSERT_EQ(250U, ranges[3].size());
+  ASSERT_TRUE(ranges[0].begin() == array.begin());
+  ASSERT_TRUE(ranges[3].end() == array.end());
+  for (std::size_t i = 1; i < ranges.size(); ++i) {
+    ASSERT_TRUE(ranges[i - 1].end() == ranges[i].begin());
+  }
+
+  // process the ranges concurrently
+  std::vector<int64_t> sums(ranges.size(), 0);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < ranges.size(); ++i) {
+    threads.emplace_back([&sums, &ranges, i]() {
+      for (Slice s : ranges[i]) {
+        sums[i] += s.getInt();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  int64_t total = 0;
+  for (auto sum : sums) {
+    total += sum;
+  }
+  ASSERT_EQ(1000 * 1001 / 2, total);
+
+  // ranges can be split further
+  auto sub = ranges[1].split(1000);
+  ASSERT_EQ(250UL, sub.size());
+  ASSERT_EQ(1U, sub[0].size());
+  ASSERT_EQ(251, (*sub[0].begin()).getInt());
+
+  ASSERT_EQ(1UL, array.split(0).size());
+
+  b.clear();
+  b.openArray();
+  b.close();
+  ASSERT_TRUE(RandomAccessArray(b.slice()).split(4).empty());
+}
+
+TEST(IteratorTest, RandomAccessObjectSplit) {
+  Builder b;
+  b.openObject();
+  for (int i = 0; i < 10; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+
+  RandomAccessObject object(b.slice());
+  auto ranges = object.split(3);
+  ASSERT_EQ(3UL, ranges.size());
+  int64_t total = 0;
+  std::size_t n = 0;
+  for (auto const& range : ranges) {
+    for (auto pair : range) {
+      ASSERT_EQ("key" + std::to_string(pair.value.getInt()), pair.key.copyString());
+      total += pair.value.getInt();
+      ++n;
+    }
+  }
+  ASSERT_EQ(10UL, n);
+  ASSERT_EQ(45, total);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
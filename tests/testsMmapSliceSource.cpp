@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "tests-common.h"
+
+#ifndef _WIN32
+
+namespace {
+
+class TempFile {
+ public:
+  explicit TempFile(std::string const& data)
+      : _name("vpack-mmap-test-" + std::to_string(++counter) + ".vpack") {
+    std::ofstream ofs(_name, std::ofstream::out | std::ofstream::binary);
+    ofs.write(data.data(), data.size());
+  }
+  ~TempFile() { std::remove(_name.c_str()); }
+
+  std::string const& name() const { return _name; }
+
+ private:
+  static inline int counter = 0;
+  std::string _name;
+};
+
+std::string concat(std::vector<std::string> const& values) {
+  std::string result;
+  for (auto const& json : values) {
+    auto b = Parser::fromJson(json);
+    result.append(reinterpret_cast<char const*>(b->data()), b->size());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(MmapSliceSourceTest, EmptyFile) {
+  TempFile file("");
+  MmapSliceSource source(file.name());
+
+  ASSERT_EQ(0U, source.byteSize());
+  ASSERT_EQ(0U, source.count());
+  ASSERT_FALSE(source.iterator().valid());
+  ASSERT_VELOCYPACK_EXCEPTION(source.at(0), Exception::IndexOutOfBounds);
+}
+
+TEST(MmapSliceSourceTest, MissingFile) {
+  ASSERT_VELOCYPACK_EXCEPTION(MmapSliceSource("vpack-does-not-exist.vpack"),
+                              Exception::InternalError);
+}
+
+TEST(MmapSliceSourceTest, RandomAccess) {
+  std::vector<std::string> const values = {
+      "{\"a\":1}", "[1,2,3]", "\"foobar\"", "null", "{\"b\":[{\"c\":true}]}"};
+  TempFile file(concat(values));
+
+  for (auto validation : {MmapSliceSource::Validation::None,
+                          MmapSliceSource::Validation::Lazy,
+                          MmapSliceSource::Validation::Eager}) {
+    MmapSliceSource source(file.name(), validation,
+                           MmapSliceSource::AccessPattern::Random);
+    ASSERT_EQ(values.size(), source.count());
+    for (std::size_t i = values.size(); i-- > 0;) {
+      ASSERT_EQ(values[i], source.at(i).toJson());
+    }
+    ASSERT_VELOCYPACK_EXCEPTION(source.at(values.size()),
+                                Exception::IndexOutOfBounds);
+  }
+}
+
+TEST(MmapSliceSourceTest, Iterate) {
+  std::vector<std::string> const values = {"1", "[]", "{\"x\":\"y\"}"};
+  std::string const data = concat(values);
+  TempFile file(data);
+
+  MmapSliceSource source(file.name(), MmapSliceSource::Validation::Lazy,
+                         MmapSliceSource::AccessPattern::Sequential);
+  std::size_t i = 0;
+  for (auto it = source.iterator(); it.valid(); it.next()) {
+    ASSERT_EQ(values[i], it.value().toJson());
+    ASSERT_EQ(values[i], it.sharedValue().toJson());
+    ++i;
+  }
+  ASSERT_EQ(values.size(), i);
+  ASSERT_EQ(data.size(), source.byteSize());
+}
+
+TEST(MmapSliceSourceTest, SharedSliceKeepsMappingAlive) {
+  TempFile file(concat({"[1,2]", "{\"a\":\"some longer string value\"}"}));
+
+  SharedSlice s;
+  {
+    MmapSliceSource source(file.name());
+    s = source.sharedAt(1);
+  }
+  ASSERT_EQ("some longer string value", s.get("a").copyString());
+}
+
+TEST(MmapSliceSourceTest, TaggedValues) {
+  Builder b1;
+  b1.addTagged(42, Value("foo"));
+  Builder b2;
+  b2.addTagged(1ULL << 40, Value(ValueType::Array));
+  b2.add(Value(1));
+  b2.close();
+  std::string data(reinterpret_cast<char const*>(b1.data()), b1.size());
+  data.append(reinterpret_cast<char const*>(b2.data()), b2.size());
+  data.append(concat({"true"}));
+  TempFile file(data);
+
+  MmapSliceSource source(file.name(), MmapSliceSource::Validation::Eager);
+  ASSERT_EQ(3U, source.count());
+  ASSERT_EQ(42U, source.at(0).getFirstTag());
+  ASSERT_EQ(1ULL << 40, source.at(1).getFirstTag());
+  ASSERT_EQ("[1]", source.at(1).value().toJson());
+  ASSERT_TRUE(source.at(2).isTrue());
+}
+
+TEST(MmapSliceSourceTest, TruncatedFile) {
+  std::string data = concat({"[1,2,3]", "\"a long enough string value\""});
+  data.resize(data.size() - 3);
+  TempFile file(data);
+
+  ASSERT_VELOCYPACK_EXCEPTION(
+      MmapSliceSource(file.name(), MmapSliceSource::Validation::Eager),
+      Exception::ValidatorInvalidLength);
+
+  MmapSliceSource source(file.name(), MmapSliceSource::Validation::Lazy);
+  ASSERT_VELOCYPACK_EXCEPTION(source.count(), Exception::ValidatorInvalidLength);
+
+  auto it = source.iterator();
+  ASSERT_EQ("[1,2,3]", it.value().toJson());
+  ASSERT_VELOCYPACK_EXCEPTION(it.next(), Exception::ValidatorInvalidLength);
+
+  // a truncated header
+  TempFile header(std::string("\x01\xbf\x20", 3));
+  MmapSliceSource source2(header.name(), MmapSliceSource::Validation::None);
+  ASSERT_VELOCYPACK_EXCEPTION(source2.count(), Exception::ValidatorInvalidLength);
+}
+
+TEST(MmapSliceSourceTest, InvalidValue) {
+  // an Array whose member has an invalid type
+  std::string data = concat({"1"});
+  data.append(std::string("\x02\x03\x16", 3));
+  TempFile file(data);
+
+  ASSERT_VELOCYPACK_EXCEPTION(
+      MmapSliceSource(file.name(), MmapSliceSource::Validation::Eager),
+      Exception::ValidatorInvalidType);
+
+  MmapSliceSource source(file.name(), MmapSliceSource::Validation::Lazy);
+  ASSERT_EQ(2U, source.count());
+  ASSERT_EQ(1U, source.at(0).getUInt());
+  ASSERT_VELOCYPACK_EXCEPTION(source.at(1), Exception::ValidatorInvalidType);
+
+  MmapSliceSource trusted(file.name(), MmapSliceSource::Validation::None);
+  ASSERT_EQ(0x02, trusted.at(1).head());
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
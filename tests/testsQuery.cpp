@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include "tests-common.h"
+
+static std::string const document = R"({
+  "name": "store",
+  "open": true,
+  "books": [
+    {"title": "A", "price": 8.95, "tags": ["x"], "author": {"name": "Nigel"}},
+    {"title": "B", "price": 12.99, "tags": ["y", "z"], "author": {"name": "Evelyn"}},
+    {"title": "C", "price": 8, "isbn": "0-553-21311-3", "author": {"name": "Herman"}},
+    {"title": "D", "price": 22.99, "isbn": "0-395-19395-8", "author": {"name": "J. R. R."}}
+  ],
+  "bicycle": {"color": "red", "price": 19.95},
+  "weird key": 1
+})";
+
+static std::string run(std::string const& expression,
+                       std::string const& json = document) {
+  std::shared_ptr<Builder> input = Parser::fromJson(json);
+  Query query(expression);
+  return query.execute(input->slice()).slice().toJson();
+}
+
+TEST(QueryTest, Root) {
+  ASSERT_EQ("[1]", run("$", "1"));
+  ASSERT_EQ("[{\"a\":1}]", run("  $  ", "{\"a\":1}"));
+}
+
+TEST(QueryTest, Attributes) {
+  ASSERT_EQ("[\"store\"]", run("$.name"));
+  ASSERT_EQ("[\"red\"]", run("$.bicycle.color"));
+  ASSERT_EQ("[\"red\"]", run("$['bicycle'][\"color\"]"));
+  ASSERT_EQ("[1]", run("$['weird key']"));
+  ASSERT_EQ("[19.95,\"red\"]", run("$.bicycle['price', 'color']"));
+  ASSERT_EQ("[]", run("$.missing"));
+  ASSERT_EQ("[]", run("$.name.length"));
+  ASSERT_EQ("[]", run("$.books.title"));
+}
+
+TEST(QueryTest, Positions) {
+  ASSERT_EQ("[\"A\"]", run("$.books[0].title"));
+  ASSERT_EQ("[\"D\"]", run("$.books[-1].title"));
+  ASSERT_EQ("[\"D\",\"A\",\"B\"]", run("$.books[3, 0, 1].title"));
+  ASSERT_EQ("[]", run("$.books[4]"));
+  ASSERT_EQ("[]", run("$.books[-5]"));
+  ASSERT_EQ("[]", run("$.bicycle[0]"));
+}
+
+TEST(QueryTest, Ranges) {
+  ASSERT_EQ("[\"A\",\"B\"]", run("$.books[:2].title"));
+  ASSERT_EQ("[\"C\",\"D\"]", run("$.books[2:].title"));
+  ASSERT_EQ("[\"B\",\"C\"]", run("$.books[1:-1].title"));
+  ASSERT_EQ("[\"A\",\"C\"]", run("$.books[::2].title"));
+  ASSERT_EQ("[\"B\",\"D\"]", run("$.books[1:100:2].title"));
+  ASSERT_EQ("[\"A\",\"B\",\"C\",\"D\"]", run("$.books[:].title"));
+  ASSERT_EQ("[\"D\"]", run("$.books[-1:].title"));
+  ASSERT_EQ("[]", run("$.books[3:1].title"));
+  ASSERT_EQ("[\"A\"]", run("$.books[0:4:9223372036854775807].title"));
+
+  // compact Arrays
+  Options options;
+  options.buildUnindexedArrays = true;
+  std::shared_ptr<Builder> input = Parser::fromJson("[0,1,2,3,4,5,6,7,8,9]", &options);
+  ASSERT_EQ(0x13, input->slice().head());
+  ASSERT_EQ("[1,4,7]", Query("$[1:9:3]").execute(input->slice()).slice().toJson());
+  ASSERT_EQ("[9,0]", Query("$[-1, 0]").execute(input->slice()).slice().toJson());
+}
+
+TEST(QueryTest, Wildcards) {
+  ASSERT_EQ("[\"A\",\"B\",\"C\",\"D\"]", run("$.books[*].title"));
+  ASSERT_EQ("[\"A\",\"B\",\"C\",\"D\"]", run("$.books.*.title"));
+  ASSERT_EQ("[\"x\",\"y\",\"z\"]", run("$.books[*].tags[*]"));
+  ASSERT_EQ("[\"red\",19.95]", run("$.bicycle.*"));
+  ASSERT_EQ("[8.95,12.99,8,22.99]", run("$.*[*].price"));
+  ASSERT_EQ("[19.95]", run("$.*.price"));
+}
+
+TEST(QueryTest, Filters) {
+  ASSERT_EQ("[\"A\",\"C\"]", run("$.books[?(@.price < 10)].title"));
+  ASSERT_EQ("[\"A\",\"C\"]", run("$.books[?(@.price <= 8.95)].title"));
+  ASSERT_EQ("[\"D\"]", run("$.books[?(@.price > 20)].title"));
+  ASSERT_EQ("[\"C\"]", run("$.books[?(@.price == 8)].title"));
+  ASSERT_EQ("[\"C\"]", run("$.books[?(@.price == 8.0)].title"));
+  ASSERT_EQ("[\"A\",\"B\",\"D\"]", run("$.books[?(@.price != 8)].title"));
+  ASSERT_EQ("[\"C\",\"D\"]", run("$.books[?(@.isbn)].title"));
+  ASSERT_EQ("[\"B\"]", run("$.books[?(@.author.name == 'Evelyn')].title"));
+  ASSERT_EQ("[\"B\"]", run("$.books[?(@['author']['name'] == \"Evelyn\")].title"));
+  ASSERT_EQ("[\"B\",\"C\",\"D\"]", run("$.books[?(@.title >= 'B')].title"));
+  ASSERT_EQ("[\"B\"]", run("$.books[?(@.tags[1] == 'z')].title"));
+  ASSERT_EQ("[\"C\"]", run("$.books[?(@.isbn && @.price < 10)].title"));
+  ASSERT_EQ("[\"A\",\"C\",\"D\"]",
+            run("$.books[?(@.price < 9 || @.price > 20 && @.isbn)].title"));
+  ASSERT_EQ("[\"red\"]", run("$[?(@.color == 'red')].color"));
+  ASSERT_EQ("[\"store\"]", run("$[?(@ == 'store')]"));
+
+  // ordering comparisons between different types are false
+  ASSERT_EQ("[]", run("$.books[?(@.price < 'x')].title"));
+  ASSERT_EQ("[]", run("$.books[?(@.title > 1)].title"));
+
+  ASSERT_EQ("[1,null,true]", run("$[?(@ == null || @ == true || @ < 2)]", "[1,null,2,true]"));
+}
+
+TEST(QueryTest, ForEachAndFirst) {
+  std::shared_ptr<Builder> input = Parser::fromJson(document);
+  Query query("$.books[*].author.name");
+
+  std::vector<std::string> names;
+  query.forEach(input->slice(), [&names](Slice s) {
+    names.emplace_back(s.copyString());
+    return names.size() < 2;
+  });
+  ASSERT_EQ(2UL, names.size());
+  ASSERT_EQ("Evelyn", names[1]);
+
+  ASSERT_EQ("Nigel", query.first(input->slice()).copyString());
+  ASSERT_TRUE(Query("$.nope").first(input->slice()).isNone());
+}
+
+TEST(QueryTest, RawCopies) {
+  std::shared_ptr<Builder> input = Parser::fromJson(document);
+  Slice bicycle = input->slice().get("bicycle");
+
+  Builder result;
+  result.openObject();
+  result.add(Value("selected"));
+  Query("$.bicycle").execute(input->slice(), result);
+  result.close();
+
+  Slice selected = result.slice().get("selected").at(0);
+  ASSERT_EQ(bicycle.byteSize(), selected.byteSize());
+  ASSERT_EQ(0, memcmp(bicycle.start(), selected.start(), bicycle.byteSize()));
+}
+
+TEST(QueryTest, Plan) {
+  Query query("$.books[?(@.price < 10)]['title', 'isbn']");
+  ASSERT_EQ("$.books[?(@.price < 10)]['title', 'isbn']", query.expression());
+  ASSERT_EQ(3UL, query.steps().size());
+  ASSERT_EQ(Query::StepType::Names, query.steps()[0].type);
+  ASSERT_EQ(Query::StepType::Filter, query.steps()[1].type);
+  ASSERT_EQ(Query::Operator::Less, query.steps()[1].filter[0][0].op);
+  ASSERT_EQ(2UL, query.steps()[2].names.size());
+}
+
+TEST(QueryTest, InvalidExpressions) {
+  for (char const* expression :
+       {"", "books", "$.", "$..name", "$[", "$[]", "$[*", "$['a'", "$['a',]",
+        "$[1,]", "$[1:2:0]", "$[1:2:-1]", "$[a]", "$.a b", "$[?(@.a <)]",
+        "$[?(@.a == x)]", "$[?(@.a == 1-)]", "$[?(a)]", "$[?(@.a)", "$[?@.a]",
+        "$[?(@.a ||)]", "$[99999999999999999999]", "$[9223372036854775808]",
+        "$[36893488147419103232]", "$[-36893488147419103233]"}) {
+    ASSERT_VELOCYPACK_EXCEPTION(Query{expression}, Exception::InvalidQuery);
+  }
+}
+
+TEST(QueryTest, LargeIntegers) {
+  Query query("$[9223372036854775807, -9223372036854775807]");
+  ASSERT_EQ(1UL, query.steps().size());
+  ASSERT_EQ("[]", run("$[9223372036854775807, -9223372036854775807]", "[1,2]"));
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
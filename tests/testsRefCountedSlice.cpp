@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+
+#include <thread>
+#include <vector>
+
+#include "tests-common.h"
+
+template <typename T>
+class RefCountedSliceTest : public ::testing::Test {};
+
+using RefCountedSliceTypes = ::testing::Types<RefCountedSlice, LocalRefCountedSlice>;
+TYPED_TEST_SUITE(RefCountedSliceTest, RefCountedSliceTypes);
+
+TYPED_TEST(RefCountedSliceTest, DefaultIsNone) {
+  TypeParam s;
+  ASSERT_TRUE(s.slice().isNone());
+  ASSERT_EQ(0U, s.useCount());
+
+  TypeParam copy(s);
+  ASSERT_TRUE(copy.slice().isNone());
+  ASSERT_EQ(0U, copy.useCount());
+}
+
+TYPED_TEST(RefCountedSliceTest, CopiesValue) {
+  auto b = Parser::fromJson("{\"a\":[1,2,3],\"b\":\"foo\"}");
+  TypeParam s(b->slice());
+  ASSERT_EQ(1U, s.useCount());
+  ASSERT_NE(b->slice().start(), s.slice().start());
+  ASSERT_TRUE(s.slice().binaryEquals(b->slice()));
+
+  b->clear();
+  ASSERT_EQ("foo", s.slice().get("b").copyString());
+
+  TypeParam fromBuffer(*Parser::fromJson("[1,2]")->buffer());
+  ASSERT_EQ("[1,2]", fromBuffer.slice().toJson());
+}
+
+TYPED_TEST(RefCountedSliceTest, CopyAndMove) {
+  auto b = Parser::fromJson("[1,2,3]");
+  TypeParam s(b->slice());
+
+  {
+    TypeParam copy(s);
+    ASSERT_EQ(2U, s.useCount());
+    ASSERT_EQ(s.slice().start(), copy.slice().start());
+
+    TypeParam assigned;
+    assigned = copy;
+    ASSERT_EQ(3U, s.useCount());
+    assigned = s;
+    ASSERT_EQ(3U, s.useCount());
+  }
+  ASSERT_EQ(1U, s.useCount());
+
+  TypeParam moved(std::move(s));
+  ASSERT_EQ(1U, moved.useCount());
+  ASSERT_TRUE(s.slice().isNone());
+  ASSERT_EQ(0U, s.useCount());
+
+  TypeParam assigned;
+  assigned = std::move(moved);
+  ASSERT_EQ(1U, assigned.useCount());
+  ASSERT_EQ("[1,2,3]", assigned.slice().toJson());
+}
+
+TYPED_TEST(RefCountedSliceTest, BorrowDoesNotCount) {
+  auto b = Parser::fromJson("{\"a\":{\"b\":[1,2,3]}}");
+  TypeParam s(b->slice());
+
+  auto borrowed = s.get("a").get("b").at(1);
+  ASSERT_EQ(1U, s.useCount());
+  ASSERT_EQ(2U, borrowed.slice().getUInt());
+  ASSERT_EQ(s.slice().start(), s.borrow().slice().start());
+  ASSERT_TRUE(s.get("x").slice().isNone());
+
+  auto shared = borrowed.share();
+  ASSERT_EQ(2U, s.useCount());
+  ASSERT_EQ(2U, shared.slice().getUInt());
+
+  auto alias = s.alias(s.slice().get("a"));
+  ASSERT_EQ(3U, s.useCount());
+  ASSERT_TRUE(alias.slice().isObject());
+
+  // the memory stays valid as long as an alias exists
+  s = TypeParam();
+  ASSERT_EQ(2U, alias.useCount());
+  ASSERT_EQ("{\"b\":[1,2,3]}", alias.slice().toJson());
+}
+
+TEST(RefCountedSliceTest, SharedSliceInterop) {
+  auto b = Parser::fromJson("[1,2,3]");
+  RefCountedSlice s(b->slice());
+  {
+    SharedSlice shared = s.sharedSlice();
+    ASSERT_EQ(2U, s.useCount());
+    ASSERT_EQ(s.slice().start(), shared.slice().start());
+    SharedSlice copy = shared;
+    ASSERT_EQ(2U, s.useCount());
+  }
+  ASSERT_EQ(1U, s.useCount());
+  ASSERT_TRUE(RefCountedSlice().sharedSlice().isNone());
+}
+
+TEST(RefCountedSliceTest, ConcurrentCopies) {
+  auto b = Parser::fromJson("{\"a\":1}");
+  RefCountedSlice s(b->slice());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([s]() {
+      for (int j = 0; j < 10000; ++j) {
+        RefCountedSlice copy(s);
+        ASSERT_EQ(1U, copy.get("a").slice().getUInt());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(1U, s.useCount());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <thread>
+
+#include "tests-common.h"
+
+static uint64_t counter(Statistics::Values const& values,
+                        Statistics::Counter counter) {
+  return values[counter];
+}
+
+TEST(StatisticsTest, Names) {
+  for (std::size_t i = 0; i < Statistics::NumCounters; ++i) {
+    ASSERT_STRNE("unknown", Statistics::name(static_cast<Statistics::Counter>(i)));
+  }
+  ASSERT_STREQ("parsedBytes", Statistics::name(Statistics::ParsedBytes));
+  ASSERT_STREQ("lookupsBinary", Statistics::name(Statistics::LookupsBinary));
+  ASSERT_STREQ("unknown", Statistics::name(Statistics::NumCounters));
+}
+
+TEST(StatisticsTest, ToVelocyPack) {
+  Statistics::Values values{};
+  values[Statistics::DumpCalls] = 42;
+
+  Builder b;
+  Statistics::toVelocyPack(values, b);
+
+  Slice s = b.slice();
+  ASSERT_TRUE(s.isObject());
+  ASSERT_EQ(Statistics::NumCounters + 1, s.length());
+  ASSERT_EQ(Statistics::enabled(), s.get("enabled").getBool());
+  ASSERT_EQ(42UL, s.get("dumpCalls").getUInt());
+  ASSERT_EQ(0UL, s.get("parseCalls").getUInt());
+}
+
+TEST(StatisticsTest, Reset) {
+  Parser::fromJson("{\"a\":1}");
+  Statistics::reset();
+
+  Statistics::Values values = Statistics::thread();
+  for (std::size_t i = 0; i < Statistics::NumCounters; ++i) {
+    ASSERT_EQ(0UL, values[i]);
+  }
+}
+
+TEST(StatisticsTest, ParseAndDump) {
+  std::string const json("{\"a\":1,\"b\":[1,2,3],\"c\":\"foo\"}");
+  Statistics::reset();
+
+  auto builder = Parser::fromJson(json);
+  std::string dumped = builder->slice().toJson();
+
+  Statistics::Values values = Statistics::thread();
+  if (Statistics::enabled()) {
+    ASSERT_EQ(1UL, counter(values, Statistics::ParseCalls));
+    ASSERT_EQ(json.size(), counter(values, Statistics::ParsedBytes));
+    ASSERT_EQ(1UL, counter(values, Statistics::DumpCalls));
+    ASSERT_EQ(builder->slice().byteSize(),
+              counter(values, Statistics::DumpedBytes));
+    ASSERT_EQ(1UL, counter(values, Statistics::IndexSorts));
+    ASSERT_EQ(1UL, counter(values, Statistics::IndexSortsSkipped));
+  } else {
+    ASSERT_EQ(0UL, counter(values, Statistics::ParseCalls));
+    ASSERT_EQ(0UL, counter(values, Statistics::DumpCalls));
+    ASSERT_EQ(0UL, counter(values, Statistics::IndexSorts));
+  }
+}
+
+TEST(StatisticsTest, BufferGrowth) {
+  Statistics::reset();
+
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 1000; ++i) {
+    b.add(Value(std::string(20, 'x')));
+  }
+  b.close();
+
+  Statistics::Values values = Statistics::thread();
+  if (Statistics::enabled()) {
+    ASSERT_LT(0UL, counter(values, Statistics::BufferReallocations));
+    ASSERT_LE(b.size(), counter(values, Statistics::BufferGrowthBytes));
+  } else {
+    ASSERT_EQ(0UL, counter(values, Statistics::BufferReallocations));
+    ASSERT_EQ(0UL, counter(values, Statistics::BufferGrowthBytes));
+  }
+}
+
+TEST(StatisticsTest, Lookups) {
+  Builder b;
+  b.openObject();
+  for (std::size_t i = 0; i < 10; ++i) {
+    b.add("key" + std::to_string(i), Value(i));
+  }
+  b.close();
+  Builder c;
+  c.openObject(true);
+  c.add("a", Value(1));
+  c.add("b", Value(2));
+  c.close();
+
+  Statistics::reset();
+  ASSERT_EQ(3UL, b.slice().get("key3").getUInt());
+  ASSERT_EQ(1UL, c.slice().get("a").getUInt());
+  ASSERT_TRUE(Slice::emptyObjectSlice().get("a").isNone());
+
+  Builder small;
+  small.openObject();
+  small.add("a", Value(1));
+  small.add("b", Value(2));
+  small.close();
+  ASSERT_EQ(2UL, small.slice().get("b").getUInt());
+
+  Statistics::Values values = Statistics::thread();
+  if (Statistics::enabled()) {
+    ASSERT_EQ(1UL, counter(values, Statistics::LookupsBinary));
+    ASSERT_EQ(1UL, counter(values, Statistics::LookupsCompact));
+    ASSERT_EQ(1UL, counter(values, Statistics::LookupsLinear));
+  } else {
+    ASSERT_EQ(0UL, counter(values, Statistics::LookupsBinary));
+    ASSERT_EQ(0UL, counter(values, Statistics::LookupsCompact));
+    ASSERT_EQ(0UL, counter(values, Statistics::LookupsLinear));
+  }
+}
+
+TEST(StatisticsTest, Validator) {
+  auto builder = Parser::fromJson("[1,2,[3,4],{\"a\":\"b\"}]");
+  Statistics::reset();
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(builder->slice().start(),
+                                 builder->slice().byteSize()));
+
+  Statistics::Values values = Statistics::thread();
+  if (Statistics::enabled()) {
+    // nested values are not counted as separate invocations
+    ASSERT_EQ(1UL, counter(values, Statistics::ValidatorCalls));
+    ASSERT_EQ(builder->slice().byteSize(),
+              counter(values, Statistics::ValidatedBytes));
+  } else {
+    ASSERT_EQ(0UL, counter(values, Statistics::ValidatorCalls));
+  }
+}
+
+TEST(StatisticsTest, ThreadsAreAggregated) {
+  Statistics::Values before = Statistics::total();
+
+  std::thread t([]() {
+    for (int i = 0; i < 10; ++i) {
+      Parser::fromJson("[1,2,3]");
+    }
+  });
+  t.join();
+
+  Statistics::Values after = Statistics::total();
+  if (Statistics::enabled()) {
+    // the exited thread's counters must still be part of the totals
+    ASSERT_EQ(10UL, counter(after, Statistics::ParseCalls) -
+                        counter(before, Statistics::ParseCalls));
+  } else {
+    ASSERT_EQ(0UL, counter(after, Statistics::ParseCalls));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
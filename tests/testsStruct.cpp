@@ -0,0 +1,364 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tests-common.h"
+
+namespace structtest {
+
+struct Inner {
+  std::string name;
+  int64_t value = 0;
+};
+VPACK_STRUCT(Inner, value, name)
+
+struct Outer {
+  uint32_t zeta = 0;
+  bool alpha = false;
+  double mid = 0.0;
+  std::vector<int> numbers;
+  std::vector<std::string> strings;
+  std::vector<Inner> inners;
+  std::optional<Inner> maybe;
+  std::optional<int> maybeNumber;
+  std::map<std::string, Inner> byName;
+  std::unordered_map<std::string, double> weights;
+  Inner inner;
+};
+VPACK_STRUCT(Outer, zeta, alpha, mid, numbers, strings, inners, maybe,
+             maybeNumber, byName, weights, inner)
+
+struct Small {
+  int8_t value = 0;
+};
+VPACK_STRUCT(Small, value)
+
+VPACK_STRUCT_VIEW(InnerView, Inner, name, value)
+VPACK_STRUCT_VIEW(OuterView, Outer, zeta, alpha, mid, numbers, strings, inners,
+                  maybe, maybeNumber, byName, inner)
+
+struct Defaults {
+  std::string name = "unnamed";
+  int count = 7;
+};
+VPACK_STRUCT(Defaults, name, count)
+
+Outer makeOuter() {
+  Outer o;
+  o.zeta = 4000000000U;
+  o.alpha = true;
+  o.mid = 2.5;
+  o.numbers = {1, -2, 300, 70000};
+  o.strings = {"foo", "bar", ""};
+  o.inners = {{"a", 1}, {"b", -1}};
+  o.maybe = Inner{"maybe", 42};
+  o.byName = {{"x", {"ex", 10}}, {"y", {"why", 11}}};
+  o.weights = {{"w1", 0.5}, {"w2", 1.5}};
+  o.inner = {"inner", 99};
+  return o;
+}
+
+}  // namespace structtest
+
+using namespace structtest;
+
+TEST(StructTest, Info) {
+  static_assert(StructInfo<Inner>::size == 2);
+  static_assert(StructInfo<Inner>::names[0] == "value");
+  static_assert(StructInfo<Inner>::order[0] == 1);
+  static_assert(StructInfo<Inner>::order[1] == 0);
+  static_assert(StructInfo<Inner>::find("name") == 1);
+  static_assert(StructInfo<Inner>::find("value") == 0);
+  static_assert(StructInfo<Inner>::find("nam") == 2);
+  static_assert(IsVPackStruct<Outer>::value);
+  static_assert(!IsVPackStruct<int>::value);
+  static_assert(!IsVPackStruct<std::string>::value);
+
+  Slice key(StructInfo<Inner>::keys.data() + StructInfo<Inner>::keyOffsets[1]);
+  ASSERT_TRUE(key.isString());
+  ASSERT_EQ("name", key.stringView());
+}
+
+TEST(StructTest, SerializeSortedAttributes) {
+  Inner inner{"foo", 17};
+
+  Builder b;
+  serializeStruct(b, inner);
+
+  Builder expected;
+  expected.openObject();
+  expected.add("name", Value("foo"));
+  expected.add("value", Value(17));
+  expected.close();
+
+  ASSERT_EQ(expected.size(), b.size());
+  ASSERT_EQ(0, memcmp(expected.data(), b.data(), b.size()));
+
+  // attributes are stored in sorted order
+  ObjectIterator it(b.slice(), true);
+  ASSERT_EQ("name", it.key().stringView());
+  it.next();
+  ASSERT_EQ("value", it.key().stringView());
+}
+
+TEST(StructTest, RoundTrip) {
+  Outer o = makeOuter();
+
+  Builder b;
+  serializeStruct(b, o);
+  Slice s = b.slice();
+
+  ASSERT_TRUE(s.isObject());
+  ASSERT_EQ(11UL, s.length());
+  ASSERT_EQ(4000000000ULL, s.get("zeta").getUInt());
+  ASSERT_TRUE(s.get("maybeNumber").isNull());
+  ASSERT_EQ(4UL, s.get("numbers").length());
+  ASSERT_EQ("why", s.get(std::vector<std::string>{"byName", "y", "name"})
+                       .stringView());
+
+  Outer r = deserializeStruct<Outer>(s);
+  ASSERT_EQ(o.zeta, r.zeta);
+  ASSERT_EQ(o.alpha, r.alpha);
+  ASSERT_EQ(o.mid, r.mid);
+  ASSERT_EQ(o.numbers, r.numbers);
+  ASSERT_EQ(o.strings, r.strings);
+  ASSERT_EQ(2UL, r.inners.size());
+  ASSERT_EQ("b", r.inners[1].name);
+  ASSERT_EQ(-1, r.inners[1].value);
+  ASSERT_TRUE(r.maybe.has_value());
+  ASSERT_EQ("maybe", r.maybe->name);
+  ASSERT_EQ(42, r.maybe->value);
+  ASSERT_FALSE(r.maybeNumber.has_value());
+  ASSERT_EQ(2UL, r.byName.size());
+  ASSERT_EQ("ex", r.byName["x"].name);
+  ASSERT_EQ(11, r.byName["y"].value);
+  ASSERT_EQ(o.weights, r.weights);
+  ASSERT_EQ("inner", r.inner.name);
+  ASSERT_EQ(99, r.inner.value);
+
+  // serializing again produces the same bytes. the order of the
+  // unordered_map members is unspecified, so skip it
+  r.weights.clear();
+  o.weights.clear();
+  Builder b1;
+  serializeStruct(b1, o);
+  Builder b2;
+  serializeStruct(b2, r);
+  ASSERT_EQ(b1.size(), b2.size());
+  ASSERT_EQ(0, memcmp(b1.data(), b2.data(), b1.size()));
+}
+
+TEST(StructTest, SerializeAsAttributeValue) {
+  Builder b;
+  b.openObject();
+  b.add(Value("payload"));
+  serializeStruct(b, Inner{"x", 1});
+  b.add("other", Value(true));
+  b.close();
+
+  Slice s = b.slice();
+  ASSERT_EQ("x", s.get(std::vector<std::string>{"payload", "name"}).stringView());
+  ASSERT_TRUE(s.get("other").getBool());
+}
+
+TEST(StructTest, DeserializeUnsorted) {
+  Options options;
+  options.buildUnindexedObjects = true;
+  std::shared_ptr<Builder> b = Parser::fromJson(
+      R"({"value":5,"unknown":[1,2,3],"name":"abc","more":{"name":"no"}})",
+      &options);
+
+  Inner r = deserializeStruct<Inner>(b->slice());
+  ASSERT_EQ("abc", r.name);
+  ASSERT_EQ(5, r.value);
+}
+
+TEST(StructTest, DeserializeMissingAttributes) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"({"alpha":true})");
+
+  Outer r;
+  r.mid = 1.25;
+  r.maybeNumber = 3;
+  deserializeStruct(b->slice(), r);
+  ASSERT_TRUE(r.alpha);
+  ASSERT_EQ(1.25, r.mid);
+  ASSERT_EQ(3, r.maybeNumber);
+  ASSERT_TRUE(r.numbers.empty());
+
+  b = Parser::fromJson(R"({"maybeNumber":null,"maybe":{"value":3}})");
+  deserializeStruct(b->slice(), r);
+  ASSERT_FALSE(r.maybeNumber.has_value());
+  ASSERT_TRUE(r.maybe.has_value());
+  ASSERT_EQ(3, r.maybe->value);
+  ASSERT_EQ("", r.maybe->name);
+}
+
+TEST(StructTest, DeserializeInvalid) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"([1,2])");
+  ASSERT_VELOCYPACK_EXCEPTION(deserializeStruct<Inner>(b->slice()),
+                              Exception::InvalidValueType);
+
+  b = Parser::fromJson(R"({"name":1})");
+  ASSERT_VELOCYPACK_EXCEPTION(deserializeStruct<Inner>(b->slice()),
+                              Exception::InvalidValueType);
+
+  b = Parser::fromJson(R"({"numbers":{}})");
+  ASSERT_VELOCYPACK_EXCEPTION(deserializeStruct<Outer>(b->slice()),
+                              Exception::InvalidValueType);
+
+  b = Parser::fromJson(R"({"value":1000})");
+  ASSERT_VELOCYPACK_EXCEPTION(deserializeStruct<Small>(b->slice()),
+                              Exception::NumberOutOfRange);
+}
+
+TEST(StructTest, View) {
+  Outer o = makeOuter();
+  Builder b;
+  serializeStruct(b, o);
+
+  OuterView view(b.slice());
+  ASSERT_EQ(4000000000U, view.zeta());
+  ASSERT_TRUE(view.alpha());
+  ASSERT_EQ(2.5, view.mid());
+
+  auto numbers = view.numbers();
+  ASSERT_EQ(4UL, numbers.size());
+  ASSERT_EQ(300, numbers[2]);
+  std::vector<int> collected;
+  for (int v : numbers) {
+    collected.push_back(v);
+  }
+  ASSERT_EQ(o.numbers, collected);
+
+  std::vector<std::string_view> strings;
+  for (std::string_view v : view.strings()) {
+    strings.push_back(v);
+  }
+  ASSERT_EQ(3UL, strings.size());
+  ASSERT_EQ("bar", strings[1]);
+  // strings point into the VPack data
+  ASSERT_TRUE(strings[1].data() > reinterpret_cast<char const*>(b.data()) &&
+              strings[1].data() <
+                  reinterpret_cast<char const*>(b.data() + b.size()));
+
+  // nested views use the view types defined for them
+  InnerView inner = view.inner();
+  ASSERT_EQ("inner", inner.name());
+  ASSERT_EQ(99, inner.value());
+  ASSERT_EQ("b", view.inners()[1].name());
+
+  std::optional<InnerView> maybe = view.maybe();
+  ASSERT_TRUE(maybe.has_value());
+  ASSERT_EQ(42, maybe->value());
+  ASSERT_FALSE(view.maybeNumber().has_value());
+
+  auto byName = view.byName();
+  ASSERT_EQ(2UL, byName.size());
+  ASSERT_EQ("why", byName.get("y")->name());
+  ASSERT_FALSE(byName.get("z").has_value());
+  std::size_t count = 0;
+  for (auto [key, value] : byName) {
+    ASSERT_EQ(key == "x" ? 10 : 11, value.value());
+    ++count;
+  }
+  ASSERT_EQ(2UL, count);
+
+  // members without a named accessor
+  ASSERT_TRUE(view.has<9>());
+  ASSERT_EQ(1.5, view.get<9>().get("w2").value());
+
+  Outer r = view.toStruct();
+  ASSERT_EQ(o.strings, r.strings);
+}
+
+TEST(StructTest, ViewMissingAttributes) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"({"count":3,"other":1})");
+  StructView<Defaults> view(b->slice());
+  ASSERT_FALSE(view.has<0>());
+  ASSERT_TRUE(view.member<0>().isNone());
+  ASSERT_EQ("unnamed", view.get<0>());
+  ASSERT_TRUE(view.has<1>());
+  ASSERT_EQ(3, view.get<1>());
+
+  b = Parser::fromJson(R"({"alpha":true})");
+  OuterView outer(b->slice());
+  ASSERT_TRUE(outer.alpha());
+  ASSERT_EQ(0.0, outer.mid());
+  ASSERT_TRUE(outer.numbers().empty());
+  ASSERT_TRUE(outer.byName().empty());
+  ASSERT_FALSE(outer.maybe().has_value());
+  ASSERT_EQ("", outer.inner().name());
+}
+
+TEST(StructTest, ViewInvalid) {
+  std::shared_ptr<Builder> b = Parser::fromJson(R"([1])");
+  ASSERT_VELOCYPACK_EXCEPTION(InnerView(b->slice()),
+                              Exception::InvalidValueType);
+
+  // conversion errors are reported on access
+  b = Parser::fromJson(R"({"name":1,"value":2,"numbers":{}})");
+  InnerView inner(b->slice());
+  ASSERT_EQ(2, inner.value());
+  ASSERT_VELOCYPACK_EXCEPTION(inner.name(), Exception::InvalidValueType);
+  OuterView outer(b->slice());
+  ASSERT_VELOCYPACK_EXCEPTION(outer.numbers(), Exception::InvalidValueType);
+}
+
+TEST(StructTest, CloseAlreadySortedObject) {
+  // close() skips sorting if the attributes are already in order. the
+  // result must be the same as for unsorted input
+  Builder sorted;
+  sorted.openObject();
+  Builder unsorted;
+  unsorted.openObject();
+  for (int i = 0; i < 300; ++i) {
+    std::string key = "key" + std::to_string(1000 + i);
+    sorted.add(key, Value(i));
+  }
+  for (int i = 299; i >= 0; --i) {
+    std::string key = "key" + std::to_string(1000 + i);
+    unsorted.add(key, Value(i));
+  }
+  sorted.close();
+  unsorted.close();
+
+  ASSERT_EQ(sorted.size(), unsorted.size());
+  ASSERT_EQ(299, sorted.slice().get("key1299").getInt());
+  ASSERT_EQ(299, unsorted.slice().get("key1299").getInt());
+  ASSERT_EQ("key1000", sorted.slice().keyAt(0).stringView());
+  ASSERT_EQ("key1000", unsorted.slice().keyAt(0).stringView());
+}
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
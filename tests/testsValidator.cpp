@@ -2380,6 +2380,58 @@ TEST(ValidatorTest, ObjectFourByteManyEntries) {
   ASSERT_TRUE(validator.validate(b.slice().start(), b.slice().byteSize()));
 }
 
+TEST(ValidatorTest, StringReference) {
+  StringReferencesScope scope;
+  std::string const value("\x02\x0a\x43" "abc" "\xee\xff\x28\x04", 10);
+
+  Validator validator;
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+  Slice s(reinterpret_cast<uint8_t const*>(value.data()));
+  ASSERT_EQ("abc", s.at(1).stringView());
+  ASSERT_EQ("[\"abc\",\"abc\"]", s.toJson());
+}
+
+TEST(ValidatorTest, StringReferenceInvalid) {
+  StringReferencesScope scope;
+  Validator validator;
+
+  // before the start of the value
+  std::string value("\x02\x0a\x43" "abc" "\xee\xff\x28\x07", 10);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // zero distance
+  value[9] = 0x00;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // not pointing to a String
+  value[9] = 0x05;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+
+  // String overlapping the reference
+  value[9] = 0x02;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidLength);
+
+  // not a UInt
+  value[8] = 0x34;
+  value[9] = 0x34;
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(value.c_str(), value.size()), Exception::ValidatorInvalidType);
+
+  // top-level reference
+  std::string const top("\xee\xff\x28\x01", 4);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(top.c_str(), top.size()), Exception::ValidatorInvalidLength);
+
+  // out of the innermost Array
+  std::string const nested("\x02\x0e\x45" "abcde" "\x02\x06\xee\xff\x28\x08", 14);
+  ASSERT_VELOCYPACK_EXCEPTION(validator.validate(nested.c_str(), nested.size()), Exception::ValidatorInvalidLength);
+}
+
+TEST(ValidatorTest, StringReferenceDisabled) {
+  // without resolving, tag 255 is a regular tag
+  std::string const value("\x02\x0c\x44" "abcd" "\x02\x05\xee\xff\x34", 12);
+  Validator validator;
+  ASSERT_TRUE(validator.validate(value.c_str(), value.size()));
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
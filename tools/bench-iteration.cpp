@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [DOCUMENTS [ROUNDS]]" << std::endl;
+  std::cout << "This program builds an Array of DOCUMENTS Objects of varying"
+            << std::endl;
+  std::cout << "size (default: 200000, about 200 MB) and then looks up an"
+            << std::endl;
+  std::cout << "attribute in each of them, ROUNDS times (default: 5), with"
+            << std::endl;
+  std::cout << "different prefetch distances for ArrayIterator. Prefetch"
+            << std::endl;
+  std::cout << "distance 0 means no prefetching. On Linux, the number of"
+            << std::endl;
+  std::cout << "cache misses is reported if hardware counters are available."
+            << std::endl;
+}
+
+namespace {
+
+// counts cache misses of the calling thread via perf_event_open, if
+// available
+class CacheMissCounter {
+ public:
+  CacheMissCounter() : _fd(-1) {
+#ifdef __linux__
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    _fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~CacheMissCounter() {
+#ifdef __linux__
+    if (_fd >= 0) {
+      ::close(_fd);
+    }
+#endif
+  }
+
+  bool available() const { return _fd >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (_fd >= 0) {
+      ::ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  uint64_t stop() {
+    uint64_t value = 0;
+#ifdef __linux__
+    if (_fd >= 0) {
+      ::ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (::read(_fd, &value, sizeof(value)) != sizeof(value)) {
+        value = 0;
+      }
+    }
+#endif
+    return value;
+  }
+
+ private:
+  int _fd;
+};
+
+// builds an Array of Objects with a random amount of padding, so that
+// the positions of the Objects do not follow a fixed stride
+void buildDocuments(Builder& builder, std::size_t n) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<std::size_t> padding(200, 1800);
+  std::string const filler(2000, 'x');
+
+  builder.openArray();
+  for (std::size_t i = 0; i < n; ++i) {
+    builder.openObject();
+    builder.add("_key", Value("document" + std::to_string(i)));
+    builder.add("padding", Value(std::string_view(filler.data(), padding(rng))));
+    builder.add("value", Value(i));
+    builder.add("zzz", Value(true));
+    builder.close();
+  }
+  builder.close();
+}
+
+uint64_t scan(Slice documents, ValueLength prefetchDistance) {
+  uint64_t sum = 0;
+  ArrayIterator it(documents, prefetchDistance);
+  while (it.valid()) {
+    sum += it.value().get("value").getUInt();
+    it.next();
+  }
+  return sum;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc > 3 || (argc > 1 && (std::strcmp(argv[1], "--help") == 0 ||
+                                std::strcmp(argv[1], "-h") == 0))) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::size_t const documents =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  std::size_t const rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+  if (documents == 0 || rounds == 0) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  Builder builder;
+  buildDocuments(builder, documents);
+  Slice slice = builder.slice();
+  std::cout << "Array of " << documents << " documents, " << slice.byteSize()
+            << " bytes" << std::endl;
+
+  uint64_t const expected =
+      static_cast<uint64_t>(documents) * (documents - 1) / 2;
+  CacheMissCounter counter;
+
+  for (ValueLength distance : {0, 2, 4, 8, 16, 32}) {
+    double best = 0.0;
+    uint64_t misses = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+      counter.start();
+      auto start = std::chrono::high_resolution_clock::now();
+      uint64_t sum = scan(slice, distance);
+      auto end = std::chrono::high_resolution_clock::now();
+      uint64_t m = counter.stop();
+
+      if (sum != expected) {
+        std::cerr << "unexpected result " << sum << std::endl;
+        return EXIT_FAILURE;
+      }
+      double ms = std::chrono::duration<double, std::milli>(end - start).count();
+      if (round == 0 || ms < best) {
+        best = ms;
+        misses = m;
+      }
+    }
+
+    std::cout << "prefetch distance " << std::setw(2) << distance << ": "
+              << std::fixed << std::setprecision(2) << std::setw(8) << best
+              << " ms, " << std::setprecision(1) << std::setw(6)
+              << (best * 1000000.0 / documents) << " ns/document";
+    if (counter.available()) {
+      std::cout << ", " << std::setw(10) << misses << " cache misses";
+    }
+    std::cout << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
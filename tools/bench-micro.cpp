@@ -0,0 +1,507 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "velocypack/vpack.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [OPTIONS]" << std::endl;
+  std::cout << "Runs microbenchmarks for the core VPack operations on the JSON"
+            << std::endl;
+  std::cout << "files in tests/jsonSample and on synthetic data." << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --filter TEXT       only run benchmarks whose name contains TEXT"
+            << std::endl;
+  std::cout << "  --min-time MS       minimum time per repetition (default: 200)"
+            << std::endl;
+  std::cout << "  --repetitions N     number of repetitions (default: 5)"
+            << std::endl;
+  std::cout << "  --json FILE         write the results as JSON to FILE ('-' for stdout)"
+            << std::endl;
+  std::cout << "  --corpus DIRECTORY  directory with JSON input files"
+            << std::endl;
+  std::cout << "                      (default: tests/jsonSample)" << std::endl;
+  std::cout << "  --list              only list the benchmark names" << std::endl;
+  std::cout << "Results can be compared with scripts/bench-compare.py."
+            << std::endl;
+}
+
+namespace {
+
+// prevents the compiler from optimizing away benchmarked operations
+uint64_t volatile sink = 0;
+
+struct Benchmark {
+  std::string name;
+  // bytes processed per operation, for throughput. 0 if not applicable
+  std::size_t bytes;
+  // performs a single operation
+  std::function<uint64_t()> run;
+};
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  std::size_t repetitions;
+  double nsPerOp;
+  double minNsPerOp;
+  double maxNsPerOp;
+  double bytesPerSecond;
+};
+
+// input data shared by several benchmarks
+struct Corpus {
+  std::string name;
+  std::string json;
+  std::shared_ptr<Builder> vpack;
+};
+
+std::string const corpusFiles[] = {
+    "api-docs.json", "commits.json",   "countries.json",
+    "directory-tree.json", "doubles.json", "file-list.json",
+    "object.json", "random3.json", "sample.json", "small.json"};
+
+bool readFile(std::string const& filename, std::string& result) {
+  std::ifstream ifs(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  char buffer[4096];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    result.append(buffer, ifs.gcount());
+  }
+  return true;
+}
+
+std::string findCorpusDirectory() {
+  std::string directory = "tests/jsonSample";
+  for (std::size_t i = 0; i < 4; ++i) {
+    std::string probe;
+    if (readFile(directory + "/small.json", probe)) {
+      return directory;
+    }
+    directory = "../" + directory;
+  }
+  return std::string();
+}
+
+Corpus makeCorpus(std::string name, std::string json) {
+  Corpus corpus;
+  corpus.name = std::move(name);
+  corpus.json = std::move(json);
+  corpus.vpack = Parser::fromJson(corpus.json);
+  return corpus;
+}
+
+// deterministic synthetic inputs, which do not depend on any files
+std::vector<Corpus> syntheticCorpora() {
+  std::mt19937_64 rng(42);
+  std::vector<Corpus> result;
+  std::string const alphabet =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 \"\\/\n\t";
+
+  auto randomString = [&rng, &alphabet](std::size_t length) {
+    std::string s;
+    for (std::size_t i = 0; i < length; ++i) {
+      s.push_back(alphabet[rng() % alphabet.size()]);
+    }
+    return s;
+  };
+
+  Builder b;
+  b.openArray();
+  for (std::size_t i = 0; i < 10000; ++i) {
+    b.openObject();
+    b.add("_key", Value(std::to_string(i)));
+    b.add("name", Value(randomString(5 + rng() % 20)));
+    b.add("active", Value(rng() % 2 == 0));
+    b.add("score", Value(static_cast<double>(rng() % 100000) / 100.0));
+    b.add("count", Value(rng() % 1000000));
+    b.add("tags", Value(ValueType::Array));
+    for (std::size_t j = rng() % 5; j > 0; --j) {
+      b.add(Value(randomString(3 + rng() % 8)));
+    }
+    b.close();
+    b.add("nested", Value(ValueType::Object));
+    b.add("x", Value(static_cast<int64_t>(rng() % 2000) - 1000));
+    b.add("y", Value(ValueType::Null));
+    b.close();
+    b.close();
+  }
+  b.close();
+  result.emplace_back(makeCorpus("synthetic-documents", b.toJson()));
+
+  b.clear();
+  b.openArray();
+  for (std::size_t i = 0; i < 100000; ++i) {
+    if (i % 2 == 0) {
+      b.add(Value(static_cast<int64_t>(rng() >> (rng() % 64))));
+    } else {
+      b.add(Value(static_cast<double>(rng() % 10000000) / 1000.0));
+    }
+  }
+  b.close();
+  result.emplace_back(makeCorpus("synthetic-numbers", b.toJson()));
+
+  b.clear();
+  b.openArray();
+  for (std::size_t i = 0; i < 20000; ++i) {
+    b.add(Value(randomString(5 + rng() % 100)));
+  }
+  b.close();
+  result.emplace_back(makeCorpus("synthetic-strings", b.toJson()));
+
+  return result;
+}
+
+uint64_t traverse(Slice slice) {
+  if (slice.isArray()) {
+    uint64_t n = 0;
+    for (Slice it : ArrayIterator(slice)) {
+      n += traverse(it);
+    }
+    return n;
+  }
+  if (slice.isObject()) {
+    uint64_t n = 0;
+    ObjectIterator it(slice, true);
+    while (it.valid()) {
+      n += traverse(it.value());
+      it.next();
+    }
+    return n;
+  }
+  return 1;
+}
+
+std::vector<std::string> makeKeys(std::size_t n) {
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < n; ++i) {
+    keys.emplace_back("attribute" + std::to_string(i * 7919 % 100003));
+  }
+  return keys;
+}
+
+void addCorpusBenchmarks(std::vector<Benchmark>& benchmarks,
+                         std::shared_ptr<Corpus> const& corpus) {
+  Slice slice = corpus->vpack->slice();
+  std::size_t const vpackSize = slice.byteSize();
+
+  benchmarks.push_back({"parse/" + corpus->name, corpus->json.size(),
+                        [corpus, parser = std::make_shared<Parser>()]() {
+                          parser->clear();
+                          return parser->parse(corpus->json);
+                        }});
+  benchmarks.push_back({"dump/" + corpus->name, vpackSize, [slice]() {
+                          return static_cast<uint64_t>(Dumper::toString(slice).size());
+                        }});
+  benchmarks.push_back(
+      {"validate/" + corpus->name, vpackSize,
+       [slice, validator = std::make_shared<Validator>()]() {
+         return static_cast<uint64_t>(validator->validate(slice.start(), slice.byteSize()));
+       }});
+  benchmarks.push_back({"hash/" + corpus->name, vpackSize,
+                        [slice]() { return slice.hash(); }});
+  benchmarks.push_back({"normalized-hash/" + corpus->name, vpackSize,
+                        [slice]() { return slice.normalizedHash(); }});
+  benchmarks.push_back({"iterate/" + corpus->name, vpackSize,
+                        [slice]() { return traverse(slice); }});
+}
+
+void addLookupBenchmarks(std::vector<Benchmark>& benchmarks) {
+  for (std::size_t width : {4, 16, 64, 256, 1024}) {
+    for (bool compact : {false, true}) {
+      auto keys = std::make_shared<std::vector<std::string>>(makeKeys(width));
+      auto options = std::make_shared<Options>();
+      options->buildUnindexedObjects = compact;
+      auto builder = std::make_shared<Builder>(options.get());
+      builder->openObject();
+      for (std::size_t i = 0; i < width; ++i) {
+        builder->add((*keys)[i], Value(i));
+      }
+      builder->close();
+
+      // look up all keys in a shuffled order, one per operation
+      std::shuffle(keys->begin(), keys->end(), std::mt19937(42));
+      auto position = std::make_shared<std::size_t>(0);
+      benchmarks.push_back(
+          {std::string(compact ? "get-compact/" : "get/") + "width-" +
+               std::to_string(width),
+           0, [keys, options, builder, position]() {
+             std::size_t& p = *position;
+             std::string const& key = (*keys)[p];
+             p = (p + 1 == keys->size()) ? 0 : p + 1;
+             return builder->slice().get(key).getUInt();
+           }});
+    }
+  }
+}
+
+void addBuilderBenchmarks(std::vector<Benchmark>& benchmarks) {
+  for (std::size_t width : {16, 256, 4096}) {
+    for (bool sorted : {true, false}) {
+      auto keys = std::make_shared<std::vector<std::string>>(makeKeys(width));
+      if (sorted) {
+        std::sort(keys->begin(), keys->end());
+      } else {
+        std::shuffle(keys->begin(), keys->end(), std::mt19937(42));
+      }
+      auto builder = std::make_shared<Builder>();
+      benchmarks.push_back(
+          {std::string("build-object/") + (sorted ? "sorted-" : "unsorted-") +
+               std::to_string(width),
+           0, [keys, builder]() {
+             builder->clear();
+             builder->openObject();
+             uint64_t i = 0;
+             for (auto const& key : *keys) {
+               builder->add(key, Value(i++));
+             }
+             builder->close();
+             return static_cast<uint64_t>(builder->size());
+           }});
+    }
+  }
+
+  for (std::size_t length : {16, 4096}) {
+    auto builder = std::make_shared<Builder>();
+    benchmarks.push_back({"build-array/" + std::to_string(length), 0,
+                          [length, builder]() {
+                            builder->clear();
+                            builder->openArray();
+                            for (std::size_t i = 0; i < length; ++i) {
+                              builder->add(Value(i * 1000));
+                            }
+                            builder->close();
+                            return static_cast<uint64_t>(builder->size());
+                          }});
+  }
+}
+
+double measure(Benchmark const& benchmark, uint64_t iterations) {
+  uint64_t result = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; ++i) {
+    result += benchmark.run();
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = sink + result;
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+Result run(Benchmark const& benchmark, double minTimeNs, std::size_t repetitions) {
+  // find the number of iterations that takes at least minTimeNs
+  uint64_t iterations = 1;
+  while (true) {
+    double elapsed = measure(benchmark, iterations);
+    if (elapsed >= minTimeNs || iterations >= (uint64_t(1) << 40)) {
+      break;
+    }
+    double factor = elapsed > 0.0 ? (minTimeNs * 1.2) / elapsed : 10.0;
+    factor = (std::min)((std::max)(factor, 2.0), 10.0);
+    iterations = static_cast<uint64_t>(std::ceil(iterations * factor));
+  }
+
+  std::vector<double> samples;
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    samples.push_back(measure(benchmark, iterations) / iterations);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result result;
+  result.name = benchmark.name;
+  result.iterations = iterations;
+  result.repetitions = repetitions;
+  result.nsPerOp = samples[samples.size() / 2];
+  result.minNsPerOp = samples.front();
+  result.maxNsPerOp = samples.back();
+  result.bytesPerSecond =
+      benchmark.bytes > 0 ? benchmark.bytes * 1.0e9 / result.nsPerOp : 0.0;
+  return result;
+}
+
+std::string toJson(std::vector<Result> const& results, double minTimeMs) {
+  Builder b;
+  b.openObject();
+  b.add("context", Value(ValueType::Object));
+  char date[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  b.add("date", Value(date));
+  b.add("library_version", Value(Version::BuildVersion.toString()));
+#ifdef __VERSION__
+  b.add("compiler", Value(__VERSION__));
+#endif
+#ifdef NDEBUG
+  b.add("debug", Value(false));
+#else
+  b.add("debug", Value(true));
+#endif
+  b.add("min_time_ms", Value(minTimeMs));
+  b.close();
+  b.add("benchmarks", Value(ValueType::Array));
+  for (auto const& r : results) {
+    b.openObject();
+    b.add("name", Value(r.name));
+    b.add("iterations", Value(r.iterations));
+    b.add("repetitions", Value(r.repetitions));
+    b.add("ns_per_op", Value(r.nsPerOp));
+    b.add("min_ns_per_op", Value(r.minNsPerOp));
+    b.add("max_ns_per_op", Value(r.maxNsPerOp));
+    if (r.bytesPerSecond > 0.0) {
+      b.add("bytes_per_second", Value(r.bytesPerSecond));
+    }
+    b.close();
+  }
+  b.close();
+  b.close();
+
+  Options options;
+  options.prettyPrint = true;
+  return Dumper::toString(b.slice(), &options);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string filter;
+  std::string jsonFile;
+  std::string corpusDirectory;
+  double minTimeMs = 200.0;
+  std::size_t repetitions = 5;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg(argv[i]);
+    bool const hasValue = (i + 1 < argc);
+    if (arg == "--filter" && hasValue) {
+      filter = argv[++i];
+    } else if (arg == "--min-time" && hasValue) {
+      minTimeMs = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--repetitions" && hasValue) {
+      repetitions = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--json" && hasValue) {
+      jsonFile = argv[++i];
+    } else if (arg == "--corpus" && hasValue) {
+      corpusDirectory = argv[++i];
+    } else if (arg == "--list") {
+      list = true;
+    } else {
+      usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+  if (minTimeMs <= 0.0 || repetitions == 0) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Benchmark> benchmarks;
+  try {
+    if (corpusDirectory.empty()) {
+      corpusDirectory = findCorpusDirectory();
+    }
+    if (corpusDirectory.empty()) {
+      std::cerr << "JSON corpus not found, using synthetic data only" << std::endl;
+    } else {
+      for (auto const& file : corpusFiles) {
+        std::string json;
+        if (!readFile(corpusDirectory + "/" + file, json)) {
+          std::cerr << "Cannot read input file '" << corpusDirectory << "/"
+                    << file << "'" << std::endl;
+          return EXIT_FAILURE;
+        }
+        std::string name = file.substr(0, file.size() - 5);
+        addCorpusBenchmarks(benchmarks,
+                            std::make_shared<Corpus>(makeCorpus(name, std::move(json))));
+      }
+    }
+    for (auto& corpus : syntheticCorpora()) {
+      addCorpusBenchmarks(benchmarks, std::make_shared<Corpus>(std::move(corpus)));
+    }
+    addLookupBenchmarks(benchmarks);
+    addBuilderBenchmarks(benchmarks);
+  } catch (std::exception const& ex) {
+    std::cerr << "Cannot prepare benchmarks: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Result> results;
+  bool const jsonToStdout = (jsonFile == "-");
+  std::ostream& out = jsonToStdout ? std::cerr : std::cout;
+
+  for (auto const& benchmark : benchmarks) {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    if (list) {
+      std::cout << benchmark.name << std::endl;
+      continue;
+    }
+    Result r = run(benchmark, minTimeMs * 1.0e6, repetitions);
+    out << std::left << std::setw(36) << r.name << std::right << std::fixed
+        << std::setprecision(1) << std::setw(14) << r.nsPerOp << " ns/op";
+    if (r.bytesPerSecond > 0.0) {
+      out << std::setprecision(1) << std::setw(10)
+          << (r.bytesPerSecond / (1024.0 * 1024.0)) << " MiB/s";
+    }
+    out << std::endl;
+    results.push_back(r);
+  }
+
+  if (!jsonFile.empty() && !list) {
+    std::string json = toJson(results, minTimeMs);
+    if (jsonToStdout) {
+      std::cout << json << std::endl;
+    } else {
+      std::ofstream ofs(jsonFile.c_str(), std::ofstream::out | std::ofstream::trunc);
+      if (!ofs.is_open()) {
+        std::cerr << "Cannot write output file '" << jsonFile << "'" << std::endl;
+        return EXIT_FAILURE;
+      }
+      ofs << json << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -51,7 +51,11 @@ static void usage(char* argv[]) {
   std::cout << "out of cache. The target areas are also in a different memory"
             << std::endl;
   std::cout << "area for each copy." << std::endl;
-  std::cout << "TYPE must be either 'vpack' or 'rapidjson'." << std::endl;
+  std::cout << "TYPE must be either 'vpack', 'rapidjson' or 'compress'."
+            << std::endl;
+  std::cout << "'compress' converts the file to VPack once and then compresses"
+            << std::endl;
+  std::cout << "and decompresses the VPack data with BlockCodec." << std::endl;
 }
 
 static std::string tryReadFile(std::string const& filename) {
@@ -169,6 +173,68 @@ static void run(std::string& data, int runTime, size_t copies, bool useVPack,
   }
 }
 
+static void runCompression(std::string const& data, int runTime,
+                           bool fullOutput) {
+  try {
+    Options options;
+    Parser parser(&options);
+    parser.parse(data);
+    std::shared_ptr<Builder> builder = parser.steal();
+    uint8_t const* input = builder->start();
+    std::size_t const size = builder->size();
+
+    Buffer<uint8_t> compressed;
+    BlockCodec::compress(input, size, compressed);
+    std::vector<uint8_t> output(size);
+
+    // spend half of the runtime compressing and half decompressing
+    auto measure = [runTime](auto&& func) {
+      std::size_t total = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      decltype(start) now;
+      do {
+        for (int i = 0; i < 8; i++) {
+          func();
+          total++;
+        }
+        now = std::chrono::high_resolution_clock::now();
+      } while (std::chrono::duration_cast<std::chrono::duration<double>>(now - start)
+                   .count() < runTime / 2.0);
+      std::chrono::duration<double> totalTime =
+          std::chrono::duration_cast<std::chrono::duration<double>>(now - start);
+      return static_cast<double>(total) / totalTime.count();
+    };
+
+    Buffer<uint8_t> scratch;
+    double compressions = measure([&]() {
+      scratch.clear();
+      BlockCodec::compress(input, size, scratch);
+    });
+    double decompressions = measure([&]() {
+      BlockCodec::decompress(compressed.data(), compressed.size(),
+                             output.data(), size);
+    });
+
+    if (fullOutput) {
+      std::cout << "Compressed " << size << " bytes of VPack (from "
+                << data.size() << " bytes of JSON) to " << compressed.size()
+                << " bytes." << std::endl;
+    }
+    std::cout << "Ratio " << static_cast<double>(size) / compressed.size()
+              << ", compression " << compressions * size << " bytes/s"
+              << ", decompression " << decompressions * size << " bytes/s."
+              << std::endl;
+  } catch (Exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    ::exit(EXIT_FAILURE);
+  } catch (std::exception const& ex) {
+    std::cerr << "An exception occurred while running bench: " << ex.what()
+              << std::endl;
+    ::exit(EXIT_FAILURE);
+  }
+}
+
 static void runDefaultBench() {
   auto runComparison = [](std::string const& filename) {
     std::string data = std::move(readFile(filename));
@@ -185,6 +251,9 @@ static void runDefaultBench() {
 
     std::cout << "rapidjson:    ";
     run(data, 10, 1, false, false);
+
+    std::cout << "compression:  ";
+    runCompression(data, 10, false);
   };
 
   runComparison("small.json");
@@ -205,10 +274,14 @@ int main(int argc, char* argv[]) {
   }
 
   bool useVPack;
+  bool compress = false;
   if (::strcmp(argv[4], "vpack") == 0) {
     useVPack = true;
   } else if (::strcmp(argv[4], "rapidjson") == 0) {
     useVPack = false;
+  } else if (::strcmp(argv[4], "compress") == 0) {
+    useVPack = true;
+    compress = true;
   } else {
     usage(argv);
     return EXIT_FAILURE;
@@ -220,7 +293,11 @@ int main(int argc, char* argv[]) {
   // read input file
   std::string s = std::move(readFile(argv[1]));
 
-  run(s, runTime, copies, useVPack, true);
+  if (compress) {
+    runCompression(s, runTime, true);
+  } else {
+    run(s, runTime, copies, useVPack, true);
+  }
 
   return EXIT_SUCCESS;
 }
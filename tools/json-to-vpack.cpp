@@ -24,6 +24,7 @@
 /// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -34,8 +35,6 @@
 
 using namespace arangodb::velocypack;
     
-static std::unique_ptr<AttributeTranslator> translator(new AttributeTranslator);
-
 static void usage(char* argv[]) {
 #ifdef __linux__
   std::cout << "Usage: " << argv[0] << " [OPTIONS] INFILE [OUTFILE]"
@@ -62,6 +61,14 @@ static void usage(char* argv[]) {
             << std::endl;
   std::cout << " --compress      compress Object keys" << std::endl;
   std::cout << " --no-compress   don't compress Object keys" << std::endl;
+  std::cout << " --dictionary FILE"
+            << std::endl;
+  std::cout << "                 read the key dictionary from FILE if it exists,"
+            << std::endl;
+  std::cout << "                 and save the dictionary including the newly"
+            << std::endl;
+  std::cout << "                 compressed keys in FILE (implies --compress)"
+            << std::endl;
   std::cout << " --hex           print a hex dump of the generated VPack value"
             << std::endl;
   std::cout << " --stringify     print a char array containing the generated VPack value"
@@ -72,6 +79,21 @@ static inline bool isOption(char const* arg, char const* expected) {
   return (strcmp(arg, expected) == 0);
 }
 
+static bool readFile(std::string const& filename, std::string& result) {
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+
+  if (!ifs.is_open()) {
+    return false;
+  }
+
+  char buffer[32768];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    result.append(buffer, checkOverflow(ifs.gcount()));
+  }
+  return true;
+}
+
 static bool buildCompressedKeys(
     std::string const& s, std::unordered_map<std::string, size_t>& keysFound) {
   Options options;
@@ -106,6 +128,7 @@ int main(int argc, char* argv[]) {
   bool compress = false;
   bool hexDump = false;
   bool stringify = false;
+  char const* dictionaryFile = nullptr;
 
   int i = 1;
   while (i < argc) {
@@ -121,6 +144,13 @@ int main(int argc, char* argv[]) {
       compress = true;
     } else if (allowFlags && isOption(p, "--no-compress")) {
       compress = false;
+    } else if (allowFlags && isOption(p, "--dictionary")) {
+      if (++i == argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      dictionaryFile = argv[i];
+      compress = true;
     } else if (allowFlags && isOption(p, "--hex")) {
       hexDump = true;
     } else if (allowFlags && isOption(p, "--stringify")) {
@@ -193,29 +223,50 @@ int main(int argc, char* argv[]) {
   options.buildUnindexedArrays = compact;
   options.buildUnindexedObjects = compact;
 
+  AttributeDictionary dictionary;
+  if (dictionaryFile != nullptr) {
+    std::string data;
+    if (readFile(dictionaryFile, data)) {
+      Validator validator;
+      validator.validate(reinterpret_cast<uint8_t const*>(data.data()), data.size(), false);
+      dictionary.fromVelocyPack(Slice(reinterpret_cast<uint8_t const*>(data.data())));
+    }
+  }
+
   // compress object keys?
   if (compress) {
     size_t compressedOccurrences = 0;
     std::unordered_map<std::string, size_t> keysFound;
     buildCompressedKeys(s, keysFound);
 
-    std::vector<std::tuple<uint64_t, std::string, size_t>> stats;
+    std::vector<std::string_view> keys;
     size_t requiredLength = 2;
-    uint64_t nextId = 0;
     for (auto const& it : keysFound) {
-      if (it.second > 1 && it.first.size() >= requiredLength) {
-        translator->add(it.first, ++nextId);
-        stats.emplace_back(std::make_tuple(nextId, it.first, it.second));
+      if (dictionary.translator()->translate(it.first) != nullptr) {
+        // already contained in the dictionary
+        compressedOccurrences += it.second;
+      } else if (it.second > 1 && it.first.size() >= requiredLength) {
+        keys.emplace_back(it.first);
 
-        if (translator->count() == 255) {
+        if (dictionary.count() + keys.size() == 255) {
           requiredLength = 3;
         }
         compressedOccurrences += it.second;
       }
     }
-    translator->seal();
+    dictionary.add(keys);
 
-    options.attributeTranslator = translator.get();
+    AttributeTranslator* translator = dictionary.translator();
+    options.attributeTranslator = translator;
+
+    std::vector<std::tuple<uint64_t, std::string, size_t>> stats;
+    for (auto const& it : keysFound) {
+      uint8_t const* id = translator->translate(it.first);
+      if (id != nullptr) {
+        stats.emplace_back(std::make_tuple(Slice(id).getUInt(), it.first, it.second));
+      }
+    }
+    std::sort(stats.begin(), stats.end());
 
     // print statistics
     if (!toStdOut && compressedOccurrences > 0) {
@@ -275,6 +326,20 @@ int main(int argc, char* argv[]) {
 
   ofs.close();
 
+  if (dictionaryFile != nullptr) {
+    Builder dictionaryBuilder;
+    dictionary.toVelocyPack(dictionaryBuilder);
+
+    std::ofstream dfs(dictionaryFile, std::ofstream::out | std::ofstream::binary);
+    if (!dfs.is_open()) {
+      std::cerr << "Cannot write dictionary file '" << dictionaryFile << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    dfs.write(reinterpret_cast<char const*>(dictionaryBuilder.start()),
+              dictionaryBuilder.size());
+    dfs.close();
+  }
+
   if (!toStdOut) {
     std::cout << "Successfully converted JSON infile '" << infile << "'"
               << std::endl;
@@ -282,10 +347,12 @@ int main(int argc, char* argv[]) {
     std::cout << "VPack Outfile size:  " << builder->size() << std::endl;
 
     if (compress) {
-      if (translator.get()->count() > 0) {
+      if (dictionary.count() > 0) {
         std::cout << "Key dictionary size: "
-                  << Slice(translator.get()->builder()->data())
+                  << Slice(dictionary.translator()->builder()->data())
                         .byteSize() << std::endl;
+        std::cout << "Key dictionary version: " << dictionary.version()
+                  << std::endl;
       } else {
         std::cout << "Key dictionary size: 0 (no benefit from compression)"
                   << std::endl;
@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Library to build up VPack documents.
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Max Neunhoeffer
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "velocypack/vpack.h"
+#include "velocypack/velocypack-exception-macros.h"
+
+using namespace arangodb::velocypack;
+
+static void usage(char* argv[]) {
+  std::cout << "Usage: " << argv[0] << " [OPTIONS] INFILE..." << std::endl;
+  std::cout << "This program parses the JSON INFILEs repeatedly while recording all"
+            << std::endl;
+  std::cout << "allocations made by VPack, and prints a report of them. Each document"
+            << std::endl;
+  std::cout << "is parsed into a temporary Builder, copied into a SharedSlice and"
+            << std::endl;
+  std::cout << "added to a long-lived Builder, which is kept until the end." << std::endl;
+  std::cout << "Alternatively, it prints a previously recorded report." << std::endl;
+  std::cout << "Available options are:" << std::endl;
+  std::cout << " --iterations N            number of times to process each INFILE (default: 10)" << std::endl;
+  std::cout << " --sample N                record only every N-th allocation (default: 1)" << std::endl;
+  std::cout << " --report FILE             print the JSON report in FILE, as written by" << std::endl;
+  std::cout << "                           AllocationRecorder::toVelocyPack()" << std::endl;
+  std::cout << " --json                    print the report as JSON" << std::endl;
+}
+
+static inline bool isOption(char const* arg, char const* expected) {
+  return (strcmp(arg, expected) == 0);
+}
+
+static bool readFile(std::string const& filename, std::string& result) {
+  std::ifstream ifs(filename.c_str(), std::ifstream::in | std::ifstream::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  char buffer[32768];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    result.append(buffer, checkOverflow(ifs.gcount()));
+  }
+  return true;
+}
+
+// prints a histogram of powers of 2 on a single line
+static void printHistogram(char const* title, Slice histogram, char const* unit) {
+  std::cout << "  " << title << ":";
+  ValueLength const n = histogram.length();
+  for (ValueLength i = 0; i < n; ++i) {
+    uint64_t const count = histogram.at(i).getUInt();
+    if (count == 0) {
+      continue;
+    }
+    if (i == 0) {
+      std::cout << " 0" << unit << ": " << count;
+    } else {
+      std::cout << " <" << (uint64_t(1) << i) << unit << ": " << count;
+    }
+  }
+  std::cout << std::endl;
+}
+
+static void printReport(Slice report) {
+  std::cout << "sample interval: " << report.get("sampleInterval").getUInt()
+            << std::endl
+            << std::endl;
+
+  char line[256];
+  snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %14s %14s %8s %12s %12s",
+           "category", "allocs", "reallocs", "frees", "live", "live bytes",
+           "peak bytes", "waste", "avg life us", "max life us");
+  std::cout << line << std::endl;
+
+  for (auto it : ObjectIterator(report)) {
+    if (!it.value.isObject()) {
+      continue;
+    }
+    Slice s = it.value;
+    uint64_t const frees = s.get("frees").getUInt();
+    uint64_t const capacity = s.get("freedCapacity").getUInt();
+    uint64_t const used = s.get("freedUsed").getUInt();
+    // share of the freed capacity that was never used
+    double const waste =
+        capacity == 0 ? 0.0 : 100.0 * double(capacity - used) / double(capacity);
+    double const avgLifetime =
+        frees == 0 ? 0.0 : double(s.get("totalLifetimeNanos").getUInt()) / frees / 1000.0;
+
+    snprintf(line, sizeof(line),
+             "%-16s %10llu %10llu %10llu %10llu %14llu %14llu %7.1f%% %12.1f %12.1f",
+             it.key.copyString().c_str(),
+             (unsigned long long)s.get("allocations").getUInt(),
+             (unsigned long long)s.get("reallocations").getUInt(),
+             (unsigned long long)frees,
+             (unsigned long long)s.get("liveBlocks").getUInt(),
+             (unsigned long long)s.get("liveBytes").getUInt(),
+             (unsigned long long)s.get("peakLiveBytes").getUInt(), waste,
+             avgLifetime, double(s.get("maxLifetimeNanos").getUInt()) / 1000.0);
+    std::cout << line << std::endl;
+  }
+
+  std::cout << std::endl << "freed blocks by size and lifetime:" << std::endl;
+  for (auto it : ObjectIterator(report)) {
+    if (!it.value.isObject() || it.value.get("frees").getUInt() == 0) {
+      continue;
+    }
+    std::cout << it.key.copyString() << std::endl;
+    printHistogram("sizes", it.value.get("sizes"), "B");
+    printHistogram("lifetimes", it.value.get("lifetimes"), "us");
+  }
+}
+
+int main(int argc, char* argv[]) {
+  VELOCYPACK_GLOBAL_EXCEPTION_TRY
+
+  std::vector<std::string> infiles;
+  char const* reportFile = nullptr;
+  uint64_t iterations = 10;
+  uint32_t sampleInterval = 1;
+  bool json = false;
+  bool allowFlags = true;
+
+  int i = 1;
+  while (i < argc) {
+    char const* p = argv[i];
+    if (allowFlags && isOption(p, "--help")) {
+      usage(argv);
+      return EXIT_SUCCESS;
+    } else if (allowFlags && isOption(p, "--iterations") && i + 1 < argc) {
+      iterations = std::strtoull(argv[++i], nullptr, 10);
+    } else if (allowFlags && isOption(p, "--sample") && i + 1 < argc) {
+      sampleInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (allowFlags && isOption(p, "--report") && i + 1 < argc) {
+      reportFile = argv[++i];
+    } else if (allowFlags && isOption(p, "--json")) {
+      json = true;
+    } else if (allowFlags && isOption(p, "--")) {
+      allowFlags = false;
+    } else if (allowFlags && p[0] == '-' && p[1] == '-') {
+      usage(argv);
+      return EXIT_FAILURE;
+    } else {
+      infiles.emplace_back(p);
+    }
+    ++i;
+  }
+
+  if ((reportFile == nullptr) == infiles.empty()) {
+    usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  std::shared_ptr<Builder> report;
+
+  if (reportFile != nullptr) {
+    std::string s;
+    if (!readFile(reportFile, s)) {
+      std::cerr << "Cannot read report file '" << reportFile << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    report = Parser::fromJson(s);
+  } else {
+    std::vector<std::string> documents;
+    for (auto const& infile : infiles) {
+      std::string s;
+      if (!readFile(infile, s)) {
+        std::cerr << "Cannot read infile '" << infile << "'" << std::endl;
+        return EXIT_FAILURE;
+      }
+      try {
+        Parser::fromJson(s);
+      } catch (Exception const& ex) {
+        std::cerr << "Cannot parse infile '" << infile << "': " << ex.what()
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      documents.emplace_back(std::move(s));
+    }
+
+    AllocationRecorder recorder;
+    AllocationTracing::install(&recorder, sampleInterval);
+    {
+      Builder longLived;
+      std::vector<SharedSlice> shared;
+      for (uint64_t j = 0; j < iterations; ++j) {
+        for (auto const& document : documents) {
+          auto parsed = Parser::fromJson(document);
+          shared.emplace_back(parsed->bufferRef());
+          longLived.clear();
+          longLived.add(parsed->slice());
+        }
+        shared.clear();
+      }
+      // take the report while the long-lived Builder is still alive
+      report = std::make_shared<Builder>();
+      AllocationTracing::install(nullptr);
+      recorder.toVelocyPack(*report, sampleInterval);
+    }
+  }
+
+  if (json) {
+    Options options;
+    options.prettyPrint = true;
+    std::cout << report->slice().toJson(&options) << std::endl;
+  } else {
+    printReport(report->slice());
+  }
+
+  VELOCYPACK_GLOBAL_EXCEPTION_CATCH
+}
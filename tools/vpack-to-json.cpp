@@ -27,6 +27,7 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <optional>
 
 #include "velocypack/vpack.h"
 #include "velocypack/velocypack-exception-macros.h"
@@ -58,6 +59,22 @@ static void usage(char* argv[]) {
   std::cout << " --hex                     try to turn hex-encoded input into binary vpack" << std::endl;
   std::cout << " --validate                validate input VelocyPack data" << std::endl;
   std::cout << " --no-validate             don't validate input VelocyPack data" << std::endl;
+  std::cout << " --dictionary FILE         read the key dictionary for compressed Object keys from FILE" << std::endl;
+}
+
+static bool readFile(std::string const& filename, std::string& result) {
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary);
+
+  if (!ifs.is_open()) {
+    return false;
+  }
+
+  char buffer[32768];
+  while (ifs.good()) {
+    ifs.read(&buffer[0], sizeof(buffer));
+    result.append(buffer, checkOverflow(ifs.gcount()));
+  }
+  return true;
 }
 
 static std::string convertFromHex(std::string const& value) {
@@ -108,6 +125,7 @@ int main(int argc, char* argv[]) {
   bool printUnsupported = true;
   bool hex = false;
   bool validate = true;
+  char const* dictionaryFile = nullptr;
 
   int i = 1;
   while (i < argc) {
@@ -129,6 +147,12 @@ int main(int argc, char* argv[]) {
       validate = true;
     } else if (allowFlags && isOption(p, "--no-validate")) {
       validate = false;
+    } else if (allowFlags && isOption(p, "--dictionary")) {
+      if (++i == argc) {
+        usage(argv);
+        return EXIT_FAILURE;
+      }
+      dictionaryFile = argv[i];
     } else if (allowFlags && isOption(p, "--")) {
       allowFlags = false;
     } else if (infileName == nullptr) {
@@ -206,6 +230,22 @@ int main(int argc, char* argv[]) {
 
   Slice const slice(reinterpret_cast<uint8_t const*>(s.data()));
 
+  // compressed Object keys are translated via the global translator, which
+  // is only replaced if a dictionary is given
+  AttributeDictionary dictionary;
+  std::optional<AttributeTranslatorScope> scope;
+  if (dictionaryFile != nullptr) {
+    std::string data;
+    if (!readFile(dictionaryFile, data)) {
+      std::cerr << "Cannot read dictionary file '" << dictionaryFile << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    Validator validator;
+    validator.validate(reinterpret_cast<uint8_t const*>(data.data()), data.size(), false);
+    dictionary.fromVelocyPack(Slice(reinterpret_cast<uint8_t const*>(data.data())));
+    scope.emplace(dictionary.translator());
+  }
+
   Options options;
   options.prettyPrint = pretty;
   options.unsupportedTypeBehavior = 